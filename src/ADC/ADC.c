@@ -0,0 +1,289 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file ADC.c
+ * @brief Implementation of the interrupt-driven multi-channel ADC scanner.
+ * The ISR fills the back half of the double buffer and flips it to the front
+ * when an output completes. A reader copies the front half and retries if the
+ * generation changed meanwhile; the ISR only writes a half after flipping away
+ * from it, so an unchanged generation guarantees an untouched copy.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "ADC.h"
+
+#if ADC_SCAN
+
+#if !ADC_ISR
+    #error "ADC_SCAN requires ADC_ISR = Enable in Interrupt.h"
+#endif
+
+#if ADC_DECIMATION < 1 || ADC_DECIMATION > 16
+    #error "ADC_DECIMATION must be 1 to 16 for the sums of 12-bit results to fit"
+#endif
+
+#if ADC_EVENTS
+    #include "EventQueue.h"
+#endif
+
+// Clocks in a CCRx period; a value of 0 stands for 1024
+#define ADC_CCR_CLOCKS(high, low) \
+    ((((high) & 3) << 8 | (low)) ? (((high) & 3) << 8 | (low)) : 1024)
+
+// Trigger timer: counter read when a scan starts, and clocks per trigger
+#if ADC_TRIGGER == ADC_TRIGGER_STM_P || ADC_TRIGGER == ADC_TRIGGER_STM_A
+    #include "STM.h"
+    #define ADC_TRIGGER_COUNT()   readSTimer()
+    #if STM_SELECT_CLEAR_COMPARE_MATCH == STM_COMPARE_MATCH_P
+        #define ADC_TRIGGER_PERIOD  STM_P_PERIOD_CLOCKS
+    #else
+        #define ADC_TRIGGER_PERIOD  ADC_CCR_CLOCKS(STM_CCRA_HIGH_BYTE_MASK, STM_CCRA_LOW_BYTE_MASK)
+    #endif
+#elif ADC_TRIGGER == ADC_TRIGGER_PTM_P || ADC_TRIGGER == ADC_TRIGGER_PTM_A
+    #include "PTM.h"
+    #if PTM_MODE == PTM_CAPTURE_INPUT_MODE
+        #error "A PTM ADC_TRIGGER requires PTM_MODE other than PTM_CAPTURE_INPUT_MODE"
+    #endif
+    #define ADC_TRIGGER_COUNT()   readPTimer()
+    #if PTM_SELECT_CLEAR_COMPARE_MATCH == PTM_COMPARE_MATCH_P
+        #define ADC_TRIGGER_PERIOD  ADC_CCR_CLOCKS(PTM_CCRP_HIGH_BYTE_MASK, PTM_CCRP_LOW_BYTE_MASK)
+    #else
+        #define ADC_TRIGGER_PERIOD  ADC_CCR_CLOCKS(PTM_CCRA_HIGH_BYTE_MASK, PTM_CCRA_LOW_BYTE_MASK)
+    #endif
+#elif ADC_TRIGGER != ADC_TRIGGER_FREE_RUN
+    #error "ADC_TRIGGER must be ADC_TRIGGER_FREE_RUN or an STM/PTM compare vector"
+#endif
+
+#if ADC_TRIGGER != ADC_TRIGGER_FREE_RUN && !ISR_ENABLED(ADC_TRIGGER)
+    #error "The ADC_TRIGGER vector must be enabled in Interrupt.h"
+#endif
+
+// Set when the trigger vector calls a handler named in Interrupt.h
+#if (ADC_TRIGGER == ADC_TRIGGER_PTM_P && defined(PTM_COMPAIR_P_ISR_HANDLER)) || \
+    (ADC_TRIGGER == ADC_TRIGGER_PTM_A && defined(PTM_COMPAIR_A_ISR_HANDLER)) || \
+    (ADC_TRIGGER == ADC_TRIGGER_STM_P && defined(STM_COMPAIR_P_ISR_HANDLER)) || \
+    (ADC_TRIGGER == ADC_TRIGGER_STM_A && defined(STM_COMPAIR_A_ISR_HANDLER))
+    #define ADC_TRIGGER_STATIC   1
+#else
+    #define ADC_TRIGGER_STATIC   0
+#endif
+
+// SADC0 channel selection bits SACS3~SACS0
+#define ADC_CHANNEL_BITS   0x0F
+
+volatile unsigned char AdcOverruns;
+
+static const unsigned char AdcChannels[] = ADC_SCAN_CHANNELS;
+
+// Fails to compile when ADC_SCAN_COUNT does not match the scan list
+typedef char AdcScanCountMatchesChannels[sizeof(AdcChannels) == ADC_SCAN_COUNT ? 1 : -1];
+
+static volatile unsigned int AdcBuffer[2][ADC_SCAN_COUNT];
+static volatile unsigned long AdcStamp[2];   // Time of the first scan of each half
+static volatile unsigned char AdcFront;      // Half holding the latest output
+static volatile unsigned char AdcGen;        // Completed outputs
+static volatile unsigned char AdcIndex;      // Position in the scan list
+static volatile unsigned char AdcScans;      // Scans summed into the back half
+static volatile unsigned char AdcRunning;
+
+#if ADC_TRIGGER != ADC_TRIGGER_FREE_RUN
+static volatile unsigned char AdcBusy;       // A triggered scan is in progress
+static unsigned long AdcTime;                // Trigger timer clocks up to the last trigger
+#endif
+
+/** @brief Selects a channel and pulses START to begin a conversion. */
+static void AdcConvert(unsigned char channel)
+{
+    _sadc0 = (_sadc0 & ~ADC_CHANNEL_BITS) | channel;
+    _start = 0;
+    _start = 1;
+    _start = 0;
+}
+
+/** @brief Initializes the A/D converter and the scan. */
+void AdcInit(void)
+{
+    _adcen = 1;                 // Power the converter
+    _adrfs = 1;                 // Right-justified: SADOH holds bits 11~8
+    _sacks0 = ADC_CLOCK & 1;
+    _sacks1 = (ADC_CLOCK >> 1) & 1;
+    _sacks2 = (ADC_CLOCK >> 2) & 1;
+
+    AdcFront = 0;
+    AdcGen = 0;
+    AdcRunning = 0;
+    AdcOverruns = 0;
+
+    #if ISR_DISPATCH_TABLE && !defined(ADC_ISR_HANDLER)
+        InterruptRegister(ADC_ISR_ADDRESS, AdcISR);
+    #endif
+    EnableInterrupt(ADC_ISR_ADDRESS);
+
+    #if ADC_TRIGGER != ADC_TRIGGER_FREE_RUN
+        #if ISR_DISPATCH_TABLE && !ADC_TRIGGER_STATIC
+            InterruptRegister(ADC_TRIGGER, AdcTriggerISR);
+        #endif
+        EnableInterrupt(ADC_TRIGGER);
+    #endif
+}
+
+/** @brief Starts scanning from the first channel, continuously or on each trigger. */
+void AdcStart(void)
+{
+    CritState state;
+
+    if (AdcRunning)
+        return;
+
+    state = crit_enter();
+    AdcIndex = 0;
+    AdcScans = 0;
+    AdcStamp[0] = 0;
+    AdcStamp[1] = 0;
+    #if ADC_TRIGGER == ADC_TRIGGER_FREE_RUN
+        AdcConvert(AdcChannels[0]);
+    #else
+        AdcBusy = 0;
+        AdcTime = 0;
+    #endif
+    AdcRunning = 1;
+    crit_exit(state);
+}
+
+/** @brief Stops scanning; the conversion in progress is discarded. */
+void AdcStop(void)
+{
+    AdcRunning = 0;
+}
+
+/** @brief Reads the generation counter.
+ * @return The number of completed outputs, modulo 256.
+ */
+unsigned char AdcGeneration(void)
+{
+    return AdcGen;
+}
+
+/** @brief Copies the latest output.
+ * @param values Array of ADC_SCAN_COUNT results, in scan list order.
+ * @param stamp Receives the time of the first scan of the output, or 0.
+ * @return The generation of the copied output.
+ */
+unsigned char AdcReadScan(unsigned int *values, unsigned long *stamp)
+{
+    unsigned char gen;
+    unsigned char i;
+
+    do
+    {
+        gen = AdcGen;
+        for (i = 0; i < ADC_SCAN_COUNT; i++)
+            values[i] = AdcBuffer[AdcFront][i];
+        if (stamp)
+            *stamp = AdcStamp[AdcFront];
+    } while (gen != AdcGen);
+
+    return gen;
+}
+
+/** @brief Reads one channel of the latest output.
+ * @param index Position of the channel in the scan list.
+ * @return The conversion result.
+ */
+unsigned int AdcRead(unsigned char index)
+{
+    unsigned char gen;
+    unsigned int value;
+
+    do
+    {
+        gen = AdcGen;
+        value = AdcBuffer[AdcFront][index];
+    } while (gen != AdcGen);
+
+    return value;
+}
+
+/** @brief A/D conversion complete handler.
+ * Sums the result into the back half, starts the next conversion of the scan
+ * and publishes the back half once ADC_DECIMATION scans are in.
+ */
+void AdcISR(void)
+{
+    unsigned char back = AdcFront ^ 1;
+    unsigned int result;
+
+    if (!AdcRunning)
+        return;
+
+    result = ((unsigned int)_sadoh << 8) | _sadol;
+    if (AdcScans)
+        AdcBuffer[back][AdcIndex] += result;
+    else
+        AdcBuffer[back][AdcIndex] = result;
+
+    if (++AdcIndex < ADC_SCAN_COUNT)
+    {
+        AdcConvert(AdcChannels[AdcIndex]);
+        return;
+    }
+
+    AdcIndex = 0;
+    if (++AdcScans == ADC_DECIMATION)
+    {
+        #ifdef ADC_FILTER
+        {
+            unsigned char i;
+
+            for (i = 0; i < ADC_SCAN_COUNT; i++)
+                AdcBuffer[back][i] = ADC_FILTER(i, AdcBuffer[back][i]);
+        }
+        #endif
+        AdcScans = 0;
+        AdcFront = back;
+        AdcGen++;
+        #if ADC_EVENTS
+            EventPost(ISR_VECTOR_INDEX(ADC_ISR_ADDRESS), AdcGen);
+        #endif
+    }
+
+    #if ADC_TRIGGER == ADC_TRIGGER_FREE_RUN
+        AdcConvert(AdcChannels[0]);
+    #else
+        AdcBusy = 0;
+    #endif
+}
+
+#if ADC_TRIGGER != ADC_TRIGGER_FREE_RUN
+/** @brief Trigger compare handler.
+ * The conversion is started before any bookkeeping, so the sampling instant
+ * trails the compare match by the vector latency only.
+ */
+void AdcTriggerISR(void)
+{
+    unsigned int count = ADC_TRIGGER_COUNT();
+
+    if (!AdcRunning)
+        return;
+
+    if (AdcBusy)
+    {
+        AdcTime += ADC_TRIGGER_PERIOD;
+        AdcOverruns++;
+        return;
+    }
+
+    AdcConvert(AdcChannels[0]);
+    AdcBusy = 1;
+    AdcTime += ADC_TRIGGER_PERIOD;
+    if (AdcScans == 0)
+        AdcStamp[AdcFront ^ 1] = AdcTime + count;
+}
+#endif
+
+#endif // ADC_SCAN
@@ -0,0 +1,134 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file ADC.h
+ * @brief Header file for the interrupt-driven multi-channel ADC scanner for Holtek MCUs.
+ * The A/D converter steps through ADC_SCAN_CHANNELS from the ADC interrupt,
+ * either back to back or once per STM/PTM compare event. ADC_DECIMATION scans
+ * are summed into one output, which lands in one half of a double buffer and
+ * bumps a generation counter, so the main loop reads a consistent snapshot at
+ * any time without stopping the converter or waiting for a conversion.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef ADC_H
+#define ADC_H
+
+#include "BA45F5240.h"  // Include the microcontroller-specific header file
+#include "Interrupt.h"
+
+//=========================================================================
+#define ADC_SCAN     Disable  // Enable also requires ADC_ISR = Enable in Interrupt.h
+//=========================================================================
+
+/** @brief A/D Converter Clock Selection (SACKS2~SACKS0) */
+#define ADC_FSYS              0
+#define ADC_FSYS_DIVIDE_2     1
+#define ADC_FSYS_DIVIDE_4     2
+#define ADC_FSYS_DIVIDE_8     3
+#define ADC_FSYS_DIVIDE_16    4
+#define ADC_FSYS_DIVIDE_32    5
+#define ADC_FSYS_DIVIDE_64    6
+#define ADC_FSYS_DIVIDE_128   7
+//=========================================================================
+#define ADC_CLOCK    ADC_FSYS_DIVIDE_16  // Keep tADCK within the datasheet range
+//=========================================================================
+
+/** @brief Scan list
+ * External channels (SACS3~SACS0) converted in order, one per interrupt.
+ * ADC_SCAN_COUNT must equal the number of channels; ADC.c checks it.
+ */
+//=========================================================================
+#define ADC_SCAN_CHANNELS       { 0, 1 }
+#define ADC_SCAN_COUNT          2
+//=========================================================================
+
+/** @brief Scan trigger
+ * ADC_TRIGGER_FREE_RUN starts each scan as soon as the previous one completes.
+ * A compare vector address starts each scan from that vector instead, so the
+ * samples are spaced by the timer period set in STM.h or PTM.h (for example
+ * with STM_TARGET_PERIOD_US) rather than by the conversion time. The vector
+ * handler is hooked like the ADC one and its ISR must be enabled in Interrupt.h.
+ */
+#define ADC_TRIGGER_FREE_RUN    0
+#define ADC_TRIGGER_PTM_P       PTM_COMPAIR_P_ISR_ADDRESS
+#define ADC_TRIGGER_PTM_A       PTM_COMPAIR_A_ISR_ADDRESS
+#define ADC_TRIGGER_STM_P       STM_COMPAIR_P_ISR_ADDRESS
+#define ADC_TRIGGER_STM_A       STM_COMPAIR_A_ISR_ADDRESS
+//=========================================================================
+#define ADC_TRIGGER             ADC_TRIGGER_FREE_RUN
+//=========================================================================
+
+/** @brief Decimation
+ * Number of scans summed into each output, 1 to 16; the results are sums, so
+ * 12-bit samples gain resolution instead of being divided. With ADC_EVENTS an
+ * event of source ISR_VECTOR_INDEX(ADC_ISR_ADDRESS), carrying the generation,
+ * is posted to the EventQueue per output, so the application only wakes then.
+ */
+//=========================================================================
+#define ADC_DECIMATION          1
+#define ADC_EVENTS              Disable
+//=========================================================================
+
+/** @brief Output filter
+ * Define ADC_FILTER(index, value) to pass each output through a chain of
+ * Filter.h filters in the ISR before it is published, e.g. with
+ *     unsigned int AppFilter(unsigned char index, unsigned int value);
+ * returning FilterIirUpdate(&iir[index], FilterMedianUpdate(&median[index], value)).
+ */
+// #define ADC_FILTER(index, value)   AppFilter(index, value)
+
+/** @brief Number of triggers that found the previous scan still running. */
+extern volatile unsigned char AdcOverruns;
+
+/** @brief Initializes the A/D converter and the scan.
+ *
+ * Configures the converter clock and right-justified results and hooks AdcISR()
+ * to the ADC vector and AdcTriggerISR() to the trigger vector, unless
+ * ADC_ISR_HANDLER or the trigger's XXX_ISR_HANDLER names them statically.
+ * Call IntrruptInit() or enable the global interrupt afterwards.
+ */
+void AdcInit(void);
+
+/** @brief Starts scanning, continuously or on each trigger. */
+void AdcStart(void);
+
+/** @brief Stops scanning; the conversion in progress is discarded. */
+void AdcStop(void);
+
+/** @brief Reads the generation counter.
+ * @return The number of completed scans, modulo 256.
+ */
+unsigned char AdcGeneration(void);
+
+/** @brief Copies the latest output.
+ * @param values Array of ADC_SCAN_COUNT results, in scan list order.
+ * @param stamp Receives the trigger timer time of the first scan of the output,
+ *              in timer clocks since AdcStart(), always 0 when free-running;
+ *              pass 0 if not needed.
+ * @return The generation of the copied output, to compare with AdcGeneration().
+ */
+unsigned char AdcReadScan(unsigned int *values, unsigned long *stamp);
+
+/** @brief Reads one channel of the latest output.
+ * @param index Position of the channel in the scan list.
+ * @return The conversion result.
+ */
+unsigned int AdcRead(unsigned char index);
+
+/** @brief A/D conversion complete handler.
+ * Stores the result and starts the next channel of the scan.
+ */
+void AdcISR(void);
+
+/** @brief Trigger compare handler.
+ * Starts a scan and stamps it with the trigger timer count.
+ */
+void AdcTriggerISR(void);
+
+#endif // ADC_H
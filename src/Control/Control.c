@@ -0,0 +1,182 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Control.c
+ * @brief Implementation of the fixed-rate output control engine.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "Control.h"
+
+#if CONTROL_TIMER && !ISR_ENABLED(CONTROL_TIMER)
+    #error "The CONTROL_TIMER vector must be enabled in Interrupt.h"
+#endif
+
+static volatile unsigned char ControlPending;   // Control periods not yet taken
+static volatile unsigned char ControlDivider;   // Timer interrupts in the current period
+
+/** @brief Initializes the control period counter and hooks ControlTick(). */
+void ControlInit(void)
+{
+    ControlPending = 0;
+    ControlDivider = 0;
+
+    #if CONTROL_TIMER
+        #if ISR_DISPATCH_TABLE
+            InterruptRegister(CONTROL_TIMER, ControlTick);
+        #endif
+        EnableInterrupt(CONTROL_TIMER);
+    #endif
+}
+
+/** @brief Counts one timer interrupt. */
+void ControlTick(void)
+{
+    if (++ControlDivider < CONTROL_TIMER_DIVIDE)
+        return;
+
+    ControlDivider = 0;
+    if (ControlPending != 0xFF)
+        ControlPending++;
+}
+
+/** @brief Takes one elapsed control period.
+ * @return 1 if a control period has elapsed, otherwise 0.
+ */
+char ControlDue(void)
+{
+    CritState state;
+
+    if (!ControlPending)
+        return 0;
+
+    state = crit_enter();
+    ControlPending--;
+    crit_exit(state);
+    return 1;
+}
+
+/** @brief Initializes a hysteresis output, switched off.
+ * @param relay The output state.
+ * @param mode CONTROL_ACTIVE_ABOVE or CONTROL_ACTIVE_BELOW.
+ * @param minOn Shortest on time, in control periods.
+ * @param minOff Shortest off time, in control periods.
+ */
+void ControlRelayInit(ControlRelay *relay, unsigned char mode, unsigned int minOn, unsigned int minOff)
+{
+    relay->mode = mode;
+    relay->minOn = minOn;
+    relay->minOff = minOff;
+    relay->state = 0;
+    relay->held = 0;
+}
+
+/** @brief Sets the thresholds of a hysteresis output.
+ * @param relay The output state.
+ * @param setpoint The switch-on threshold.
+ * @param band The hysteresis band, 0 or more.
+ */
+void ControlRelaySetpoint(ControlRelay *relay, int setpoint, int band)
+{
+    relay->on = setpoint;
+    relay->off = (relay->mode == CONTROL_ACTIVE_BELOW) ? setpoint + band : setpoint - band;
+}
+
+/** @brief Updates a hysteresis output once per control period.
+ * @param relay The output state.
+ * @param value The measured value.
+ * @return The output state, 1 when on.
+ */
+char ControlRelayUpdate(ControlRelay *relay, int value)
+{
+    char below = (relay->mode == CONTROL_ACTIVE_BELOW);
+
+    if (relay->held != 0xFFFF)
+        relay->held++;
+
+    if (relay->state)
+    {
+        if ((below ? value > relay->off : value < relay->off) && relay->held >= relay->minOn)
+        {
+            relay->state = 0;
+            relay->held = 0;
+        }
+    }
+    else
+    {
+        if ((below ? value < relay->on : value > relay->on) && relay->held >= relay->minOff)
+        {
+            relay->state = 1;
+            relay->held = 0;
+        }
+    }
+
+    return relay->state;
+}
+
+#if CONTROL_PID
+
+/** @brief Initializes a PID output.
+ * @param pid The output state.
+ * @param kp Proportional gain, Q8.8.
+ * @param ki Integral gain, Q8.8.
+ * @param kd Derivative gain, Q8.8.
+ * @param max The largest output, e.g. the PWM period.
+ */
+void ControlPidInit(ControlPid *pid, Q8_8 kp, Q8_8 ki, Q8_8 kd, unsigned int max)
+{
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->max = max;
+    pid->setpoint = 0;
+    pid->integral = 0;
+    pid->primed = 0;
+}
+
+/** @brief Sets the target of a PID output.
+ * @param pid The output state.
+ * @param setpoint The target value.
+ */
+void ControlPidSetpoint(ControlPid *pid, int setpoint)
+{
+    pid->setpoint = setpoint;
+}
+
+/** @brief Updates a PID output once per control period.
+ * @param pid The output state.
+ * @param value The measured value.
+ * @return The output, 0 to max.
+ */
+unsigned int ControlPidUpdate(ControlPid *pid, int value)
+{
+    long top = (long)pid->max << 8;
+    long error = (long)pid->setpoint - value;
+    long sum;
+
+    pid->integral += (long)pid->ki * error;
+    if (pid->integral < 0)
+        pid->integral = 0;
+    else if (pid->integral > top)
+        pid->integral = top;
+
+    sum = (long)pid->kp * error + pid->integral;
+    if (pid->primed)
+        sum -= (long)pid->kd * ((long)value - pid->last);
+    pid->last = value;
+    pid->primed = 1;
+
+    // Clamp before scaling so that only non-negative values are shifted
+    if (sum <= 0)
+        return 0;
+    if (sum >= top)
+        return pid->max;
+    return (unsigned int)(sum >> 8);
+}
+
+#endif // CONTROL_PID
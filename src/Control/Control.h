@@ -0,0 +1,138 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Control.h
+ * @brief Header file for the fixed-rate output control engine for Holtek MCUs.
+ * On/off outputs (relays, pumps, heaters) switch with a hysteresis band and
+ * minimum on and off times, so a reading hovering at a threshold cannot chatter
+ * them. Proportional outputs (PWM duty) use a fixed-point PID. Both are updated
+ * once per control period, counted by a timer interrupt; the main loop runs the
+ * periods that have passed with ControlDue(). Thresholds are worked out when a
+ * setpoint is set, leaving two comparisons per update.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include "Interrupt.h"
+
+/** @brief Control period
+ * The control period is CONTROL_TIMER_DIVIDE calls of ControlTick(). By default
+ * the application calls it from its own periodic handler, which may run other
+ * jobs as well. To have ControlInit() hook a vector instead, set CONTROL_TIMER
+ * to its address, e.g. BASE_TIMER0_ISR_ADDRESS, and enable its ISR in
+ * Interrupt.h; without ISR_DISPATCH_TABLE, also name ControlTick as that
+ * vector's XXX_ISR_HANDLER.
+ */
+//=========================================================================
+#define CONTROL_TIMER          0
+#define CONTROL_TIMER_DIVIDE   1
+#define CONTROL_PID            Disable  // Enable for proportional outputs
+//=========================================================================
+
+/** @brief Relay modes */
+#define CONTROL_ACTIVE_ABOVE   0  // On above the setpoint, e.g. cooling
+#define CONTROL_ACTIVE_BELOW   1  // On below the setpoint, e.g. heating
+
+/** @brief Hysteresis output state. */
+typedef struct
+{
+    int on;               /**< Switch on beyond this value */
+    int off;              /**< Switch off beyond this value, back across the band */
+    unsigned int minOn;   /**< Shortest on time, in control periods */
+    unsigned int minOff;  /**< Shortest off time, in control periods */
+    unsigned int held;    /**< Control periods in the current state */
+    unsigned char mode;   /**< CONTROL_ACTIVE_ABOVE or CONTROL_ACTIVE_BELOW */
+    unsigned char state;  /**< 1 when on */
+} ControlRelay;
+
+/** @brief Initializes the control period counter and hooks ControlTick(). */
+void ControlInit(void);
+
+/** @brief Counts one timer interrupt. Called from the control timer vector. */
+void ControlTick(void);
+
+/** @brief Takes one elapsed control period.
+ * Call in a loop, updating every output once per period it returns 1, so that
+ * periods missed while the main loop was busy are still counted.
+ * @return 1 if a control period has elapsed, otherwise 0.
+ */
+char ControlDue(void);
+
+/** @brief Initializes a hysteresis output, switched off.
+ * @param relay The output state.
+ * @param mode CONTROL_ACTIVE_ABOVE or CONTROL_ACTIVE_BELOW.
+ * @param minOn Shortest on time, in control periods.
+ * @param minOff Shortest off time, in control periods.
+ */
+void ControlRelayInit(ControlRelay *relay, unsigned char mode, unsigned int minOn, unsigned int minOff);
+
+/** @brief Sets the thresholds of a hysteresis output.
+ * The output switches on past the setpoint and back off once the value has
+ * returned across the band, e.g. a cooler with setpoint 30 and band 2 runs
+ * from above 30 until below 28.
+ * @param relay The output state.
+ * @param setpoint The switch-on threshold.
+ * @param band The hysteresis band, 0 or more.
+ */
+void ControlRelaySetpoint(ControlRelay *relay, int setpoint, int band);
+
+/** @brief Updates a hysteresis output once per control period.
+ * @param relay The output state.
+ * @param value The measured value.
+ * @return The output state, 1 when on.
+ */
+char ControlRelayUpdate(ControlRelay *relay, int value);
+
+#if CONTROL_PID
+
+#include "FixedPoint.h"
+
+/** @brief PID output state. Gains are Q8.8, e.g. FIXED8_CONST(0.25). */
+typedef struct
+{
+    Q8_8 kp;              /**< Proportional gain */
+    Q8_8 ki;              /**< Integral gain, per control period */
+    Q8_8 kd;              /**< Derivative gain, per control period */
+    int setpoint;         /**< Target value */
+    int last;             /**< Previous measured value */
+    long integral;        /**< Integral term in 1/256, held within the output range */
+    unsigned int max;     /**< Output range 0 to max, e.g. the PWM period */
+    unsigned char primed; /**< last is valid */
+} ControlPid;
+
+/** @brief Initializes a PID output.
+ * @param pid The output state.
+ * @param kp Proportional gain, Q8.8.
+ * @param ki Integral gain, Q8.8.
+ * @param kd Derivative gain, Q8.8.
+ * @param max The largest output, e.g. the PWM period.
+ */
+void ControlPidInit(ControlPid *pid, Q8_8 kp, Q8_8 ki, Q8_8 kd, unsigned int max);
+
+/** @brief Sets the target of a PID output.
+ * @param pid The output state.
+ * @param setpoint The target value.
+ */
+void ControlPidSetpoint(ControlPid *pid, int setpoint);
+
+/** @brief Updates a PID output once per control period.
+ *
+ * The derivative acts on the measured value, so a setpoint step does not kick
+ * the output, and the integral stops growing at the ends of the output range.
+ *
+ * @param pid The output state.
+ * @param value The measured value.
+ * @return The output, 0 to max, e.g. a PWM duty.
+ */
+unsigned int ControlPidUpdate(ControlPid *pid, int value);
+
+#endif // CONTROL_PID
+
+#endif // CONTROL_H
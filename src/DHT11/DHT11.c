@@ -0,0 +1,194 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file DHT11.c
+ * @brief Implementation of the capture-based DHT11 driver.
+ * A frame has 42 falling edges after the start pulse is released: the
+ * sensor's response to the release, the 80us response high, then one per bit.
+ * The high times go into a ring and the last 40 are the bits, so a missed or
+ * extra edge before the data costs nothing and one within it fails the checksum.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "DHT11.h"
+
+#if !PTM_COMPAIR_P_ISR || !PTM_COMPAIR_A_ISR
+    #error "DHT11 requires PTM_COMPAIR_P_ISR and PTM_COMPAIR_A_ISR = Enable in Interrupt.h"
+#endif
+
+#ifndef F_CPU
+    #define F_CPU   4000000
+#endif
+
+#if DHT11_CLOCK == PT_SYS_DIVIDE_4
+    #define DHT11_CLOCK_HZ   (F_CPU / 4)
+#elif DHT11_CLOCK == PT_SYS
+    #define DHT11_CLOCK_HZ   F_CPU
+#elif DHT11_CLOCK == PT_H_DIVIDE_16
+    #define DHT11_CLOCK_HZ   (F_CPU / 16)
+#elif DHT11_CLOCK == PT_H_DIVIDE_64
+    #define DHT11_CLOCK_HZ   (F_CPU / 64)
+#else
+    #error "DHT11_CLOCK must be derived from fSYS or fH"
+#endif
+
+/** @brief Counter clocks in a time of us. */
+#define DHT11_COUNTS(us)     ((us) * (DHT11_CLOCK_HZ / 64) / 15625L)
+
+#define DHT11_PERIOD         1024
+#define DHT11_ONE_COUNTS     DHT11_COUNTS(DHT11_ONE_US)
+#define DHT11_START_PERIODS  ((DHT11_COUNTS(DHT11_START_US) + DHT11_PERIOD - 1) / DHT11_PERIOD + 1)
+#define DHT11_EDGES          42
+
+#if DHT11_COUNTS(200) >= DHT11_PERIOD || DHT11_COUNTS(100) > 255
+    #error "DHT11_CLOCK is too fast for a 1024-count period, pick a slower one"
+#endif
+
+#if DHT11_COUNTS(DHT11_ONE_US) < 8
+    #error "DHT11_CLOCK is too slow to tell the bits apart"
+#endif
+
+#if DHT11_START_PERIODS > 255
+    #error "DHT11_START_US is too long for DHT11_CLOCK"
+#endif
+
+// Read states
+#define DHT11_IDLE           0
+#define DHT11_START          1   // Holding the line low
+#define DHT11_CAPTURE        2   // Storing the high times
+#define DHT11_DONE           3   // Waiting for Dht11Read()
+
+static volatile unsigned char DhtState;
+static unsigned char DhtPeriods;             // Start pulse periods left
+static volatile unsigned char DhtCount;      // High times stored, up to DHT11_EDGES
+static unsigned char DhtHead;                // Slot of the next one, oldest overwritten
+static unsigned char DhtWidth[DHT11_EDGES];  // High times in counts, 255 at most
+
+/** @brief Configures the PTM for capture and hooks its vectors. */
+void Dht11Init(void)
+{
+    DhtState = DHT11_IDLE;
+
+    DHT11_PIN_PULLUP = 1;
+    DHT11_PIN_DIR = 1;
+
+    _pton = 0;
+    _ptpau = 0;
+    _ptck0 = DHT11_CLOCK & 1;
+    _ptck1 = (DHT11_CLOCK >> 1) & 1;
+    _ptck2 = (DHT11_CLOCK >> 2) & 1;
+    _ptm0 = PTM_CAPTURE_INPUT_MODE & 1;
+    _ptm1 = (PTM_CAPTURE_INPUT_MODE >> 1) & 1;
+    _ptio0 = 0;                         // Capture on both edges
+    _ptio1 = 1;
+    _ptcapts = PTM_PTPI_INPUT;
+    _pttclr0 = PTM_COMPARE_P_MATCH_OR_PTCK_PTPI_DUAL_EDGE & 1;
+    _pttclr1 = (PTM_COMPARE_P_MATCH_OR_PTCK_PTPI_DUAL_EDGE >> 1) & 1;
+    _ptmrpl = 0;                        // 0 = 1024 counts
+    _ptmrph = 0;
+
+    #if ISR_DISPATCH_TABLE
+        InterruptRegister(PTM_COMPAIR_P_ISR_ADDRESS, Dht11PeriodISR);
+        InterruptRegister(PTM_COMPAIR_A_ISR_ADDRESS, Dht11CaptureISR);
+    #endif
+    EnableInterrupt(PTM_COMPAIR_P_ISR_ADDRESS);
+    EnableInterrupt(PTM_COMPAIR_A_ISR_ADDRESS);
+}
+
+/** @brief Starts a read.
+ * @return 1 if started, 0 if a read is still running.
+ */
+char Dht11Start(void)
+{
+    if (DhtState == DHT11_START || DhtState == DHT11_CAPTURE)
+        return 0;
+
+    DhtCount = 0;
+    DhtHead = 0;
+    DhtPeriods = DHT11_START_PERIODS;
+    DhtState = DHT11_START;
+    DHT11_PIN = 0;
+    DHT11_PIN_DIR = 0;
+    _pton = 1;
+    return 1;
+}
+
+/** @brief Stores one captured level. */
+void Dht11CaptureISR(void)
+{
+    unsigned int width;
+
+    // The counter value latched on a falling edge is the high time before it
+    if (DhtState != DHT11_CAPTURE || _ptvlf)
+        return;
+
+    width = _ptmal;
+    width |= (unsigned int)(_ptmah & 3) << 8;
+    DhtWidth[DhtHead] = width > 255 ? 255 : (unsigned char)width;
+    if (++DhtHead == DHT11_EDGES)
+        DhtHead = 0;
+    if (DhtCount < DHT11_EDGES)
+        DhtCount++;
+}
+
+/** @brief Counts one PTM period: ends the start pulse, or the idle line ends the frame. */
+void Dht11PeriodISR(void)
+{
+    if (DhtState == DHT11_START)
+    {
+        if (--DhtPeriods)
+            return;
+        DHT11_PIN_DIR = 1;              // Released, the pull-up takes the line high
+        DhtState = DHT11_CAPTURE;
+        return;
+    }
+
+    _pton = 0;
+    if (DhtState == DHT11_CAPTURE)
+        DhtState = DHT11_DONE;
+}
+
+/** @brief Decodes the finished read.
+ * @param humidity Receives the relative humidity in %.
+ * @param temperature Receives the temperature in degrees C.
+ * @return DHT11_OK, or one of the DHT11 error codes.
+ */
+signed char Dht11Read(unsigned char *humidity, unsigned char *temperature)
+{
+    unsigned char data[5];
+    unsigned char slot;
+    unsigned char i;
+    unsigned char bit;
+
+    if (DhtState != DHT11_DONE)
+        return DHT11_BUSY;
+
+    DhtState = DHT11_IDLE;
+    if (DhtCount < 40)
+        return DHT11_NO_RESPONSE;
+
+    // The oldest of the last 40, without a modulo
+    slot = DhtHead >= 40 ? DhtHead - 40 : DhtHead + DHT11_EDGES - 40;
+    for (i = 0; i < 5; i++)
+    {
+        data[i] = 0;
+        for (bit = 0; bit < 8; bit++)
+        {
+            data[i] = (data[i] << 1) | (DhtWidth[slot] > DHT11_ONE_COUNTS);
+            if (++slot == DHT11_EDGES)
+                slot = 0;
+        }
+    }
+
+    if ((unsigned char)(data[0] + data[1] + data[2] + data[3]) != data[4])
+        return DHT11_CHECKSUM_ERROR;
+
+    *humidity = data[0];
+    *temperature = data[2];
+    return DHT11_OK;
+}
@@ -0,0 +1,92 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file DHT11.h
+ * @brief Header file for the capture-based DHT11 humidity/temperature driver for Holtek MCUs.
+ * The PTM runs in capture mode on both edges of the data line, clearing its
+ * counter on every edge, so each capture holds the length of the level that
+ * just ended. The capture interrupt only stores the high times; the bits are
+ * decoded and checksummed later by Dht11Read() in the main loop. The PTM
+ * comparator P interrupt times the start pulse and, once the line has been
+ * idle for a whole period, ends the frame. No code waits on the line, and an
+ * interrupt delaying the capture ISR does not change the captured width.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef DHT11_H
+#define DHT11_H
+
+#include "Interrupt.h"
+#include "PTM.h"
+
+/** @brief Data line, the PTPI capture pin
+ * The pin is fixed by the PTM capture input, so the other drivers keep clear of
+ * PA1. DHT11_PINS_PA and DHT11_PINS_PB list it as port masks for the overlap
+ * checks.
+ */
+//=========================================================================
+#define DHT11_PIN          _pa1
+#define DHT11_PIN_DIR      _pac1    // Port control, 1 = input
+#define DHT11_PIN_PULLUP   _papu1
+#define DHT11_PINS_PA      0x02
+#define DHT11_PINS_PB      0x00
+//=========================================================================
+
+#if (DHT11_PINS_PA & UART_PINS_PA) || (DHT11_PINS_PB & UART_PINS_PB)
+    #error "The DHT11 pin overlaps the UART pins"
+#endif
+#if (DHT11_PINS_PA & LCD_PINS_PA) || (DHT11_PINS_PB & LCD_PINS_PB)
+    #error "The DHT11 pin overlaps the LCD pins"
+#endif
+#if (DHT11_PINS_PA & KEYPAD_PINS_PA) || (DHT11_PINS_PB & KEYPAD_PINS_PB)
+    #error "The DHT11 pin overlaps the keypad pins"
+#endif
+#if (DHT11_PINS_PA & SEG_PINS_PA) || (DHT11_PINS_PB & SEG_PINS_PB)
+    #error "The DHT11 pin overlaps the 7-segment pins"
+#endif
+
+/** @brief Timing
+ * Dht11Init() takes over the PTM: DHT11_CLOCK is its counter clock (a PT_xxx
+ * selection) and the period is 1024 counts, which must outlast the longest
+ * level of a frame. A high level longer than DHT11_ONE_US is a 1 bit
+ * (26~28us is a 0, 70us a 1).
+ */
+//=========================================================================
+#define DHT11_CLOCK        PT_SYS_DIVIDE_4
+#define DHT11_START_US     18000    // Start pulse, at least 18ms
+#define DHT11_ONE_US       50
+//=========================================================================
+
+/** @brief Results of Dht11Read(), a signed char since the errors are negative */
+#define DHT11_OK               0
+#define DHT11_BUSY            -1   /**< No finished read to decode */
+#define DHT11_NO_RESPONSE     -2   /**< Fewer than 40 bits were seen */
+#define DHT11_CHECKSUM_ERROR  -3
+
+/** @brief Configures the PTM for capture and hooks its vectors. */
+void Dht11Init(void);
+
+/** @brief Starts a read; the sensor needs at least 1s between reads.
+ * @return 1 if started, 0 if a read is still running.
+ */
+char Dht11Start(void);
+
+/** @brief Decodes the finished read.
+ * @param humidity Receives the relative humidity in %.
+ * @param temperature Receives the temperature in degrees C.
+ * @return DHT11_OK, or one of the DHT11 error codes.
+ */
+signed char Dht11Read(unsigned char *humidity, unsigned char *temperature);
+
+/** @brief Stores one captured level. Called from the PTM comparator A vector. */
+void Dht11CaptureISR(void);
+
+/** @brief Counts one PTM period. Called from the PTM comparator P vector. */
+void Dht11PeriodISR(void);
+
+#endif // DHT11_H
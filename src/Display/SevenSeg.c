@@ -0,0 +1,228 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file SevenSeg.c
+ * @brief Implementation of the multiplexed 7-segment display driver.
+ * Brightness is kept as the CCRA value of each digit, worked out when it is
+ * set, so a slot costs the refresh interrupt two port writes and a CCRA load.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "SevenSeg.h"
+
+#if SEVEN_SEG
+
+#if STM_SELECT_CLEAR_COMPARE_MATCH != STM_COMPARE_MATCH_P
+    #error "SevenSeg requires STM_SELECT_CLEAR_COMPARE_MATCH = STM_COMPARE_MATCH_P"
+#endif
+
+#if !STM_COMPAIR_P_ISR || !STM_COMPAIR_A_ISR
+    #error "SevenSeg requires STM_COMPAIR_P_ISR and STM_COMPAIR_A_ISR = Enable in Interrupt.h"
+#endif
+
+#if SEG_LEVELS != 8 && SEG_LEVELS != 16
+    #error "SEG_LEVELS must be 8 or 16"
+#endif
+
+#if SEG_DIGITS > 5
+    #error "SevenSegWriteNumber() handles up to 5 digits"
+#endif
+
+// Clocks of on-time per brightness level
+#define SEG_LEVEL_CLOCKS   ((STM_P_PERIOD_CLOCKS - SEG_DEAD_CLOCKS) / SEG_LEVELS)
+
+#define SEG_DIGIT_BITS     SEG_DIGIT_PINS
+#define SEG_DIGIT_FIRST    (SEG_DIGIT_PINS & -SEG_DIGIT_PINS)   // Lowest common, the leftmost digit
+#define SEG_BIT_COUNT(m)   (((m) & 1) + (((m) >> 1) & 1) + (((m) >> 2) & 1) + (((m) >> 3) & 1) + \
+                            (((m) >> 4) & 1) + (((m) >> 5) & 1) + (((m) >> 6) & 1) + (((m) >> 7) & 1))
+
+#if SEG_BIT_COUNT(SEG_DIGIT_PINS) != SEG_DIGITS || SEG_DIGIT_PINS > 0xFF
+    #error "SEG_DIGIT_PINS must have SEG_DIGITS bits set"
+#endif
+
+#if SEG_SEGMENTS_ACTIVE_LOW
+    #define SEG_SEGMENTS_OFF   0xFF
+#else
+    #define SEG_SEGMENTS_OFF   0x00
+#endif
+
+#if SEG_DIGITS_ACTIVE_LOW
+    #define SEG_DIGITS_OFF     SEG_DIGIT_BITS
+#else
+    #define SEG_DIGITS_OFF     0
+#endif
+
+/** @brief Segment patterns of the hex digits. */
+static const unsigned char SevenSegTable[16] =
+{
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,          // 0
+    SEG_B | SEG_C,                                          // 1
+    SEG_A | SEG_B | SEG_D | SEG_E | SEG_G,                  // 2
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_G,                  // 3
+    SEG_B | SEG_C | SEG_F | SEG_G,                          // 4
+    SEG_A | SEG_C | SEG_D | SEG_F | SEG_G,                  // 5
+    SEG_A | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,          // 6
+    SEG_A | SEG_B | SEG_C,                                  // 7
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,  // 8
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_F | SEG_G,          // 9
+    SEG_A | SEG_B | SEG_C | SEG_E | SEG_F | SEG_G,          // A
+    SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,                  // b
+    SEG_A | SEG_D | SEG_E | SEG_F,                          // C
+    SEG_B | SEG_C | SEG_D | SEG_E | SEG_G,                  // d
+    SEG_A | SEG_D | SEG_E | SEG_F | SEG_G,                  // E
+    SEG_A | SEG_E | SEG_F | SEG_G                           // F
+};
+
+/** @brief Powers of ten for the digit positions of SevenSegWriteNumber(). */
+static const unsigned int SevenSegPowers[5] = { 10000, 1000, 100, 10, 1 };
+
+static volatile unsigned char SevenSegBuffer[SEG_DIGITS];   // Segment patterns
+static volatile unsigned int SevenSegOnTime[SEG_DIGITS];    // CCRA of each digit, 0 = dark
+static unsigned char SevenSegDigit;                         // Digit lit in the current slot
+static unsigned char SevenSegDigitBit;                      // Its common line
+
+/** @brief Initializes the pins, hooks the STM vectors and blanks the buffer. */
+void SevenSegInit(void)
+{
+    unsigned char i;
+
+    SEG_SEGMENT_PORT = SEG_SEGMENTS_OFF;
+    SEG_SEGMENT_DIR = 0x00;
+    SEG_DIGIT_PORT = (SEG_DIGIT_PORT & ~SEG_DIGIT_BITS) | SEG_DIGITS_OFF;
+    SEG_DIGIT_DIR &= ~SEG_DIGIT_BITS;
+
+    for (i = 0; i < SEG_DIGITS; i++)
+    {
+        SevenSegBuffer[i] = SEG_BLANK;
+        SevenSegOnTime[i] = SEG_LEVEL_CLOCKS * SEG_LEVELS;
+    }
+    SevenSegDigit = SEG_DIGITS - 1;
+
+    #if ISR_DISPATCH_TABLE
+        InterruptRegister(STM_COMPAIR_P_ISR_ADDRESS, SevenSegRefreshISR);
+        InterruptRegister(STM_COMPAIR_A_ISR_ADDRESS, SevenSegBlankISR);
+    #endif
+    EnableInterrupt(STM_COMPAIR_P_ISR_ADDRESS);
+    EnableInterrupt(STM_COMPAIR_A_ISR_ADDRESS);
+}
+
+/** @brief Sets the raw segments of a digit.
+ * @param digit Digit position, 0 = leftmost.
+ * @param pattern SEG_x bits.
+ */
+void SevenSegSetPattern(unsigned char digit, unsigned char pattern)
+{
+    SevenSegBuffer[digit] = pattern;
+}
+
+/** @brief Shows a hex digit from the segment table, keeping the decimal point.
+ * @param digit Digit position, 0 = leftmost.
+ * @param value 0 to 15.
+ */
+void SevenSegSetDigit(unsigned char digit, unsigned char value)
+{
+    SevenSegBuffer[digit] = SevenSegTable[value & 0x0F] | (SevenSegBuffer[digit] & SEG_DP);
+}
+
+/** @brief Lights or clears the decimal point of a digit.
+ * @param digit Digit position, 0 = leftmost.
+ * @param on 1 to light it.
+ */
+void SevenSegSetDot(unsigned char digit, unsigned char on)
+{
+    if (on)
+        SevenSegBuffer[digit] |= SEG_DP;
+    else
+        SevenSegBuffer[digit] &= ~SEG_DP;
+}
+
+/** @brief Sets the brightness of a digit.
+ * @param digit Digit position, 0 = leftmost.
+ * @param level 0 (dark) to SEG_LEVELS.
+ */
+void SevenSegSetBrightness(unsigned char digit, unsigned char level)
+{
+    unsigned int onTime = 0;
+    CritState state;
+
+    if (level > SEG_LEVELS)
+        level = SEG_LEVELS;
+    while (level--)
+        onTime += SEG_LEVEL_CLOCKS;
+
+    state = crit_enter();
+    SevenSegOnTime[digit] = onTime;
+    crit_exit(state);
+}
+
+/** @brief Shows a number right-aligned with leading zeros blanked.
+ * @param value The number.
+ */
+void SevenSegWriteNumber(unsigned int value)
+{
+    const unsigned int *power = &SevenSegPowers[5 - SEG_DIGITS];
+    unsigned char digit;
+    unsigned char count;
+    unsigned char lead = 1;
+
+    #if SEG_DIGITS < 5
+        // The power above the leftmost digit does not fit
+        if (value >= power[-1])
+        {
+            for (digit = 0; digit < SEG_DIGITS; digit++)
+                SevenSegBuffer[digit] = SEG_MINUS;
+            return;
+        }
+    #endif
+
+    for (digit = 0; digit < SEG_DIGITS; digit++, power++)
+    {
+        for (count = 0; value >= *power; count++)
+            value -= *power;
+
+        if (count || digit == SEG_DIGITS - 1)
+            lead = 0;
+        SevenSegBuffer[digit] = lead ? SEG_BLANK : SevenSegTable[count];
+    }
+}
+
+/** @brief Starts a digit slot: lights the next digit and loads its on-time. */
+void SevenSegRefreshISR(void)
+{
+    unsigned int onTime;
+
+    if (++SevenSegDigit == SEG_DIGITS)
+    {
+        SevenSegDigit = 0;
+        SevenSegDigitBit = SEG_DIGIT_FIRST;
+    }
+    else
+    {
+        do
+            SevenSegDigitBit <<= 1;
+        while (!(SevenSegDigitBit & SEG_DIGIT_PINS));
+    }
+
+    onTime = SevenSegOnTime[SevenSegDigit];
+    if (!onTime)
+        return;
+
+    _stmal = onTime & 0xFF;
+    _stmah = (onTime >> 8) & 3;
+    SEG_SEGMENT_PORT = SevenSegBuffer[SevenSegDigit] ^ SEG_SEGMENTS_OFF;
+    SEG_DIGIT_PORT ^= SevenSegDigitBit;   // All commons are off here
+}
+
+/** @brief Ends the on-time of the lit digit. */
+void SevenSegBlankISR(void)
+{
+    SEG_DIGIT_PORT = (SEG_DIGIT_PORT & ~SEG_DIGIT_BITS) | SEG_DIGITS_OFF;
+    SEG_SEGMENT_PORT = SEG_SEGMENTS_OFF;
+}
+
+#endif // SEVEN_SEG
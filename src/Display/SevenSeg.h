@@ -0,0 +1,127 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file SevenSeg.h
+ * @brief Header file for the multiplexed 7-segment display driver for Holtek MCUs.
+ * Each STM period is one digit slot: the comparator P interrupt lights the next
+ * digit from a RAM segment buffer and the comparator A interrupt blanks it
+ * again, so the position of CCRA within the slot sets that digit's brightness.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef SEVEN_SEG_H
+#define SEVEN_SEG_H
+
+#include "Interrupt.h"
+#include "STM.h"
+
+//=========================================================================
+#define SEVEN_SEG  Disable  // Enable also requires STM clear on comparator P and both STM ISRs
+//=========================================================================
+
+/** @brief Display pins
+ * Segments a~g and dp are bits 0~7 of SEG_SEGMENT_PORT; digit commons are the
+ * SEG_DIGITS bits set in SEG_DIGIT_PINS on SEG_DIGIT_PORT, the leftmost digit
+ * on the lowest. The default commons PA2, PA4, PA5 and PA7 keep clear of the
+ * UART (PA3, PA6) and the DHT11 (PA1). The segments take the whole of port B,
+ * so the display is an alternative to the LCD and the keypad, and the checks
+ * below stop a build with either. SEG_PINS_PA and SEG_PINS_PB list the pins
+ * as port masks, so keep them in step with the ports above.
+ */
+//=========================================================================
+#define SEG_DIGITS               4
+#define SEG_SEGMENT_PORT         _pb
+#define SEG_SEGMENT_DIR          _pbc    // Port control, 1 = input
+#define SEG_DIGIT_PORT           _pa
+#define SEG_DIGIT_DIR            _pac
+#define SEG_DIGIT_PINS           0xB4    // PA2, PA4, PA5, PA7
+#define SEG_SEGMENTS_ACTIVE_LOW  Disable // Enable for common anode segments
+#define SEG_DIGITS_ACTIVE_LOW    Enable  // Enable when a common is lit by driving it low
+#define SEG_PINS_PA              (SEVEN_SEG ? SEG_DIGIT_PINS : 0)
+#define SEG_PINS_PB              (SEVEN_SEG ? 0xFF : 0)
+//=========================================================================
+
+#if (SEG_PINS_PA & UART_PINS_PA) || (SEG_PINS_PB & UART_PINS_PB)
+    #error "The 7-segment pins overlap the UART pins"
+#endif
+#if (SEG_PINS_PA & LCD_PINS_PA) || (SEG_PINS_PB & LCD_PINS_PB)
+    #error "The 7-segment pins overlap the LCD pins"
+#endif
+#if (SEG_PINS_PA & KEYPAD_PINS_PA) || (SEG_PINS_PB & KEYPAD_PINS_PB)
+    #error "The 7-segment pins overlap the keypad pins"
+#endif
+#if (SEG_PINS_PA & DHT11_PINS_PA) || (SEG_PINS_PB & DHT11_PINS_PB)
+    #error "The DHT11 pin overlaps the 7-segment pins"
+#endif
+
+/** @brief Brightness
+ * SEG_LEVELS steps of on-time per slot (8 or 16); level 0 keeps a digit dark.
+ * The slot is the STM comparator P period, e.g. STM_TARGET_PERIOD_US 1000 for
+ * a 250 Hz refresh of four digits. SEG_DEAD_CLOCKS of every slot stay dark so
+ * the blanking interrupt always runs before the next digit is lit.
+ */
+//=========================================================================
+#define SEG_LEVELS             16
+#define SEG_DEAD_CLOCKS        16
+//=========================================================================
+
+/** @brief Segment bits */
+#define SEG_A     0x01
+#define SEG_B     0x02
+#define SEG_C     0x04
+#define SEG_D     0x08
+#define SEG_E     0x10
+#define SEG_F     0x20
+#define SEG_G     0x40
+#define SEG_DP    0x80
+
+/** @brief Patterns beyond the hex digits */
+#define SEG_BLANK  0x00
+#define SEG_MINUS  SEG_G
+
+/** @brief Initializes the pins, hooks the STM vectors and blanks the buffer. */
+void SevenSegInit(void);
+
+/** @brief Sets the raw segments of a digit.
+ * @param digit Digit position, 0 = leftmost.
+ * @param pattern SEG_x bits.
+ */
+void SevenSegSetPattern(unsigned char digit, unsigned char pattern);
+
+/** @brief Shows a hex digit from the segment table, keeping the decimal point.
+ * @param digit Digit position, 0 = leftmost.
+ * @param value 0 to 15.
+ */
+void SevenSegSetDigit(unsigned char digit, unsigned char value);
+
+/** @brief Lights or clears the decimal point of a digit.
+ * @param digit Digit position, 0 = leftmost.
+ * @param on 1 to light it.
+ */
+void SevenSegSetDot(unsigned char digit, unsigned char on);
+
+/** @brief Sets the brightness of a digit.
+ * @param digit Digit position, 0 = leftmost.
+ * @param level 0 (dark) to SEG_LEVELS.
+ */
+void SevenSegSetBrightness(unsigned char digit, unsigned char level);
+
+/** @brief Shows a number right-aligned with leading zeros blanked.
+ * The digits are found by subtracting powers of ten, without division.
+ * A number too wide for the display shows as dashes.
+ * @param value The number.
+ */
+void SevenSegWriteNumber(unsigned int value);
+
+/** @brief Starts a digit slot. Called from the STM comparator P vector. */
+void SevenSegRefreshISR(void);
+
+/** @brief Ends the on-time of the lit digit. Called from the STM comparator A vector. */
+void SevenSegBlankISR(void);
+
+#endif // SEVEN_SEG_H
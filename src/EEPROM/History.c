@@ -0,0 +1,286 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file History.c
+ * @brief Implementation of the compressed temperature/humidity history log.
+ * A record is written behind a new end marker, last byte first, so an append
+ * cut short by a reset leaves the old end marker in place and the log intact.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "History.h"
+#include "UART.h"
+
+#define HISTORY_END        0xFF
+#define HISTORY_KEY        0xFE
+#define HISTORY_KEY_BYTES  7
+#define HISTORY_TIME_MASK  0x1FFFFFUL
+#define HISTORY_NO_REPEAT  0xFF
+#define HISTORY_LAST       (HISTORY_START + HISTORY_SIZE - 1)
+
+#if HISTORY_LAST > 255
+    #error "The history log must fit in the first 256 EEPROM bytes"
+#endif
+
+// The longest keyframe interval must fit twice, so a whole one always survives
+#if 2 * (HISTORY_KEY_BYTES + HISTORY_KEYFRAME) + 2 > HISTORY_SIZE
+    #error "HISTORY_KEYFRAME is too long for HISTORY_SIZE"
+#endif
+
+static unsigned char HistEnd;          // Address of the end marker
+static unsigned char HistRepeat;       // Count in the last record if a repeat, else HISTORY_NO_REPEAT
+static unsigned char HistRepeatAt;     // Its address
+static unsigned char HistRecords;      // Records since the last keyframe
+static unsigned char HistValid;        // The values below are the newest sample
+static unsigned long HistTime;
+static unsigned char HistTemperature;
+static unsigned char HistHumidity;
+static unsigned char HistOutputs;
+
+// Dump state
+static unsigned char HistDumpAt;       // Next byte to decode
+static unsigned char HistDumpLeft;     // Periods left in the current repeat
+static unsigned long HistDumpTime;
+static unsigned char HistDumpTemperature;
+static unsigned char HistDumpHumidity;
+static unsigned char HistDumpOutputs;
+
+/** @brief Address after another, wrapping within the region. */
+static unsigned char HistNext(unsigned char address)
+{
+    return address == HISTORY_LAST ? HISTORY_START : address + 1;
+}
+
+/** @brief Address before another, wrapping within the region. */
+static unsigned char HistPrevious(unsigned char address)
+{
+    return address == HISTORY_START ? HISTORY_LAST : address - 1;
+}
+
+/** @brief Reads one log byte. */
+static unsigned char HistRead(unsigned char address)
+{
+    char data;
+
+    readFromEEPROM(address, &data);
+    return (unsigned char)data;
+}
+
+/** @brief Whether an end marker starts at an address, not continuing a run of erased bytes. */
+static char HistIsEnd(unsigned char address)
+{
+    return HistRead(address) == HISTORY_END && HistRead(HistPrevious(address)) != HISTORY_END;
+}
+
+/** @brief Finds the end of the log, or starts an empty one.
+ * An append cut short leaves a second end marker up to one record after the
+ * real one; the first of the two is the end and the bytes up to the second are
+ * cleared, so no stray marker or partial keyframe stays in the log. Before the
+ * log first wraps, the erased bytes after the end read 0xFF too, so only a
+ * marker after a written byte counts as the second.
+ */
+void HistoryInit(void)
+{
+    unsigned char address = HISTORY_START;
+    unsigned char other;
+    unsigned char n;
+
+    for (n = 0; n < HISTORY_SIZE; n++, address++)
+    {
+        if (HistIsEnd(address))
+            break;
+    }
+    if (n == HISTORY_SIZE)
+    {
+        address = HISTORY_START;
+        writeToEEPROM(address, HISTORY_END);
+    }
+    else
+    {
+        // The real end may sit just before the last address of the region
+        other = address;
+        for (n = 0; n < HISTORY_KEY_BYTES; n++)
+        {
+            other = HistPrevious(other);
+            if (HistIsEnd(other))
+            {
+                address = other;
+                break;
+            }
+        }
+
+        other = address;
+        for (n = 0; n < HISTORY_KEY_BYTES; n++)
+        {
+            other = HistNext(other);
+            if (HistIsEnd(other))
+            {
+                while (other != address)
+                {
+                    writeToEEPROM(other, 0);
+                    other = HistPrevious(other);
+                }
+                break;
+            }
+        }
+    }
+
+    HistEnd = address;
+    HistRepeat = HISTORY_NO_REPEAT;
+    HistValid = 0;              // The first append after a reset is a keyframe
+}
+
+/** @brief Writes a record at the end of the log. */
+static void HistPut(const unsigned char *record, unsigned char count)
+{
+    unsigned char address = HistEnd;
+    unsigned char n;
+
+    for (n = 0; n < count; n++)
+        address = HistNext(address);
+    writeToEEPROM(address, HISTORY_END);
+    HistEnd = address;
+
+    while (count)
+    {
+        address = HistPrevious(address);
+        writeToEEPROM(address, record[--count]);
+    }
+}
+
+/** @brief Appends one sample. */
+void HistoryAppend(unsigned long time, unsigned char temperature,
+                   unsigned char humidity, unsigned char outputs)
+{
+    unsigned char record[HISTORY_KEY_BYTES];
+    int dTemperature = (int)temperature - HistTemperature;
+    int dHumidity = (int)humidity - HistHumidity;
+
+    time &= HISTORY_TIME_MASK;
+
+    if (HistValid && time == ((HistTime + 1) & HISTORY_TIME_MASK) && outputs == HistOutputs &&
+        HistRecords < HISTORY_KEYFRAME && dTemperature >= -3 && dTemperature <= 3 &&
+        dHumidity >= -7 && dHumidity <= 7)
+    {
+        HistTime = time;
+        HistTemperature = temperature;
+        HistHumidity = humidity;
+
+        if (dTemperature || dHumidity)
+        {
+            record[0] = 0x80 | ((dTemperature + 3) << 4) | (dHumidity + 7);
+            HistRepeat = HISTORY_NO_REPEAT;
+        }
+        else if (HistRepeat < 0x7F)
+        {
+            writeToEEPROM(HistRepeatAt, ++HistRepeat);
+            return;
+        }
+        else
+        {
+            record[0] = 0;
+            HistRepeat = 0;
+            HistRepeatAt = HistEnd;
+        }
+        HistRecords++;
+        HistPut(record, 1);
+        return;
+    }
+
+    record[0] = HISTORY_KEY;
+    record[1] = (time >> 14) & 0x7F;
+    record[2] = (time >> 7) & 0x7F;
+    record[3] = time & 0x7F;
+    record[4] = temperature & 0x7F;
+    record[5] = humidity & 0x7F;
+    record[6] = outputs & 0x7F;
+    HistPut(record, HISTORY_KEY_BYTES);
+
+    HistTime = time;
+    HistTemperature = record[4];
+    HistHumidity = record[5];
+    HistOutputs = record[6];
+    HistValid = 1;
+    HistRecords = 0;
+    HistRepeat = HISTORY_NO_REPEAT;
+}
+
+/** @brief Starts a dump at the oldest complete keyframe. */
+void HistoryDumpStart(void)
+{
+    unsigned char address = HistNext(HistEnd);
+    unsigned char n;
+
+    // Records after the end marker may have lost their start to the last append
+    for (n = 1; n < HISTORY_SIZE; n++, address = HistNext(address))
+    {
+        if (HistRead(address) == HISTORY_KEY)
+            break;
+    }
+    HistDumpAt = n < HISTORY_SIZE ? address : HistEnd;
+    HistDumpLeft = 0;
+}
+
+/** @brief Sends one sample line. */
+static void HistSend(void)
+{
+    UART_Printf("%lu,%u,%u,%u\r\n", HistDumpTime, HistDumpTemperature, HistDumpHumidity,
+                HistDumpOutputs);
+}
+
+/** @brief Sends the next sample over UART.
+ * @return 1 if a sample was sent, 0 at the end of the log.
+ */
+char HistoryDumpNext(void)
+{
+    unsigned char data;
+
+    if (HistDumpLeft)
+    {
+        HistDumpLeft--;
+        HistDumpTime = (HistDumpTime + 1) & HISTORY_TIME_MASK;
+        HistSend();
+        return 1;
+    }
+
+    if (HistDumpAt == HistEnd)
+        return 0;
+
+    data = HistRead(HistDumpAt);
+    HistDumpAt = HistNext(HistDumpAt);
+
+    if (data == HISTORY_KEY)
+    {
+        HistDumpTime = (unsigned long)HistRead(HistDumpAt) << 14;
+        HistDumpAt = HistNext(HistDumpAt);
+        HistDumpTime |= (unsigned int)HistRead(HistDumpAt) << 7;
+        HistDumpAt = HistNext(HistDumpAt);
+        HistDumpTime |= HistRead(HistDumpAt);
+        HistDumpAt = HistNext(HistDumpAt);
+        HistDumpTemperature = HistRead(HistDumpAt);
+        HistDumpAt = HistNext(HistDumpAt);
+        HistDumpHumidity = HistRead(HistDumpAt);
+        HistDumpAt = HistNext(HistDumpAt);
+        HistDumpOutputs = HistRead(HistDumpAt);
+        HistDumpAt = HistNext(HistDumpAt);
+    }
+    else if (data & 0x80)
+    {
+        HistDumpTime = (HistDumpTime + 1) & HISTORY_TIME_MASK;
+        HistDumpTemperature += ((data >> 4) & 7) - 3;
+        HistDumpHumidity += (data & 0x0F) - 7;
+    }
+    else
+    {
+        HistDumpTime = (HistDumpTime + 1) & HISTORY_TIME_MASK;
+        HistDumpLeft = data;
+    }
+
+    HistSend();
+    return 1;
+}
@@ -0,0 +1,62 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file History.h
+ * @brief Header file for the compressed temperature/humidity history log in EEPROM.
+ * Samples are taken once per period and stored in a circular EEPROM region as
+ * a byte stream, the oldest records being overwritten:
+ *
+ *   0xFF                 end of the log, always just after the newest record
+ *   0xFE t2 t1 t0 T H O  keyframe: 21-bit time, temperature, humidity and
+ *                        outputs, each a 7-bit payload byte
+ *   1TTTHHHH             next period: temperature moved by TTT - 3 and
+ *                        humidity by HHHH - 7
+ *   0nnnnnnn             n + 1 more periods with nothing changed
+ *
+ * Payload bytes are below 0x80 and a delta never has TTT = 7, so 0xFE and 0xFF
+ * only appear as markers. A keyframe is written every HISTORY_KEYFRAME records,
+ * and also after a time gap, a change of the outputs, or a step too large for
+ * a delta. An unchanged sample bumps the last repeat byte in place, so each
+ * append writes at most one record and the end marker.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "EEPROM.h"
+
+/** @brief Log region in EEPROM */
+//=========================================================================
+#define HISTORY_START       16
+#define HISTORY_SIZE        48
+#define HISTORY_KEYFRAME    16      // Records between keyframes, at most HISTORY_SIZE / 2 - 8
+//=========================================================================
+
+/** @brief Finds the end of the log, or starts an empty one. */
+void HistoryInit(void);
+
+/** @brief Appends one sample.
+ * @param time Sample time in periods; only the low 21 bits are kept.
+ * @param temperature Temperature, 0 to 127.
+ * @param humidity Humidity, 0 to 127.
+ * @param outputs Output bits, 0 to 127.
+ */
+void HistoryAppend(unsigned long time, unsigned char temperature,
+                   unsigned char humidity, unsigned char outputs);
+
+/** @brief Starts a dump at the oldest complete keyframe. */
+void HistoryDumpStart(void);
+
+/** @brief Sends the next sample over UART as "time,temperature,humidity,outputs".
+ * Reads only the bytes of that sample, so the log is never held in RAM.
+ * @return 1 if a sample was sent, 0 at the end of the log.
+ */
+char HistoryDumpNext(void);
+
+#endif // HISTORY_H
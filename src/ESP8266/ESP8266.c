@@ -0,0 +1,455 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file ESP8266.c
+ * @brief Implementation of the asynchronous ESP8266 AT-command engine.
+ * The receive side only recognizes lines and queues their results; the main
+ * loop side owns the command state. The two meet in a single-producer/
+ * single-consumer result ring, so neither side disables interrupts.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "ESP8266.h"
+#include "UART.h"
+
+#if ESP8266_TICKS(ESP8266_JOIN_MS) > 255 || ESP8266_TICKS(ESP8266_CONNECT_MS) > 255 || \
+    ESP8266_TICKS(ESP8266_RECONNECT_MS) > 255 || ESP8266_TICKS(ESP8266_BOOT_MS) > 255
+    #error "ESP8266 timeouts must fit in 255 ticks, raise ESP8266_TICK_MS"
+#endif
+
+#if ESP8266_QUEUE & (ESP8266_QUEUE - 1)
+    #error "ESP8266_QUEUE must be a power of two"
+#endif
+
+// Response results
+#define ESP_NONE         0
+#define ESP_OK           1
+#define ESP_ERROR        2
+#define ESP_PROMPT       3
+#define ESP_SEND_OK      4
+#define ESP_CLOSED       5
+
+// Link states
+#define ESP_OFFLINE      0   // Waiting out the boot or reconnect back-off
+#define ESP_JOINING      1   // Running the join script
+#define ESP_ONLINE       2
+
+// Phases of the command in flight
+#define ESP_IDLE         0
+#define ESP_REPLY        1   // Waiting for OK
+#define ESP_WAIT_PROMPT  2   // Waiting for the send prompt
+#define ESP_WAIT_SENT    3   // Waiting for SEND OK
+
+/** @brief Response lines, matched from the start of a line.
+ * "+IPD," and ">" act on their prefix; the others need the whole line.
+ */
+static const char *const EspPatterns[] =
+{
+    "OK", "ERROR", "FAIL", "SEND OK", "SEND FAIL", "ALREADY CONNECTED",
+    "CLOSED", "WIFI DISCONNECT", "+IPD,", ">"
+};
+static const unsigned char EspPatternResult[] =
+{
+    ESP_OK, ESP_ERROR, ESP_ERROR, ESP_SEND_OK, ESP_ERROR, ESP_OK,
+    ESP_CLOSED, ESP_CLOSED, ESP_NONE, ESP_PROMPT
+};
+#define ESP_PATTERNS     (sizeof(EspPatternResult))
+#define ESP_ALL_PATTERNS ((1u << ESP_PATTERNS) - 1)
+#define ESP_IPD_BIT      (1u << 8)
+#define ESP_PROMPT_BIT   (1u << 9)
+
+/** @brief Join script, run after power-on and after every drop. */
+static const char *const EspScript[] =
+{
+    "AT\r\n",
+    "ATE0\r\n",
+    "AT+CWMODE=1\r\n",
+    "AT+CWJAP=\"" ESP8266_SSID "\",\"" ESP8266_PASSWORD "\"\r\n",
+    "AT+CIPMUX=0\r\n",
+    "AT+CIPSTART=\"TCP\",\"" ESP8266_HOST "\"," ESP8266_PORT "\r\n"
+};
+static const unsigned char EspScriptTimeout[] =
+{
+    ESP8266_TICKS(ESP8266_REPLY_MS),
+    ESP8266_TICKS(ESP8266_REPLY_MS),
+    ESP8266_TICKS(ESP8266_REPLY_MS),
+    ESP8266_TICKS(ESP8266_JOIN_MS),
+    ESP8266_TICKS(ESP8266_REPLY_MS),
+    ESP8266_TICKS(ESP8266_CONNECT_MS)
+};
+#define ESP_SCRIPT_STEPS (sizeof(EspScriptTimeout))
+
+/** @brief A queued command: AT text, or data to send when text is 0. */
+typedef struct
+{
+    const char *text;
+    const char *data;
+    unsigned char length;
+    unsigned char timeout;
+} EspCommand;
+
+// Receive side, written by Esp8266RxByte()
+#define ESP_RESULTS      4
+static volatile unsigned char EspResults[ESP_RESULTS];
+static volatile unsigned char EspResultHead;    // Written by the receive side
+static volatile unsigned char EspResultTail;    // Written by the main loop
+static unsigned int EspAlive;                   // Patterns still matching the line
+static unsigned char EspColumn;                 // Bytes of the line so far
+static unsigned char EspIpdHeader;              // Reading the "+IPD,<length>:" header
+static unsigned int EspIpdLength;               // Payload bytes still to skip
+
+static volatile unsigned char EspTicks;
+
+// Main loop side
+static EspCommand EspQueue[ESP8266_QUEUE];
+static unsigned char EspQueueHead;
+static unsigned char EspQueueCount;
+static unsigned char EspState;
+static unsigned char EspPhase;
+static unsigned char EspStep;           // Join script step
+static unsigned char EspRetries;
+static unsigned char EspStart;          // Tick the current wait started
+static unsigned char EspTimeout;        // Ticks the current wait may last
+
+/** @brief Queues a result for the main loop; drops it if the ring is full. */
+static void EspPost(unsigned char result)
+{
+    unsigned char next = (EspResultHead + 1) & (ESP_RESULTS - 1);
+
+    if (next == EspResultTail)
+        return;
+    EspResults[EspResultHead] = result;
+    EspResultHead = next;
+}
+
+/** @brief Takes the oldest result, or ESP_NONE. */
+static unsigned char EspTake(void)
+{
+    unsigned char result;
+
+    if (EspResultTail == EspResultHead)
+        return ESP_NONE;
+    result = EspResults[EspResultTail];
+    EspResultTail = (EspResultTail + 1) & (ESP_RESULTS - 1);
+    return result;
+}
+
+/** @brief Initializes the engine; the join script starts after ESP8266_BOOT_MS. */
+void Esp8266Init(void)
+{
+    EspResultHead = 0;
+    EspResultTail = 0;
+    EspAlive = ESP_ALL_PATTERNS;
+    EspColumn = 0;
+    EspIpdHeader = 0;
+    EspIpdLength = 0;
+
+    EspQueueHead = 0;
+    EspQueueCount = 0;
+    EspState = ESP_OFFLINE;
+    EspPhase = ESP_IDLE;
+    EspRetries = 0;
+    EspStart = EspTicks;
+    EspTimeout = ESP8266_TICKS(ESP8266_BOOT_MS);
+
+    #if USIM_ISR
+        UART_SetReceiveHandler(Esp8266RxByte);
+    #endif
+}
+
+/** @brief Matches one received byte. */
+void Esp8266RxByte(char c)
+{
+    unsigned char i;
+    unsigned int bit;
+
+    if (EspIpdHeader)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            EspIpdLength = (EspIpdLength << 3) + (EspIpdLength << 1) + (c - '0');
+            return;
+        }
+        if (c == ',')           // "+IPD,<link>,<length>:" with several links
+        {
+            EspIpdLength = 0;
+            return;
+        }
+        EspIpdHeader = 0;
+        if (c == ':')
+            return;
+        EspIpdLength = 0;       // Malformed, go back to matching lines
+    }
+
+    // Received data may hold anything, even lines that look like responses
+    if (EspIpdLength)
+    {
+        EspIpdLength--;
+        return;
+    }
+
+    if (c == '\r' || c == '\n')
+    {
+        if (EspColumn)
+        {
+            for (i = 0, bit = 1; i < ESP_PATTERNS; i++, bit <<= 1)
+            {
+                if ((EspAlive & bit) && EspPatterns[i][EspColumn] == '\0' && EspPatternResult[i])
+                {
+                    EspPost(EspPatternResult[i]);
+                    break;
+                }
+            }
+        }
+        EspAlive = ESP_ALL_PATTERNS;
+        EspColumn = 0;
+        return;
+    }
+
+    if (!EspAlive)
+        return;
+
+    // A finished pattern has '\0' here, so a longer line drops it too
+    for (i = 0, bit = 1; i < ESP_PATTERNS; i++, bit <<= 1)
+    {
+        if ((EspAlive & bit) && EspPatterns[i][EspColumn] != c)
+            EspAlive &= ~bit;
+    }
+    EspColumn++;
+
+    if ((EspAlive & ESP_PROMPT_BIT) && EspColumn == 1)
+    {
+        EspPost(ESP_PROMPT);    // "> " is not followed by a line end
+        EspAlive = 0;
+    }
+    else if ((EspAlive & ESP_IPD_BIT) && EspColumn == 5)
+    {
+        EspIpdHeader = 1;
+        EspIpdLength = 0;
+        EspAlive = 0;
+    }
+}
+
+/** @brief Counts one tick. */
+void Esp8266Tick(void)
+{
+    EspTicks++;
+}
+
+/** @brief Writes a number of up to three digits without dividing. */
+static void EspPutNumber(unsigned char value)
+{
+    unsigned char hundreds = '0';
+    unsigned char tens = '0';
+
+    while (value >= 100)
+    {
+        value -= 100;
+        hundreds++;
+    }
+    while (value >= 10)
+    {
+        value -= 10;
+        tens++;
+    }
+
+    if (hundreds != '0')
+        UART_Transmit(hundreds);
+    if (hundreds != '0' || tens != '0')
+        UART_Transmit(tens);
+    UART_Transmit('0' + value);
+}
+
+/** @brief Sends a command and starts waiting for its reply. */
+static void EspIssue(const char *text, unsigned char length, unsigned char timeout)
+{
+    if (text)
+    {
+        UART_TransmitString(text);
+        EspPhase = ESP_REPLY;
+    }
+    else
+    {
+        UART_TransmitString("AT+CIPSEND=");
+        EspPutNumber(length);
+        UART_TransmitString("\r\n");
+        EspPhase = ESP_WAIT_PROMPT;
+    }
+    EspStart = EspTicks;
+    EspTimeout = timeout;
+}
+
+/** @brief Drops the link and schedules the join script. */
+static void EspDrop(void)
+{
+    EspState = ESP_OFFLINE;
+    EspPhase = ESP_IDLE;
+    EspRetries = 0;
+    EspStart = EspTicks;
+    EspTimeout = ESP8266_TICKS(ESP8266_RECONNECT_MS);
+}
+
+/** @brief Completes the command in flight. */
+static void EspDone(void)
+{
+    EspPhase = ESP_IDLE;
+    EspRetries = 0;
+
+    if (EspState == ESP_JOINING)
+    {
+        if (++EspStep == ESP_SCRIPT_STEPS)
+            EspState = ESP_ONLINE;
+    }
+    else
+    {
+        EspQueueHead = (EspQueueHead + 1) & (ESP8266_QUEUE - 1);
+        EspQueueCount--;
+    }
+}
+
+/** @brief Fails the command in flight: resend it, or give up and reconnect. */
+static void EspFail(void)
+{
+    EspPhase = ESP_IDLE;
+    if (++EspRetries <= ESP8266_RETRIES)
+        return;
+
+    if (EspState == ESP_ONLINE)
+    {
+        EspQueueHead = (EspQueueHead + 1) & (ESP8266_QUEUE - 1);
+        EspQueueCount--;
+    }
+    EspDrop();
+}
+
+/** @brief Applies one response to the command in flight. */
+static void EspHandle(unsigned char result)
+{
+    const EspCommand *command;
+
+    // The join script itself sees disconnects, so only an open link drops
+    if (result == ESP_CLOSED)
+    {
+        if (EspState == ESP_ONLINE)
+            EspDrop();
+        return;
+    }
+
+    switch (EspPhase)
+    {
+        case ESP_REPLY:
+            if (result == ESP_OK)
+                EspDone();
+            else if (result == ESP_ERROR)
+                EspFail();
+            break;
+
+        case ESP_WAIT_PROMPT:
+            if (result == ESP_PROMPT)
+            {
+                command = &EspQueue[EspQueueHead];
+                for (result = 0; result < command->length; result++)
+                    UART_Transmit(command->data[result]);
+                EspPhase = ESP_WAIT_SENT;
+                EspStart = EspTicks;
+            }
+            else if (result == ESP_ERROR)
+            {
+                EspFail();
+            }
+            break;
+
+        case ESP_WAIT_SENT:
+            if (result == ESP_SEND_OK)
+                EspDone();
+            else if (result == ESP_ERROR)
+                EspFail();
+            break;
+    }
+}
+
+/** @brief Handles responses and timeouts and sends the next command. */
+void Esp8266Poll(void)
+{
+    unsigned char result;
+    const EspCommand *command;
+
+    while ((result = EspTake()) != ESP_NONE)
+        EspHandle(result);
+
+    if (EspPhase != ESP_IDLE)
+    {
+        if ((unsigned char)(EspTicks - EspStart) < EspTimeout)
+            return;
+        EspFail();              // Timed out
+    }
+
+    switch (EspState)
+    {
+        case ESP_OFFLINE:
+            if ((unsigned char)(EspTicks - EspStart) < EspTimeout)
+                return;
+            EspState = ESP_JOINING;
+            EspStep = 0;
+            // Fall through
+
+        case ESP_JOINING:
+            EspIssue(EspScript[EspStep], 0, EspScriptTimeout[EspStep]);
+            break;
+
+        case ESP_ONLINE:
+            if (!EspQueueCount)
+                return;
+            command = &EspQueue[EspQueueHead];
+            EspIssue(command->text, command->length, command->timeout);
+            break;
+    }
+}
+
+/** @brief Reports whether the TCP link is up. */
+char Esp8266Online(void)
+{
+    return EspState == ESP_ONLINE;
+}
+
+/** @brief Adds a command at the tail of the queue. */
+static char EspQueueAdd(const char *text, const char *data, unsigned char length, unsigned char timeout)
+{
+    EspCommand *command;
+
+    if (EspQueueCount == ESP8266_QUEUE)
+        return 0;
+
+    command = &EspQueue[(EspQueueHead + EspQueueCount) & (ESP8266_QUEUE - 1)];
+    command->text = text;
+    command->data = data;
+    command->length = length;
+    command->timeout = timeout;
+    EspQueueCount++;
+    return 1;
+}
+
+/** @brief Queues an AT command, sent once online. */
+char Esp8266Command(const char *text, unsigned char timeout)
+{
+    return EspQueueAdd(text, 0, 0, timeout);
+}
+
+/** @brief Queues data for the TCP link. */
+char Esp8266Send(const char *data, unsigned char length)
+{
+    if (!length)
+        return 0;
+    return EspQueueAdd(0, data, length, ESP8266_TICKS(ESP8266_REPLY_MS));
+}
+
+/** @brief Number of queued commands, including the one in flight. */
+unsigned char Esp8266Pending(void)
+{
+    return EspQueueCount;
+}
@@ -0,0 +1,95 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file ESP8266.h
+ * @brief Header file for the asynchronous ESP8266 AT-command engine for Holtek MCUs.
+ * Commands go into a small queue and are sent one at a time; nothing waits for
+ * the module. Received bytes are matched against the known response lines as
+ * they arrive, so no line buffer is kept, and each command has a timeout
+ * counted in ticks. A command that keeps failing, or a dropped link, restarts
+ * the join script after a back-off, so the connection comes back by itself.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef ESP8266_H
+#define ESP8266_H
+
+/** @brief Access point and server */
+//=========================================================================
+#define ESP8266_SSID           "ssid"
+#define ESP8266_PASSWORD       "password"
+#define ESP8266_HOST           "192.168.1.100"
+#define ESP8266_PORT           "8080"
+//=========================================================================
+
+/** @brief Timing
+ * Esp8266Tick() must be called every ESP8266_TICK_MS, e.g. from a timer
+ * handler. Every timeout below must fit in 255 ticks.
+ */
+//=========================================================================
+#define ESP8266_TICK_MS        100
+#define ESP8266_BOOT_MS        2000    // Power-on to the first command
+#define ESP8266_REPLY_MS       1000    // Plain commands and sends
+#define ESP8266_JOIN_MS        20000   // Joining the access point
+#define ESP8266_CONNECT_MS     10000   // Opening the TCP link
+#define ESP8266_RECONNECT_MS   5000    // Back-off before joining again
+#define ESP8266_RETRIES        2       // Resends of a failed command
+//=========================================================================
+
+/** @brief Queued commands, a power of two. */
+#define ESP8266_QUEUE          4
+
+/** @brief Number of ticks covering a time in ms. */
+#define ESP8266_TICKS(ms)      (((ms) + ESP8266_TICK_MS - 1) / ESP8266_TICK_MS)
+
+/** @brief Initializes the engine and takes the UART receive interrupt.
+ * Call after UART_Init(); the join script starts after ESP8266_BOOT_MS.
+ * Taking the interrupt needs USIM_ISR = Enable in Interrupt.h, which the
+ * library leaves disabled; without it, the application must pass each
+ * received byte to Esp8266RxByte() itself.
+ */
+void Esp8266Init(void);
+
+/** @brief Matches one received byte. Called from the UART receive interrupt,
+ * through the handler Esp8266Init() sets with UART_SetReceiveHandler(), or by
+ * the application when USIM_ISR is disabled.
+ * @param c The byte.
+ */
+void Esp8266RxByte(char c);
+
+/** @brief Counts one tick. Called every ESP8266_TICK_MS. */
+void Esp8266Tick(void);
+
+/** @brief Handles responses and timeouts and sends the next command.
+ * Called from the main loop; returns without waiting.
+ */
+void Esp8266Poll(void);
+
+/** @brief Reports whether the TCP link is up.
+ * @return 1 when online, otherwise 0.
+ */
+char Esp8266Online(void);
+
+/** @brief Queues an AT command, sent once online.
+ * @param text The command with its "\r\n"; it must stay valid until sent.
+ * @param timeout Ticks to wait for OK.
+ * @return 1 if queued, 0 if the queue is full.
+ */
+char Esp8266Command(const char *text, unsigned char timeout);
+
+/** @brief Queues data for the TCP link.
+ * @param data The data; it must stay unchanged until Esp8266Pending() returns 0.
+ * @param length Number of bytes, 1 to 255.
+ * @return 1 if queued, 0 if the queue is full.
+ */
+char Esp8266Send(const char *data, unsigned char length);
+
+/** @brief Number of queued commands, including the one in flight. */
+unsigned char Esp8266Pending(void);
+
+#endif // ESP8266_H
@@ -0,0 +1,174 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Filter.c
+ * @brief Implementation of incremental integer filters for sensor streams.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "Filter.h"
+
+#if !(FILTER_MEDIAN_SIZE & 1) || FILTER_MEDIAN_SIZE > 15
+    #error "FILTER_MEDIAN_SIZE must be odd and at most 15"
+#endif
+
+#if FILTER_AVERAGE_SHIFT > 7
+    #error "FILTER_AVERAGE_SHIFT must be at most 7"
+#endif
+
+/** @brief Clears a moving average. */
+void FilterAverageInit(FilterAverage *filter)
+{
+    filter->primed = 0;
+}
+
+/** @brief Feeds a moving average.
+ * @param filter The filter state.
+ * @param sample The new sample.
+ * @return The mean of the last FILTER_AVERAGE_SIZE samples.
+ */
+unsigned int FilterAverageUpdate(FilterAverage *filter, unsigned int sample)
+{
+    unsigned char i;
+
+    if (!filter->primed)
+    {
+        for (i = 0; i < FILTER_AVERAGE_SIZE; i++)
+            filter->window[i] = sample;
+        filter->sum = (unsigned long)sample << FILTER_AVERAGE_SHIFT;
+        filter->head = 0;
+        filter->primed = 1;
+        return sample;
+    }
+
+    filter->sum += sample;
+    filter->sum -= filter->window[filter->head];
+    filter->window[filter->head] = sample;
+    filter->head = (filter->head + 1) & (FILTER_AVERAGE_SIZE - 1);
+
+    return (unsigned int)(filter->sum >> FILTER_AVERAGE_SHIFT);
+}
+
+/** @brief Clears a median filter. */
+void FilterMedianInit(FilterMedian *filter)
+{
+    filter->primed = 0;
+}
+
+/** @brief Feeds a median filter.
+ * @param filter The filter state.
+ * @param sample The new sample.
+ * @return The median of the last FILTER_MEDIAN_SIZE samples.
+ */
+unsigned int FilterMedianUpdate(FilterMedian *filter, unsigned int sample)
+{
+    unsigned int oldest;
+    unsigned char i;
+
+    if (!filter->primed)
+    {
+        for (i = 0; i < FILTER_MEDIAN_SIZE; i++)
+        {
+            filter->history[i] = sample;
+            filter->sorted[i] = sample;
+        }
+        filter->head = 0;
+        filter->primed = 1;
+        return sample;
+    }
+
+    oldest = filter->history[filter->head];
+    filter->history[filter->head] = sample;
+    if (++filter->head == FILTER_MEDIAN_SIZE)
+        filter->head = 0;
+
+    // Take over the slot of the oldest sample, then slide it into order
+    for (i = 0; filter->sorted[i] != oldest; i++)
+        ;
+    while (i > 0 && filter->sorted[i - 1] > sample)
+    {
+        filter->sorted[i] = filter->sorted[i - 1];
+        i--;
+    }
+    while (i < FILTER_MEDIAN_SIZE - 1 && filter->sorted[i + 1] < sample)
+    {
+        filter->sorted[i] = filter->sorted[i + 1];
+        i++;
+    }
+    filter->sorted[i] = sample;
+
+    return filter->sorted[FILTER_MEDIAN_SIZE / 2];
+}
+
+/** @brief Clears a first-order IIR filter.
+ * @param filter The filter state.
+ * @param shift The smoothing, 1 to 16.
+ */
+void FilterIirInit(FilterIir *filter, unsigned char shift)
+{
+    filter->shift = shift;
+    filter->primed = 0;
+}
+
+/** @brief Feeds a first-order IIR filter.
+ *
+ * The accumulator keeps shift fraction bits, so small steps are not lost to
+ * truncation and the output settles on the input exactly.
+ *
+ * @param filter The filter state.
+ * @param sample The new sample.
+ * @return The filtered value.
+ */
+unsigned int FilterIirUpdate(FilterIir *filter, unsigned int sample)
+{
+    if (!filter->primed)
+    {
+        filter->acc = (unsigned long)sample << filter->shift;
+        filter->primed = 1;
+        return sample;
+    }
+
+    // acc >= acc >> shift, so the unsigned accumulator never underflows
+    filter->acc -= filter->acc >> filter->shift;
+    filter->acc += sample;
+
+    return (unsigned int)(filter->acc >> filter->shift);
+}
+
+/** @brief Clears a rate of change estimator. */
+void FilterRateInit(FilterRate *filter)
+{
+    filter->primed = 0;
+}
+
+/** @brief Feeds a rate of change estimator.
+ * @param filter The filter state.
+ * @param sample The new sample.
+ * @return The change over the last FILTER_RATE_SPAN samples.
+ */
+int FilterRateUpdate(FilterRate *filter, unsigned int sample)
+{
+    unsigned int oldest;
+    unsigned char i;
+
+    if (!filter->primed)
+    {
+        for (i = 0; i < FILTER_RATE_SPAN; i++)
+            filter->window[i] = sample;
+        filter->head = 0;
+        filter->primed = 1;
+        return 0;
+    }
+
+    oldest = filter->window[filter->head];
+    filter->window[filter->head] = sample;
+    if (++filter->head == FILTER_RATE_SPAN)
+        filter->head = 0;
+
+    return (int)(sample - oldest);
+}
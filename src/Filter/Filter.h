@@ -0,0 +1,116 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Filter.h
+ * @brief Header file for incremental integer filters for sensor streams on Holtek MCUs.
+ * Each filter keeps its whole state in a record the caller declares (usually
+ * static), costs a bounded amount of work per sample and uses neither division
+ * nor floating point, so it can run in an interrupt service routine. Filters
+ * compose by nesting the update calls, e.g.
+ *     slope = FilterRateUpdate(&r, FilterIirUpdate(&i, FilterMedianUpdate(&m, adc)));
+ * The first sample fed to a filter fills its whole window, so there is no
+ * start-up ramp from zero.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+/** @brief Window sizes
+ * Moving average of 2^FILTER_AVERAGE_SHIFT samples, median of FILTER_MEDIAN_SIZE
+ * samples (odd, up to 15) and rate of change over FILTER_RATE_SPAN samples.
+ * Each window costs 2 bytes of RAM per sample and per instance.
+ */
+//=========================================================================
+#define FILTER_AVERAGE_SHIFT   3
+#define FILTER_MEDIAN_SIZE     5
+#define FILTER_RATE_SPAN       4
+//=========================================================================
+
+#define FILTER_AVERAGE_SIZE    (1 << FILTER_AVERAGE_SHIFT)
+
+/** @brief Moving average state. */
+typedef struct
+{
+    unsigned int  window[FILTER_AVERAGE_SIZE];  /**< Last samples, oldest at head */
+    unsigned long sum;                          /**< Sum of window */
+    unsigned char head;                         /**< Oldest sample */
+    unsigned char primed;                       /**< Window filled */
+} FilterAverage;
+
+/** @brief Median state. */
+typedef struct
+{
+    unsigned int  history[FILTER_MEDIAN_SIZE];  /**< Last samples, oldest at head */
+    unsigned int  sorted[FILTER_MEDIAN_SIZE];   /**< The same samples in ascending order */
+    unsigned char head;                         /**< Oldest sample */
+    unsigned char primed;                       /**< Window filled */
+} FilterMedian;
+
+/** @brief First-order IIR state: y += (x - y) / 2^shift. */
+typedef struct
+{
+    unsigned long acc;    /**< Output scaled by 2^shift */
+    unsigned char shift;  /**< Smoothing, 1 to 16; the time constant is about 2^shift samples */
+    unsigned char primed; /**< Accumulator loaded */
+} FilterIir;
+
+/** @brief Rate of change state. */
+typedef struct
+{
+    unsigned int  window[FILTER_RATE_SPAN];     /**< Last samples, oldest at head */
+    unsigned char head;                         /**< Oldest sample */
+    unsigned char primed;                       /**< Window filled */
+} FilterRate;
+
+/** @brief Clears a moving average. */
+void FilterAverageInit(FilterAverage *filter);
+
+/** @brief Feeds a moving average.
+ * @param filter The filter state.
+ * @param sample The new sample.
+ * @return The mean of the last FILTER_AVERAGE_SIZE samples.
+ */
+unsigned int FilterAverageUpdate(FilterAverage *filter, unsigned int sample);
+
+/** @brief Clears a median filter. */
+void FilterMedianInit(FilterMedian *filter);
+
+/** @brief Feeds a median filter.
+ * The sorted window is updated by moving the new sample from the slot of the
+ * oldest one, at most FILTER_MEDIAN_SIZE - 1 steps.
+ * @param filter The filter state.
+ * @param sample The new sample.
+ * @return The median of the last FILTER_MEDIAN_SIZE samples.
+ */
+unsigned int FilterMedianUpdate(FilterMedian *filter, unsigned int sample);
+
+/** @brief Clears a first-order IIR filter.
+ * @param filter The filter state.
+ * @param shift The smoothing, 1 to 16.
+ */
+void FilterIirInit(FilterIir *filter, unsigned char shift);
+
+/** @brief Feeds a first-order IIR filter.
+ * @param filter The filter state.
+ * @param sample The new sample.
+ * @return The filtered value.
+ */
+unsigned int FilterIirUpdate(FilterIir *filter, unsigned int sample);
+
+/** @brief Clears a rate of change estimator. */
+void FilterRateInit(FilterRate *filter);
+
+/** @brief Feeds a rate of change estimator.
+ * @param filter The filter state.
+ * @param sample The new sample.
+ * @return The change over the last FILTER_RATE_SPAN samples.
+ */
+int FilterRateUpdate(FilterRate *filter, unsigned int sample);
+
+#endif // FILTER_H
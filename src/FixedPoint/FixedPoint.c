@@ -0,0 +1,424 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file FixedPoint.c
+ * @brief Implementation of Q8.8 and Q16.16 fixed-point arithmetic.
+ * Q16.16 work is done on magnitudes in unsigned long, where 2^31 stands for
+ * "saturated", so intermediate results never need more than 32 bits.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "FixedPoint.h"
+
+#define FIXED_SATURATED  0x80000000UL   // Magnitude of FIXED_MIN, too large for FIXED_MAX
+
+/** @brief log2(1 + i/32) in Q0.16, i = 0 to 31, each raised by half the error of a
+ * straight line across its segments, which halves the interpolation error;
+ * log2(2) = 1 ends the last segment. */
+static const unsigned int FixedLog2Table[32] =
+{
+        6,  2915,  5737,  8478, 11141, 13731, 16252, 18708,
+    21102, 23436, 25714, 27939, 30112, 32237, 34315, 36348,
+    38339, 40288, 42198, 44070, 45906, 47707, 49474, 51209,
+    52913, 54586, 56230, 57847, 59436, 60998, 62536, 64049
+};
+
+/** @brief 1/m - 1 in Q0.16 at the middle of each sixteenth of m = 0.5 to 1. */
+static const unsigned int FixedReciprocalSeed[16] =
+{
+    61564, 54301, 47824, 42010, 36764, 32006, 27671, 23705,
+    20062, 16705, 13602, 10724,  8048,  5554,  3223,  1040
+};
+
+/** @brief Powers of ten for the digit loops of FixedToString(). */
+static const unsigned int FixedPowers[FIXED_DECIMALS + 1] = { 10000, 1000, 100, 10, 1 };
+
+/** @brief Magnitude of a Q16.16 value, FIXED_MIN included. */
+static unsigned long FixedMagnitude(Q16_16 value)
+{
+    return value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+}
+
+/** @brief Q16.16 value of a magnitude and a sign, saturated. */
+static Q16_16 FixedSigned(unsigned long magnitude, char negative)
+{
+    if (negative)
+        return magnitude >= FIXED_SATURATED ? FIXED_MIN : -(Q16_16)magnitude;
+    return magnitude >= FIXED_SATURATED ? FIXED_MAX : (Q16_16)magnitude;
+}
+
+/** @brief sum + term, stopping at FIXED_SATURATED so 32 bits never overflow. */
+static unsigned long FixedAccumulate(unsigned long sum, unsigned long term)
+{
+    if (term >= FIXED_SATURATED - sum)
+        return FIXED_SATURATED;
+    return sum + term;
+}
+
+/** @brief Q16.16 to Q8.8, rounded and saturated. */
+Q8_8 FixedTo8(Q16_16 value)
+{
+    if (value >= (Q16_16)FIXED8_MAX * 256 + 128)
+        return FIXED8_MAX;
+    if (value <= (Q16_16)FIXED8_MIN * 256)
+        return FIXED8_MIN;
+    return (Q8_8)((value + 128) >> 8);
+}
+
+/** @brief Saturating Q16.16 addition. */
+Q16_16 FixedAdd(Q16_16 a, Q16_16 b)
+{
+    if (b > 0 && a > FIXED_MAX - b)
+        return FIXED_MAX;
+    if (b < 0 && a < FIXED_MIN - b)
+        return FIXED_MIN;
+    return a + b;
+}
+
+/** @brief Saturating Q16.16 subtraction, a - b. */
+Q16_16 FixedSub(Q16_16 a, Q16_16 b)
+{
+    if (b < 0 && a > FIXED_MAX + b)
+        return FIXED_MAX;
+    if (b > 0 && a < FIXED_MIN + b)
+        return FIXED_MIN;
+    return a - b;
+}
+
+/** @brief Saturating Q16.16 multiplication, rounded to nearest.
+ * The 64-bit product is built from the four 16 x 16 bit partial products,
+ * keeping only the bits that land in the result.
+ */
+Q16_16 FixedMul(Q16_16 a, Q16_16 b)
+{
+    unsigned long ua = FixedMagnitude(a);
+    unsigned long ub = FixedMagnitude(b);
+    unsigned long ah = ua >> 16, al = ua & 0xFFFF;
+    unsigned long bh = ub >> 16, bl = ub & 0xFFFF;
+    unsigned long product;
+
+    if (ah * bh > 0x7FFF)
+        product = FIXED_SATURATED;
+    else
+    {
+        product = (ah * bh) << 16;
+        product = FixedAccumulate(product, ah * bl);
+        product = FixedAccumulate(product, al * bh);
+        product = FixedAccumulate(product, (al * bl + 0x8000) >> 16);
+    }
+    return FixedSigned(product, (a < 0) != (b < 0));
+}
+
+/** @brief Saturating Q16.16 division, rounded to nearest.
+ * @return a / b; a division by zero saturates to the sign of a.
+ */
+Q16_16 FixedDiv(Q16_16 a, Q16_16 b)
+{
+    unsigned long ua = FixedMagnitude(a);
+    unsigned long ub = FixedMagnitude(b);
+    unsigned long quotient, remainder;
+    unsigned char i;
+
+    if (!ub)
+        return a < 0 ? FIXED_MIN : FIXED_MAX;
+
+    quotient = ua / ub;
+    if (quotient > 0x8000)
+        return FixedSigned(FIXED_SATURATED, (a < 0) != (b < 0));
+    remainder = ua - quotient * ub;
+
+    // Fraction bits by shift and subtract; remainder < ub <= 2^31 never overflows
+    for (i = 0; i < 16; i++)
+    {
+        remainder <<= 1;
+        quotient <<= 1;
+        if (remainder >= ub)
+        {
+            remainder -= ub;
+            quotient |= 1;
+        }
+    }
+    if (remainder << 1 >= ub)
+        quotient++;
+    return FixedSigned(quotient, (a < 0) != (b < 0));
+}
+
+/** @brief Reciprocal from a 16 entry table and two Newton steps.
+ * The value is shifted to m in 0.5 to 1, the table gives 1/m within 3%,
+ * y = y * (2 - m * y) squares the error twice and the shift is undone.
+ * @return 1 / value within 2^-14 of it or one step; 0 saturates to FIXED_MAX.
+ */
+Q16_16 FixedReciprocal(Q16_16 value)
+{
+    unsigned long m = FixedMagnitude(value);
+    unsigned long y;
+    signed char shift = 0;
+    unsigned char i;
+
+    if (!m)
+        return FIXED_MAX;
+
+    while (m >= 0x10000UL)
+    {
+        m >>= 1;
+        shift++;
+    }
+    while (m < 0x8000UL)
+    {
+        m <<= 1;
+        shift--;
+    }
+
+    y = FIXED_ONE + FixedReciprocalSeed[(m >> 11) & 0x0F];
+    for (i = 0; i < 2; i++)
+        y = FixedMul(y, 2 * FIXED_ONE - FixedMul(m, y));
+
+    if (shift > 0)
+        y = (y + (1UL << (shift - 1))) >> shift;
+    else if (shift < 0)
+        y = y >= (FIXED_SATURATED >> -shift) ? FIXED_SATURATED : y << -shift;
+    return FixedSigned(y, value < 0);
+}
+
+/** @brief Square root, bit by bit with shifts.
+ * The root of the 48-bit value * 2^16 is found in two passes so no register
+ * grows past 32 bits: the top 24 bits of the root from the value, then the
+ * remainder and the root move up 16 bits for the last 8.
+ * @return The root rounded to nearest, 0 for negative values.
+ */
+Q16_16 FixedSqrt(Q16_16 value)
+{
+    unsigned long remainder, root = 0, bit;
+    unsigned char pass;
+
+    if (value <= 0)
+        return 0;
+
+    remainder = (unsigned long)value;
+    bit = (remainder & 0xFFF00000UL) ? 1UL << 30 : 1UL << 18;
+    while (bit > remainder)
+        bit >>= 2;
+
+    for (pass = 0; pass < 2; pass++)
+    {
+        while (bit)
+        {
+            if (remainder >= root + bit)
+            {
+                remainder -= root + bit;
+                root = (root >> 1) + bit;
+            }
+            else
+                root >>= 1;
+            bit >>= 2;
+        }
+        if (!pass)
+        {
+            if (remainder > 0xFFFFUL)
+            {
+                // Too large to shift: take the next root bit as 1/2 by hand
+                remainder = ((remainder - root) << 16) - 0x8000;
+                root = (root << 16) + 0x8000;
+            }
+            else
+            {
+                remainder <<= 16;
+                root <<= 16;
+            }
+            bit = 1UL << 14;
+        }
+    }
+    if (remainder > root)
+        root++;
+    return (Q16_16)root;
+}
+
+/** @brief Base 2 logarithm from a 32 entry table with linear interpolation.
+ * The value is shifted into 1 to 2, the shift count is the whole part.
+ * @return log2(value) within 0.00012, FIXED_MIN for values of 0 or less.
+ */
+Q16_16 FixedLog2(Q16_16 value)
+{
+    unsigned long x, low, span;
+    unsigned int step;
+    unsigned char index;
+    signed char exponent = 0;
+
+    if (value <= 0)
+        return FIXED_MIN;
+
+    x = (unsigned long)value;
+    while (x >= 0x20000UL)
+    {
+        x >>= 1;
+        exponent++;
+    }
+    while (x < 0x10000UL)
+    {
+        x <<= 1;
+        exponent--;
+    }
+
+    index = (unsigned char)((x >> 11) & 0x1F);
+    step = (unsigned int)(x & 0x7FF);
+    low = FixedLog2Table[index];
+    span = (index < 31 ? FixedLog2Table[index + 1] : FIXED_ONE) - low;
+    return FIXED_FROM_INT(exponent) + (Q16_16)(low + ((span * step + 0x400) >> 11));
+}
+
+/** @brief Natural logarithm, FixedLog2() scaled by ln(2). */
+Q16_16 FixedLn(Q16_16 value)
+{
+    if (value <= 0)
+        return FIXED_MIN;
+    return FixedMul(FixedLog2(value), FIXED_LN2);
+}
+
+/** @brief Saturating Q8.8 addition. */
+Q8_8 FixedAdd8(Q8_8 a, Q8_8 b)
+{
+    long sum = (long)a + b;
+
+    if (sum > FIXED8_MAX)
+        return FIXED8_MAX;
+    if (sum < FIXED8_MIN)
+        return FIXED8_MIN;
+    return (Q8_8)sum;
+}
+
+/** @brief Saturating Q8.8 subtraction, a - b. */
+Q8_8 FixedSub8(Q8_8 a, Q8_8 b)
+{
+    long difference = (long)a - b;
+
+    if (difference > FIXED8_MAX)
+        return FIXED8_MAX;
+    if (difference < FIXED8_MIN)
+        return FIXED8_MIN;
+    return (Q8_8)difference;
+}
+
+/** @brief Saturating Q8.8 multiplication, rounded to nearest. */
+Q8_8 FixedMul8(Q8_8 a, Q8_8 b)
+{
+    return FixedTo8((Q16_16)a * b);
+}
+
+/** @brief Writes number with the digits of FixedPowers from first on.
+ * Leading zeros are dropped unless keep is set; the last digit always stays.
+ */
+static char *FixedDigits(char *p, unsigned long number, unsigned char first, char keep)
+{
+    unsigned char i;
+    char digit;
+
+    for (i = first; i <= FIXED_DECIMALS; i++)
+    {
+        digit = '0';
+        while (number >= FixedPowers[i])
+        {
+            number -= FixedPowers[i];
+            digit++;
+        }
+        if (digit != '0' || keep || i == FIXED_DECIMALS)
+        {
+            *p++ = digit;
+            keep = 1;
+        }
+    }
+    return p;
+}
+
+/** @brief Writes a value in decimal, e.g. "-12.50", without division.
+ * @param value The value.
+ * @param decimals Digits after the point, 0 to FIXED_DECIMALS; the value is rounded to them.
+ * @param buffer Room for 8 + decimals characters with the terminating 0.
+ * @return The length of the string.
+ */
+unsigned char FixedToString(Q16_16 value, unsigned char decimals, char *buffer)
+{
+    unsigned long magnitude = FixedMagnitude(value);
+    unsigned long whole, fraction, scale;
+    char *p = buffer;
+
+    if (decimals > FIXED_DECIMALS)
+        decimals = FIXED_DECIMALS;
+    scale = FixedPowers[FIXED_DECIMALS - decimals];
+
+    whole = magnitude >> 16;
+    fraction = ((magnitude & 0xFFFF) * scale + 0x8000) >> 16;
+    if (fraction >= scale)
+    {
+        fraction -= scale;
+        whole++;
+    }
+
+    if (value < 0 && (whole || fraction))
+        *p++ = '-';
+    p = FixedDigits(p, whole, 0, 0);
+    if (decimals)
+    {
+        *p++ = '.';
+        p = FixedDigits(p, fraction, FIXED_DECIMALS + 1 - decimals, 1);
+    }
+    *p = 0;
+    return (unsigned char)(p - buffer);
+}
+
+/** @brief Reads a decimal number such as "23", "-0.125" or "+4.", saturating.
+ * Fraction digits are folded in from the last one, fraction = (fraction + digit) / 10,
+ * with 8 guard bits; digits past the eighth are read but cannot change the result.
+ * @param text The string; reading stops at the first character that does not fit.
+ * @param value Receives the value, rounded to nearest.
+ * @return The number of characters read, 0 if text does not start with a number.
+ */
+unsigned char FixedFromString(const char *text, Q16_16 *value)
+{
+    const char *p = text;
+    const char *point;
+    unsigned long whole = 0, fraction = 0;
+    unsigned char digits = 0, count;
+    char negative = 0;
+
+    if (*p == '-' || *p == '+')
+        negative = *p++ == '-';
+
+    while (*p >= '0' && *p <= '9')
+    {
+        if (whole <= 0x8000UL)
+            whole = whole * 10 + (unsigned char)(*p - '0');
+        p++;
+        digits++;
+    }
+
+    if (*p == '.')
+    {
+        point = ++p;
+        while (*p >= '0' && *p <= '9')
+        {
+            p++;
+            digits++;
+        }
+        count = (unsigned char)(p - point);
+        if (count > 8)
+            count = 8;
+        while (count)
+        {
+            count--;
+            fraction = (fraction + ((unsigned long)(unsigned char)(point[count] - '0') << 24)) / 10;
+        }
+        fraction = (fraction + 0x80) >> 8;
+    }
+
+    if (!digits)
+        return 0;
+    if (whole > 0x8000UL)
+        whole = 0x8000UL;
+    *value = FixedSigned((whole << 16) + fraction, negative);
+    return (unsigned char)(p - text);
+}
@@ -0,0 +1,114 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file FixedPoint.h
+ * @brief Header file for Q8.8 and Q16.16 fixed-point arithmetic on Holtek MCUs.
+ * A Q16.16 value is a long holding the real value times 65536, a Q8.8 value an
+ * int holding it times 256. Every operation saturates at the limits of its
+ * type instead of wrapping, so a control loop or a filter driven out of range
+ * stays at the rail. Reciprocal, square root and logarithm use small tables
+ * and shifts, and the string conversions use no division on the output side,
+ * so none of this pulls in the floating-point library. The same functions
+ * serve the NTC conversion, PWM duty math, filters and control loops.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+/** @brief Fixed-point types */
+typedef long Q16_16;   /**< 16 integer bits with sign, 16 fraction bits */
+typedef int  Q8_8;     /**< 8 integer bits with sign, 8 fraction bits */
+
+#define FIXED_ONE      65536L
+#define FIXED_MAX      2147483647L
+#define FIXED_MIN      (-FIXED_MAX - 1)
+#define FIXED_LN2      45426L         // ln(2) in Q16.16
+
+#define FIXED8_ONE     256
+#define FIXED8_MAX     32767
+#define FIXED8_MIN     (-FIXED8_MAX - 1)
+
+/** @brief Most decimals FixedToString() writes */
+#define FIXED_DECIMALS 4
+
+/** @brief Q16.16 constant from a literal, folded by the compiler, e.g. FIXED_CONST(0.25). */
+#define FIXED_CONST(x)       ((Q16_16)((x) * 65536.0 + ((x) < 0 ? -0.5 : 0.5)))
+#define FIXED8_CONST(x)      ((Q8_8)((x) * 256.0 + ((x) < 0 ? -0.5 : 0.5)))
+
+/** @brief Conversions from whole numbers, -32768 to 32767 for Q16.16, -128 to 127 for Q8.8. */
+#define FIXED_FROM_INT(i)    ((Q16_16)(i) * FIXED_ONE)
+#define FIXED8_FROM_INT(i)   ((Q8_8)((i) * FIXED8_ONE))
+
+/** @brief Whole part, rounded towards minus infinity. */
+#define FIXED_TO_INT(f)      ((int)((f) >> 16))
+#define FIXED8_TO_INT(f)     ((int)((f) >> 8))
+
+/** @brief Q8.8 to Q16.16, always exact. */
+#define FIXED_FROM8(f)       ((Q16_16)(f) * 256)
+
+/** @brief Q16.16 to Q8.8, rounded and saturated. */
+Q8_8 FixedTo8(Q16_16 value);
+
+/** @brief Saturating Q16.16 addition. */
+Q16_16 FixedAdd(Q16_16 a, Q16_16 b);
+
+/** @brief Saturating Q16.16 subtraction, a - b. */
+Q16_16 FixedSub(Q16_16 a, Q16_16 b);
+
+/** @brief Saturating Q16.16 multiplication, rounded to nearest. */
+Q16_16 FixedMul(Q16_16 a, Q16_16 b);
+
+/** @brief Saturating Q16.16 division, rounded to nearest.
+ * @return a / b; a division by zero saturates to the sign of a.
+ */
+Q16_16 FixedDiv(Q16_16 a, Q16_16 b);
+
+/** @brief Reciprocal from a 16 entry table and two Newton steps.
+ * @return 1 / value within 2^-14 of it or one step; 0 saturates to FIXED_MAX.
+ */
+Q16_16 FixedReciprocal(Q16_16 value);
+
+/** @brief Square root, bit by bit with shifts.
+ * @return The root rounded to nearest, 0 for negative values.
+ */
+Q16_16 FixedSqrt(Q16_16 value);
+
+/** @brief Base 2 logarithm from a 32 entry table with linear interpolation.
+ * @return log2(value) within 0.00012, FIXED_MIN for values of 0 or less.
+ */
+Q16_16 FixedLog2(Q16_16 value);
+
+/** @brief Natural logarithm, FixedLog2() scaled by ln(2). */
+Q16_16 FixedLn(Q16_16 value);
+
+/** @brief Saturating Q8.8 addition. */
+Q8_8 FixedAdd8(Q8_8 a, Q8_8 b);
+
+/** @brief Saturating Q8.8 subtraction, a - b. */
+Q8_8 FixedSub8(Q8_8 a, Q8_8 b);
+
+/** @brief Saturating Q8.8 multiplication, rounded to nearest. */
+Q8_8 FixedMul8(Q8_8 a, Q8_8 b);
+
+/** @brief Writes a value in decimal, e.g. "-12.50", without division.
+ * @param value The value.
+ * @param decimals Digits after the point, 0 to FIXED_DECIMALS; the value is rounded to them.
+ * @param buffer Room for 8 + decimals characters with the terminating 0.
+ * @return The length of the string.
+ */
+unsigned char FixedToString(Q16_16 value, unsigned char decimals, char *buffer);
+
+/** @brief Reads a decimal number such as "23", "-0.125" or "+4.", saturating.
+ * @param text The string; reading stops at the first character that does not fit.
+ * @param value Receives the value, rounded to nearest.
+ * @return The number of characters read, 0 if text does not start with a number.
+ */
+unsigned char FixedFromString(const char *text, Q16_16 *value);
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,315 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Format.c
+ * @brief Implementation of the compact, division-free printf.
+ * A field is measured before it is written, by comparing the value against
+ * the powers of ten or shifting out nibbles, so padding and sign go out
+ * first and the digits follow straight from the value, without a buffer.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "Format.h"
+
+// Conversion flags
+#define FORMAT_LEFT     0x01   // '-'
+#define FORMAT_ZERO     0x02   // '0'
+#define FORMAT_LONG     0x04   // 'l'
+#define FORMAT_SHORT    0x08   // 'h'
+
+#define FORMAT_POWERS   10
+#define FORMAT_NO_PRECISION 0xFF
+
+/** @brief Powers of ten, largest first, for the decimal digit loop. */
+static const unsigned long FormatPowers[FORMAT_POWERS] =
+{
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+    10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+/** @brief The output and the conversion being written. */
+typedef struct
+{
+    FormatOutput output;
+    unsigned int count;       /**< Characters written so far */
+    unsigned char flags;
+    unsigned char width;
+    unsigned char trail;      /**< Spaces still owed after a left-aligned field */
+} FormatState;
+
+/** @brief Writes one character; a macro, to keep a return address off the hardware stack. */
+#define FormatPut(state, c)  ((state)->output(c), (state)->count++)
+
+/** @brief Writes the padding and sign in front of a field.
+ * @param length Characters of the field after the sign.
+ * @param sign '-', or 0 for none.
+ */
+static void FormatOpen(FormatState *state, unsigned char length, char sign)
+{
+    unsigned char pad;
+
+    if (sign)
+        length++;
+    pad = state->width > length ? (unsigned char)(state->width - length) : 0;
+    if (state->flags & FORMAT_LEFT)
+    {
+        state->trail = pad;
+        pad = 0;
+    }
+    else if (!(state->flags & FORMAT_ZERO))
+    {
+        for (; pad; pad--)
+            FormatPut(state, ' ');
+    }
+    if (sign)
+        FormatPut(state, sign);
+    for (; pad; pad--)
+        FormatPut(state, '0');
+}
+
+/** @brief Writes the padding after a left-aligned field. */
+static void FormatClose(FormatState *state)
+{
+    for (; state->trail; state->trail--)
+        FormatPut(state, ' ');
+}
+
+/** @brief Number of decimal digits of value, at least 1. */
+static unsigned char FormatDecimalLength(unsigned long value)
+{
+    unsigned char length = FORMAT_POWERS;
+
+    while (length > 1 && value < FormatPowers[FORMAT_POWERS - length])
+        length--;
+    return length;
+}
+
+/** @brief Writes value as length decimal digits, leading zeros included.
+ * Each digit is the number of times its power of ten can be subtracted.
+ * value must not have more than length digits.
+ */
+static void FormatDecimal(FormatState *state, unsigned long value, unsigned char length)
+{
+    const unsigned long *power = &FormatPowers[FORMAT_POWERS - length];
+    char digit;
+
+    for (; length; length--, power++)
+    {
+        digit = '0';
+        while (value >= *power)
+        {
+            value -= *power;
+            digit++;
+        }
+        FormatPut(state, digit);
+    }
+}
+
+/** @brief Number of hex digits of value, at least 1. */
+static unsigned char FormatHexLength(unsigned long value)
+{
+    unsigned char length = 1;
+
+    while (length < 8 && (value >> (length << 2)))
+        length++;
+    return length;
+}
+
+/** @brief Writes the last length hex digits of value. */
+static void FormatHex(FormatState *state, unsigned long value, unsigned char length, char upper)
+{
+    unsigned char nibble;
+
+    while (length--)
+    {
+        nibble = (unsigned char)(value >> (length << 2)) & 0x0F;
+        if (nibble < 10)
+            FormatPut(state, (char)('0' + nibble));
+        else
+            FormatPut(state, (char)((upper ? 'A' : 'a') + nibble - 10));
+    }
+}
+
+#if FORMAT_FIXED
+/** @brief Writes a Q16.16 value rounded to decimals, like FixedToString(). */
+static void FormatFixed(FormatState *state, Q16_16 value, unsigned char decimals)
+{
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    unsigned long scale, whole, fraction;
+    unsigned char length;
+
+    if (decimals > FIXED_DECIMALS)
+        decimals = FIXED_DECIMALS;
+    scale = FormatPowers[FORMAT_POWERS - 1 - decimals];
+
+    whole = magnitude >> 16;
+    fraction = ((magnitude & 0xFFFF) * scale + 0x8000) >> 16;
+    if (fraction >= scale)
+    {
+        fraction -= scale;
+        whole++;
+    }
+
+    length = FormatDecimalLength(whole);
+    FormatOpen(state, (unsigned char)(length + (decimals ? decimals + 1 : 0)),
+               (value < 0 && (whole || fraction)) ? '-' : 0);
+    FormatDecimal(state, whole, length);
+    if (decimals)
+    {
+        FormatPut(state, '.');
+        FormatDecimal(state, fraction, decimals);
+    }
+}
+#endif
+
+/** @brief Format() with the arguments in a va_list, for wrappers such as UART_Printf(). */
+unsigned int FormatV(FormatOutput output, const char *format, va_list args)
+{
+    FormatState state;
+    const char *start;
+    const char *text;
+    unsigned long value;
+    long number;
+    unsigned char precision;
+    unsigned char length;
+    char sign;
+    char c;
+
+    state.output = output;
+    state.count = 0;
+
+    while ((c = *format++) != 0)
+    {
+        if (c != '%')
+        {
+            FormatPut(&state, c);
+            continue;
+        }
+
+        start = format - 1;
+        state.flags = 0;
+        state.width = 0;
+        state.trail = 0;
+        precision = FORMAT_NO_PRECISION;
+        for (;; format++)
+        {
+            if (*format == '-')
+                state.flags |= FORMAT_LEFT;
+            else if (*format == '0')
+                state.flags |= FORMAT_ZERO;
+            else
+                break;
+        }
+        while (*format >= '0' && *format <= '9')
+            state.width = (unsigned char)(state.width * 10 + (*format++ - '0'));
+        if (*format == '.')
+        {
+            precision = 0;
+            while (*++format >= '0' && *format <= '9')
+                precision = (unsigned char)(precision * 10 + (*format - '0'));
+        }
+        if (*format == 'l')
+        {
+            state.flags |= FORMAT_LONG;
+            format++;
+        }
+        else if (*format == 'h')
+        {
+            state.flags |= FORMAT_SHORT;
+            format++;
+        }
+
+        sign = 0;
+        switch (c = *format++)
+        {
+        case 'd':
+        case 'u':
+            if (c == 'u')
+                value = (state.flags & FORMAT_LONG) ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+            else
+            {
+                number = (state.flags & FORMAT_LONG) ? va_arg(args, long) : va_arg(args, int);
+                if (number < 0)
+                {
+                    sign = '-';
+                    value = 0UL - (unsigned long)number;
+                }
+                else
+                    value = (unsigned long)number;
+            }
+            length = FormatDecimalLength(value);
+            FormatOpen(&state, length, sign);
+            FormatDecimal(&state, value, length);
+            break;
+
+        case 'x':
+        case 'X':
+            value = (state.flags & FORMAT_LONG) ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+            length = FormatHexLength(value);
+            FormatOpen(&state, length, 0);
+            FormatHex(&state, value, length, c == 'X');
+            break;
+
+#if FORMAT_FIXED
+        case 'q':
+            if (state.flags & FORMAT_SHORT)
+                number = FIXED_FROM8(va_arg(args, int));
+            else
+                number = va_arg(args, long);
+            FormatFixed(&state, number, precision == FORMAT_NO_PRECISION ? FORMAT_Q_DECIMALS : precision);
+            break;
+#endif
+
+        case 'c':
+            state.flags &= (unsigned char)~FORMAT_ZERO;
+            FormatOpen(&state, 1, 0);
+            FormatPut(&state, (char)va_arg(args, int));
+            break;
+
+        case 's':
+            text = va_arg(args, const char *);
+            for (length = 0; text[length] && length < 0xFF; length++)
+                ;
+            state.flags &= (unsigned char)~FORMAT_ZERO;
+            FormatOpen(&state, length, 0);
+            while (*text)
+                FormatPut(&state, *text++);
+            break;
+
+        case '%':
+            FormatPut(&state, '%');
+            break;
+
+        default:
+            // Not a conversion: written out as it stands
+            if (!c)
+                format--;
+            while (start < format)
+                FormatPut(&state, *start++);
+            break;
+        }
+        FormatClose(&state);
+    }
+    return state.count;
+}
+
+/** @brief Formats the arguments and writes them to output.
+ * @param output Called for every character, in order.
+ * @param format The format string.
+ * @return The number of characters written.
+ */
+unsigned int Format(FormatOutput output, const char *format, ...)
+{
+    va_list args;
+    unsigned int count;
+
+    va_start(args, format);
+    count = FormatV(output, format, args);
+    va_end(args);
+    return count;
+}
@@ -0,0 +1,65 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Format.h
+ * @brief Header file for the compact, division-free printf for Holtek MCUs.
+ * Format() hands each character to an output function as it is produced,
+ * such as UART_Transmit() or the LCD framebuffer writer behind LCD_Printf(),
+ * so nothing is staged in RAM. Decimal digits come from subtracting powers of
+ * ten and hex digits from shifts, so no conversion calls the software divide.
+ *
+ *   %[-][0][width][.decimals][l|h]conversion
+ *
+ *   u d     unsigned and signed int, long with l
+ *   x X     hex in lower or upper case, long with l
+ *   q       Q16.16 with 0 to FIXED_DECIMALS decimals, FORMAT_Q_DECIMALS
+ *           when none are given; Q8.8 with h
+ *   c s %   character, string and a percent sign
+ *
+ * '-' aligns left within the width and '0' fills numbers with zeros after
+ * the sign. A conversion that is not listed is written out as it stands.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stdarg.h>
+
+#define Enable  1
+#define Disable 0
+
+/** @brief Fixed-point conversion
+ * FORMAT_FIXED adds %q for the types of FixedPoint.h.
+ */
+//=========================================================================
+#define FORMAT_FIXED        Enable
+#define FORMAT_Q_DECIMALS   2
+//=========================================================================
+
+#if FORMAT_FIXED
+#include "FixedPoint.h"
+#if FORMAT_Q_DECIMALS > FIXED_DECIMALS
+    #error "FORMAT_Q_DECIMALS can be at most FIXED_DECIMALS"
+#endif
+#endif
+
+/** @brief Receives the formatted characters one at a time. */
+typedef void (*FormatOutput)(char c);
+
+/** @brief Formats the arguments and writes them to output.
+ * @param output Called for every character, in order.
+ * @param format The format string.
+ * @return The number of characters written.
+ */
+unsigned int Format(FormatOutput output, const char *format, ...);
+
+/** @brief Format() with the arguments in a va_list, for wrappers such as UART_Printf(). */
+unsigned int FormatV(FormatOutput output, const char *format, va_list args);
+
+#endif // FORMAT_H
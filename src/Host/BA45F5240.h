@@ -0,0 +1,242 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file BA45F5240.h
+ * @brief Host stand-in for the BA45F5240 device header, for building the library on Linux.
+ * Every SFR the library uses is a byte of the simulated register file in
+ * Host.c, and every bit SFR a bit field of its byte, so byte and bit views
+ * stay in step. Each use goes through HostAccess(), which lets the peripheral
+ * model run and take interrupts before the access, the way an interrupt lands
+ * between two instructions. INTC0~INTC3 are the exception: Interrupt.c keeps
+ * their addresses in a ROM table, which needs constant addresses, so they are
+ * used directly and only their changes are seen. No driver changes for this.
+ * Bit positions follow the library's own use where it relies on them
+ * (INTCn, UUSR, the EEPROM control register); the rest only need to be distinct.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef BA45F5240_H
+#define BA45F5240_H
+
+// The Holtek compiler's interrupt and ROM attributes mean nothing here
+#define __attribute__(x)
+
+/** @brief Registers of the simulated file, as X(INDEX, name). */
+#define HOST_REGISTERS(X) \
+    X(HOST_INTC0,  intc0)  X(HOST_INTC1,  intc1)  X(HOST_INTC2,  intc2)  X(HOST_INTC3,  intc3)  \
+    X(HOST_MP1L,   mp1l)   X(HOST_MP1H,   mp1h)   X(HOST_IAR1,   iar1)                          \
+    X(HOST_EEA,    eea)    X(HOST_EED,    eed)                                                  \
+    X(HOST_PA,     pa)     X(HOST_PAC,    pac)    X(HOST_PAPU,   papu)                          \
+    X(HOST_PB,     pb)     X(HOST_PBC,    pbc)    X(HOST_PBPU,   pbpu)                          \
+    X(HOST_PAS0,   pas0)   X(HOST_PAS1,   pas1)   X(HOST_PBS0,   pbs0)  X(HOST_IFS0,   ifs0)    \
+    X(HOST_SCC,    scc)    X(HOST_HIRCC,  hircc)                                                \
+    X(HOST_PSCR,   pscr)   X(HOST_TB0C,   tb0c)   X(HOST_TB1C,   tb1c)                          \
+    X(HOST_STMC0,  stmc0)  X(HOST_STMC1,  stmc1)  X(HOST_STMDL,  stmdl) X(HOST_STMDH,  stmdh)   \
+    X(HOST_STMAL,  stmal)  X(HOST_STMAH,  stmah)                                                \
+    X(HOST_PTMC0,  ptmc0)  X(HOST_PTMC1,  ptmc1)  X(HOST_PTMC2,  ptmc2)                         \
+    X(HOST_PTMDL,  ptmdl)  X(HOST_PTMDH,  ptmdh)  X(HOST_PTMAL,  ptmal) X(HOST_PTMAH,  ptmah)   \
+    X(HOST_PTMBL,  ptmbl)  X(HOST_PTMBH,  ptmbh)  X(HOST_PTMRPL, ptmrpl) X(HOST_PTMRPH, ptmrph) \
+    X(HOST_SADC0,  sadc0)  X(HOST_SADC1,  sadc1)  X(HOST_SADOL,  sadol) X(HOST_SADOH,  sadoh)   \
+    X(HOST_UUCR1,  uucr1)  X(HOST_UUCR2,  uucr2)  X(HOST_UUCR3,  uucr3) X(HOST_UUSR,   uusr)    \
+    X(HOST_UBRG,   ubrg)   X(HOST_UTXR_RXR, utxr_rxr)
+
+#define HOST_REGISTER_INDEX(index, name)  index,
+enum { HOST_REGISTERS(HOST_REGISTER_INDEX) HOST_SFR_COUNT };
+#undef HOST_REGISTER_INDEX
+
+/** @brief One register, seen as a byte or as bits. */
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char b0 : 1, b1 : 1, b2 : 1, b3 : 1, b4 : 1, b5 : 1, b6 : 1, b7 : 1;
+    } bits;
+} HostRegister;
+
+/** @brief Simulated register file, indexed by HOST_xxx. Defined in Host.c. */
+extern volatile HostRegister HostSfr[HOST_SFR_COUNT];
+
+/** @brief Accounts for one access and runs the model up to it. Defined in Host.c. */
+volatile HostRegister *HostAccess(unsigned char reg);
+
+/** @brief 0 makes every access direct: no counts, hooks or model, but the
+ * code has one memory access per SFR access, as on the device. */
+#ifndef HOST_ACCESS_MODEL
+#define HOST_ACCESS_MODEL      1
+#endif
+
+#define HOST_DIRECT(reg)       (HostSfr[reg].byte)
+#define HOST_DIRECT_BIT(reg, bit)  (HostSfr[reg].bits.b##bit)
+#if HOST_ACCESS_MODEL
+#define HOST_SFR(reg)          (HostAccess(reg)->byte)
+#define HOST_BIT(reg, bit)     (HostAccess(reg)->bits.b##bit)
+#else
+#define HOST_SFR(reg)          HOST_DIRECT(reg)
+#define HOST_BIT(reg, bit)     HOST_DIRECT_BIT(reg, bit)
+#endif
+
+/** @brief Instructions the compiler provides as built-ins */
+void _halt(void);
+void _nop(void);
+void _clrwdt(void);
+
+// Interrupt control: enable bits 0~3 (EMI is bit 0 of INTC0), request flags 4~7
+#define _intc0      HOST_DIRECT(HOST_INTC0)
+#define _intc1      HOST_DIRECT(HOST_INTC1)
+#define _intc2      HOST_DIRECT(HOST_INTC2)
+#define _intc3      HOST_DIRECT(HOST_INTC3)
+#define _emi        HOST_DIRECT_BIT(HOST_INTC0, 0)
+#define _tb0f       HOST_DIRECT_BIT(HOST_INTC3, 4)
+#define _tb1f       HOST_DIRECT_BIT(HOST_INTC3, 5)
+
+// Indirect addressing; MP1 = 0x140 puts the EEPROM control register EEC on IAR1
+#define _mp1l       HOST_SFR(HOST_MP1L)
+#define _mp1h       HOST_SFR(HOST_MP1H)
+#define _iar1       HOST_SFR(HOST_IAR1)
+#define _eea        HOST_SFR(HOST_EEA)
+#define _eed        HOST_SFR(HOST_EED)
+
+// Ports
+#define _pa         HOST_SFR(HOST_PA)
+#define _pa0        HOST_BIT(HOST_PA, 0)
+#define _pa1        HOST_BIT(HOST_PA, 1)
+#define _pa3        HOST_BIT(HOST_PA, 3)
+#define _pa4        HOST_BIT(HOST_PA, 4)
+#define _pa5        HOST_BIT(HOST_PA, 5)
+#define _pac        HOST_SFR(HOST_PAC)
+#define _pac0       HOST_BIT(HOST_PAC, 0)
+#define _pac1       HOST_BIT(HOST_PAC, 1)
+#define _pac3       HOST_BIT(HOST_PAC, 3)
+#define _pac4       HOST_BIT(HOST_PAC, 4)
+#define _pac5       HOST_BIT(HOST_PAC, 5)
+#define _pac6       HOST_BIT(HOST_PAC, 6)
+#define _papu1      HOST_BIT(HOST_PAPU, 1)
+#define _papu6      HOST_BIT(HOST_PAPU, 6)
+#define _pb         HOST_SFR(HOST_PB)
+#define _pbc        HOST_SFR(HOST_PBC)
+#define _pbc3       HOST_BIT(HOST_PBC, 3)
+#define _pbpu       HOST_SFR(HOST_PBPU)
+#define _pas06      HOST_BIT(HOST_PAS0, 6)
+#define _pas07      HOST_BIT(HOST_PAS0, 7)
+#define _pas13      HOST_BIT(HOST_PAS1, 3)
+#define _pas14      HOST_BIT(HOST_PAS1, 4)
+#define _pas15      HOST_BIT(HOST_PAS1, 5)
+#define _pbs02      HOST_BIT(HOST_PBS0, 2)
+#define _pbs03      HOST_BIT(HOST_PBS0, 3)
+#define _pbs06      HOST_BIT(HOST_PBS0, 6)
+#define _pbs07      HOST_BIT(HOST_PBS0, 7)
+#define _ifs06      HOST_BIT(HOST_IFS0, 6)
+#define _ifs07      HOST_BIT(HOST_IFS0, 7)
+
+// Clocks and time bases: SCC bits 7~5 = CKS2~CKS0, HIRCC bits 3~2 = HIRC1~HIRC0,
+// TBnC bit 7 = TBnON, bits 2~0 = time-out period
+#define _scc        HOST_SFR(HOST_SCC)
+#define _fsiden     HOST_BIT(HOST_SCC, 0)
+#define _fhiden     HOST_BIT(HOST_SCC, 1)
+#define _fss        HOST_BIT(HOST_SCC, 2)
+#define _fhs        HOST_BIT(HOST_SCC, 3)
+#define _cks0       HOST_BIT(HOST_SCC, 5)
+#define _cks1       HOST_BIT(HOST_SCC, 6)
+#define _cks2       HOST_BIT(HOST_SCC, 7)
+#define _hircc      HOST_SFR(HOST_HIRCC)
+#define _hircen     HOST_BIT(HOST_HIRCC, 0)
+#define _hircf      HOST_BIT(HOST_HIRCC, 1)
+#define _hirc0      HOST_BIT(HOST_HIRCC, 2)
+#define _hirc1      HOST_BIT(HOST_HIRCC, 3)
+#define _pscr       HOST_SFR(HOST_PSCR)
+#define _tb0c       HOST_SFR(HOST_TB0C)
+#define _tb1c       HOST_SFR(HOST_TB1C)
+#define _tb0on      HOST_BIT(HOST_TB0C, 7)
+#define _tb1on      HOST_BIT(HOST_TB1C, 7)
+
+// STM
+#define _stpau      HOST_BIT(HOST_STMC0, 7)
+#define _stck2      HOST_BIT(HOST_STMC0, 6)
+#define _stck1      HOST_BIT(HOST_STMC0, 5)
+#define _stck0      HOST_BIT(HOST_STMC0, 4)
+#define _ston       HOST_BIT(HOST_STMC0, 3)
+#define _strp2      HOST_BIT(HOST_STMC0, 2)
+#define _strp1      HOST_BIT(HOST_STMC0, 1)
+#define _strp0      HOST_BIT(HOST_STMC0, 0)
+#define _stm1       HOST_BIT(HOST_STMC1, 7)
+#define _stm0       HOST_BIT(HOST_STMC1, 6)
+#define _stio1      HOST_BIT(HOST_STMC1, 5)
+#define _stio0      HOST_BIT(HOST_STMC1, 4)
+#define _stoc       HOST_BIT(HOST_STMC1, 3)
+#define _stpol      HOST_BIT(HOST_STMC1, 2)
+#define _stdpx      HOST_BIT(HOST_STMC1, 1)
+#define _stcclr     HOST_BIT(HOST_STMC1, 0)
+#define _stmdl      HOST_SFR(HOST_STMDL)
+#define _stmdh      HOST_SFR(HOST_STMDH)
+#define _stmal      HOST_SFR(HOST_STMAL)
+#define _stmah      HOST_SFR(HOST_STMAH)
+
+// PTM
+#define _ptpau      HOST_BIT(HOST_PTMC0, 7)
+#define _ptck2      HOST_BIT(HOST_PTMC0, 6)
+#define _ptck1      HOST_BIT(HOST_PTMC0, 5)
+#define _ptck0      HOST_BIT(HOST_PTMC0, 4)
+#define _pton       HOST_BIT(HOST_PTMC0, 3)
+#define _ptm1       HOST_BIT(HOST_PTMC1, 7)
+#define _ptm0       HOST_BIT(HOST_PTMC1, 6)
+#define _ptio1      HOST_BIT(HOST_PTMC1, 5)
+#define _ptio0      HOST_BIT(HOST_PTMC1, 4)
+#define _ptoc       HOST_BIT(HOST_PTMC1, 3)
+#define _ptpol      HOST_BIT(HOST_PTMC1, 2)
+#define _ptcapts    HOST_BIT(HOST_PTMC1, 1)
+#define _ptcclr     HOST_BIT(HOST_PTMC1, 0)
+#define _ptvlf      HOST_BIT(HOST_PTMC2, 2)
+#define _pttclr1    HOST_BIT(HOST_PTMC2, 1)
+#define _pttclr0    HOST_BIT(HOST_PTMC2, 0)
+#define _ptmdl      HOST_SFR(HOST_PTMDL)
+#define _ptmdh      HOST_SFR(HOST_PTMDH)
+#define _ptmal      HOST_SFR(HOST_PTMAL)
+#define _ptmah      HOST_SFR(HOST_PTMAH)
+#define _ptmbl      HOST_SFR(HOST_PTMBL)
+#define _ptmbh      HOST_SFR(HOST_PTMBH)
+#define _ptmrpl     HOST_SFR(HOST_PTMRPL)
+#define _ptmrph     HOST_SFR(HOST_PTMRPH)
+
+// ADC: SADC0 bits 3~0 = channel, SADC1 bits 2~0 = clock
+#define _sadc0      HOST_SFR(HOST_SADC0)
+#define _start      HOST_BIT(HOST_SADC0, 7)
+#define _adbz       HOST_BIT(HOST_SADC0, 6)
+#define _adcen      HOST_BIT(HOST_SADC0, 5)
+#define _adrfs      HOST_BIT(HOST_SADC0, 4)
+#define _sacks2     HOST_BIT(HOST_SADC1, 2)
+#define _sacks1     HOST_BIT(HOST_SADC1, 1)
+#define _sacks0     HOST_BIT(HOST_SADC1, 0)
+#define _sadol      HOST_SFR(HOST_SADOL)
+#define _sadoh      HOST_SFR(HOST_SADOH)
+
+// UART: UUSR bit 1 = UTXIF, bit 0 = URXIF
+#define _uucr1      HOST_SFR(HOST_UUCR1)
+#define _uren       HOST_BIT(HOST_UUCR1, 7)
+#define _ubno       HOST_BIT(HOST_UUCR1, 6)
+#define _upen       HOST_BIT(HOST_UUCR1, 5)
+#define _uprt       HOST_BIT(HOST_UUCR1, 4)
+#define _ustops     HOST_BIT(HOST_UUCR1, 3)
+#define _uucr2      HOST_SFR(HOST_UUCR2)
+#define _utxen      HOST_BIT(HOST_UUCR2, 7)
+#define _urxen      HOST_BIT(HOST_UUCR2, 6)
+#define _ubrgh      HOST_BIT(HOST_UUCR2, 5)
+#define _urie       HOST_BIT(HOST_UUCR2, 2)
+#define _utiie      HOST_BIT(HOST_UUCR2, 1)
+#define _uteie      HOST_BIT(HOST_UUCR2, 0)
+#define _umd        HOST_BIT(HOST_UUCR3, 0)
+#define _uusr       HOST_SFR(HOST_UUSR)
+#define _uperr      HOST_BIT(HOST_UUSR, 6)
+#define _uferr      HOST_BIT(HOST_UUSR, 5)
+#define _uoerr      HOST_BIT(HOST_UUSR, 4)
+#define _utxif      HOST_BIT(HOST_UUSR, 1)
+#define _urxif      HOST_BIT(HOST_UUSR, 0)
+#define _ubrg       HOST_SFR(HOST_UBRG)
+#define _utxr_rxr   HOST_SFR(HOST_UTXR_RXR)
+
+#endif // BA45F5240_H
@@ -0,0 +1,505 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Bench.c
+ * @brief Benchmark cases for the public APIs, run on the host model.
+ * Each case sets up what it needs, then calls one API over representative
+ * inputs. Only the calls are measured: the setup is left out of the register
+ * counts and, through __gcov_reset(), out of the line counts that
+ * tools/bench_report.py turns into float operations, loop iterations and
+ * estimated cycles. Run with no argument to list the cases, or with a case
+ * name to run it and print one line:
+ *   name calls sfr_reads sfr_writes clocks
+ * "make bench" runs them all and writes build/bench/bench.json.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Host.h"
+#include "ADC.h"
+#include "Control.h"
+#include "EEPROM.h"
+#include "EventQueue.h"
+#include "Filter.h"
+#include "FixedPoint.h"
+#include "History.h"
+#include "Interrupt.h"
+#include "NTC.h"
+#include "PTM.h"
+#include "RCC.h"
+#include "STM.h"
+#include "BTM.h"
+#include "SevenSeg.h"
+#include "Telemetry.h"
+#include "UART.h"
+
+/** @brief Clears the line counts of the library objects, from libgcov. */
+extern void __gcov_reset(void);
+
+/** @brief One benchmark case. */
+typedef struct
+{
+    const char *name;
+    void (*setup)(void);          /**< Not measured, 0 for none */
+    unsigned int (*run)(void);    /**< Returns the number of API calls made */
+} BenchCase;
+
+static volatile float Sink;       // Keeps results of pure functions alive
+static FilterAverage Average;
+static FilterMedian Median;
+static FilterIir Iir;
+static ControlRelay Relay;
+#if CONTROL_PID
+static ControlPid Pid;
+#endif
+
+/** @brief Samples for the filters and the controller: a slow ramp with noise. */
+static unsigned int BenchSample(unsigned int i)
+{
+    return 2000 + i * 8 + ((i * 37) & 0x3F);
+}
+
+//=========================================================================
+// NTC
+
+static unsigned int BenchTemperature(void)
+{
+    unsigned int calls = 0;
+    int adc;
+
+    for (adc = 200; adc <= 3800; adc += 200, calls++)
+        Sink = temperature(adc, 5.0);
+    return calls;
+}
+
+#ifndef _USE_MATH_H
+static unsigned int BenchCustomLog(void)
+{
+    static const double inputs[] = { 1.5, 2.0, 5.0, 10.0, 50.0, 100.0, 1000.0, 10000.0 };
+    unsigned int i;
+
+    for (i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++)
+        Sink = custom_log(inputs[i]);
+    return i;
+}
+#endif
+
+#ifdef NTC_FIXED_POINT
+static unsigned int BenchTemperatureFixed(void)
+{
+    unsigned int calls = 0;
+    int adc;
+
+    for (adc = 200; adc <= 3800; adc += 200, calls++)
+        Sink = (float)temperatureFixed(adc);
+    return calls;
+}
+#endif
+
+//=========================================================================
+// Fixed point
+
+static unsigned int BenchFixedLn(void)
+{
+    static const Q16_16 inputs[] = { FIXED_CONST(1.5), FIXED_CONST(2.0), FIXED_CONST(5.0), FIXED_CONST(10.0),
+                                     FIXED_CONST(50.0), FIXED_CONST(100.0), FIXED_CONST(1000.0), FIXED_CONST(10000.0) };
+    unsigned int i;
+
+    for (i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++)
+        Sink = (float)FixedLn(inputs[i]);
+    return i;
+}
+
+static unsigned int BenchFixedMulDiv(void)
+{
+    Q16_16 value = FIXED_CONST(1.5);
+    unsigned int i;
+
+    for (i = 0; i < 32; i++)
+        value = FixedDiv(FixedMul(value, FIXED_CONST(3.25)), FIXED_CONST(3.0));
+    Sink = (float)value;
+    return 2 * i;
+}
+
+static unsigned int BenchFixedSqrt(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < 32; i++)
+        Sink = (float)FixedSqrt(FIXED_FROM_INT(i * 997 + 1));
+    return i;
+}
+
+static unsigned int BenchFixedReciprocal(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < 32; i++)
+        Sink = (float)FixedReciprocal(FIXED_FROM_INT(i * 997 + 1));
+    return i;
+}
+
+static unsigned int BenchFixedToString(void)
+{
+    char text[8 + FIXED_DECIMALS];
+    unsigned int i;
+
+    for (i = 0; i < 16; i++)
+        FixedToString(FIXED_CONST(-273.15) + (Q16_16)i * 1234567L, 2, text);
+    return i;
+}
+
+//=========================================================================
+// UART
+
+static unsigned int BenchUartInit(void)
+{
+    UART_Init(9600);
+    UART_Init(19200);
+    UART_Init(115200);
+    return 3;
+}
+
+static void BenchUartSetup(void)
+{
+    UART_Init(9600);
+}
+
+static unsigned int BenchUartTransmitString(void)
+{
+    UART_TransmitString("Temperature 23.5 C\r\n");
+    return 1;
+}
+
+static unsigned int BenchUartTransmitNumber(void)
+{
+    static const unsigned long values[] = { 0, 7, 1234, 65535, 4294967295UL };
+    unsigned int i;
+
+    for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+        UART_TransmitNumber(values[i]);
+    return i;
+}
+
+static unsigned int BenchUartPrintf(void)
+{
+    UART_Printf("%u %5d %04x %lu\r\n", 42u, -1234, 0xBEEFu, 4294967295UL);
+    UART_Printf("T=%.2q C RH=%-3u%%\r\n", FIXED_CONST(-12.75), 65u);
+    return 2;
+}
+
+//=========================================================================
+// EEPROM
+
+static unsigned int BenchEepromWrite(void)
+{
+    char address;
+
+    for (address = 0; address < 16; address++)
+        writeToEEPROM(address, (char)(address * 3));
+    return 16;
+}
+
+static void BenchEepromReadSetup(void)
+{
+    BenchEepromWrite();
+}
+
+static unsigned int BenchEepromRead(void)
+{
+    char address;
+    char data;
+
+    for (address = 0; address < 16; address++)
+        readFromEEPROM(address, &data);
+    return 16;
+}
+
+static void BenchHistorySetup(void)
+{
+    HistoryInit();
+}
+
+static unsigned int BenchHistoryAppend(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < 24; i++)
+        HistoryAppend(600 + i, (unsigned char)(20 + i / 6), (unsigned char)(45 - i / 4), (unsigned char)(i & 1));
+    return i;
+}
+
+static void BenchHistoryDumpSetup(void)
+{
+    UART_Init(9600);
+    HistoryInit();
+    BenchHistoryAppend();
+}
+
+static unsigned int BenchHistoryDump(void)
+{
+    unsigned int calls = 1;
+
+    HistoryDumpStart();
+    while (HistoryDumpNext())
+        calls++;
+    return calls;
+}
+
+//=========================================================================
+// Timers and interrupts
+
+static unsigned int BenchPTimerInit(void)
+{
+    PTimerInit();
+    return 1;
+}
+
+static unsigned int BenchSTimerInit(void)
+{
+    STimerInit();
+    return 1;
+}
+
+static unsigned int BenchTimerBaseInit(void)
+{
+    TimerBaseInit();
+    return 1;
+}
+
+static unsigned int BenchRccSwitch(void)
+{
+    RccSwitch(RCC_LOW_SPEED);
+    RccSwitch(RCC_SUB_SPEED);
+    RccSwitch(RCC_HIGH_SPEED);
+    return 3;
+}
+
+static unsigned int BenchInterruptInit(void)
+{
+    IntrruptInit();
+    return 1;
+}
+
+static unsigned int BenchEvents(void)
+{
+    Event event;
+    unsigned char i;
+
+    for (i = 0; i < EVENT_QUEUE_SIZE; i++)
+        EventPost(i, i);
+    for (i = 0; i < EVENT_QUEUE_SIZE; i++)
+        EventGet(&event);
+    return 2 * EVENT_QUEUE_SIZE;
+}
+
+//=========================================================================
+// Filters, control and telemetry
+
+static void BenchFilterSetup(void)
+{
+    FilterAverageInit(&Average);
+    FilterMedianInit(&Median);
+    FilterIirInit(&Iir, 4);
+}
+
+static unsigned int BenchFilterAverage(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < 64; i++)
+        FilterAverageUpdate(&Average, BenchSample(i));
+    return i;
+}
+
+static unsigned int BenchFilterMedian(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < 64; i++)
+        FilterMedianUpdate(&Median, BenchSample(i));
+    return i;
+}
+
+static unsigned int BenchFilterIir(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < 64; i++)
+        FilterIirUpdate(&Iir, BenchSample(i));
+    return i;
+}
+
+static void BenchRelaySetup(void)
+{
+    ControlInit();
+    ControlRelayInit(&Relay, CONTROL_ACTIVE_BELOW, 0, 0);
+    ControlRelaySetpoint(&Relay, 2300, 40);
+}
+
+static unsigned int BenchRelay(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < 64; i++)
+        ControlRelayUpdate(&Relay, (int)BenchSample(i));
+    return i;
+}
+
+#if CONTROL_PID
+static void BenchPidSetup(void)
+{
+    ControlPidInit(&Pid, FIXED8_CONST(0.25), FIXED8_CONST(0.0156), FIXED8_CONST(0.0625), 1000);
+    ControlPidSetpoint(&Pid, 2300);
+}
+
+static unsigned int BenchPid(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < 64; i++)
+        ControlPidUpdate(&Pid, (int)BenchSample(i));
+    return i;
+}
+#endif
+
+static void BenchTelemetrySetup(void)
+{
+    TelemetryInit();
+}
+
+static unsigned int BenchTelemetry(void)
+{
+    int values[TELEMETRY_CHANNELS];
+    unsigned char length;
+    unsigned int i;
+    unsigned char c;
+
+    for (i = 0; i < 64; i++)
+    {
+        for (c = 0; c < TELEMETRY_CHANNELS; c++)
+            values[c] = (int)BenchSample(i + c);
+        TelemetrySample(values);
+        TelemetryTake(&length);
+    }
+    return 2 * i;
+}
+
+#if SEVEN_SEG
+static void BenchSevenSegSetup(void)
+{
+    SevenSegInit();
+}
+
+static unsigned int BenchSevenSeg(void)
+{
+    static const unsigned int values[] = { 0, 7, 42, 1234, 9999 };
+    unsigned int i;
+
+    for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+        SevenSegWriteNumber(values[i]);
+    return i;
+}
+#endif
+
+//=========================================================================
+
+static const BenchCase Cases[] =
+{
+    { "temperature",          0,                     BenchTemperature },
+#ifndef _USE_MATH_H
+    { "custom_log",           0,                     BenchCustomLog },
+#endif
+#ifdef NTC_FIXED_POINT
+    { "temperatureFixed",     0,                     BenchTemperatureFixed },
+#endif
+    { "FixedLn",              0,                     BenchFixedLn },
+    { "FixedMul/FixedDiv",    0,                     BenchFixedMulDiv },
+    { "FixedSqrt",            0,                     BenchFixedSqrt },
+    { "FixedReciprocal",      0,                     BenchFixedReciprocal },
+    { "FixedToString",        0,                     BenchFixedToString },
+    { "UART_Init",            0,                     BenchUartInit },
+    { "UART_TransmitString",  BenchUartSetup,        BenchUartTransmitString },
+    { "UART_TransmitNumber",  BenchUartSetup,        BenchUartTransmitNumber },
+    { "UART_Printf",          BenchUartSetup,        BenchUartPrintf },
+    { "writeToEEPROM",        0,                     BenchEepromWrite },
+    { "readFromEEPROM",       BenchEepromReadSetup,  BenchEepromRead },
+    { "HistoryAppend",        BenchHistorySetup,     BenchHistoryAppend },
+    { "HistoryDumpNext",      BenchHistoryDumpSetup, BenchHistoryDump },
+    { "PTimerInit",           0,                     BenchPTimerInit },
+    { "STimerInit",           0,                     BenchSTimerInit },
+    { "TimerBaseInit",        0,                     BenchTimerBaseInit },
+    { "RccSwitch",            RccInit,               BenchRccSwitch },
+    { "IntrruptInit",         0,                     BenchInterruptInit },
+    { "EventPost/EventGet",   0,                     BenchEvents },
+    { "FilterAverageUpdate",  BenchFilterSetup,      BenchFilterAverage },
+    { "FilterMedianUpdate",   BenchFilterSetup,      BenchFilterMedian },
+    { "FilterIirUpdate",      BenchFilterSetup,      BenchFilterIir },
+    { "ControlRelayUpdate",   BenchRelaySetup,       BenchRelay },
+#if CONTROL_PID
+    { "ControlPidUpdate",     BenchPidSetup,         BenchPid },
+#endif
+    { "TelemetrySample/Take", BenchTelemetrySetup,   BenchTelemetry },
+#if SEVEN_SEG
+    { "SevenSegWriteNumber",  BenchSevenSegSetup,    BenchSevenSeg },
+#endif
+};
+
+#define BENCH_CASES (sizeof(Cases) / sizeof(Cases[0]))
+
+/** @brief Sum of the accesses to all registers. */
+static unsigned long BenchTotal(const unsigned long *counts)
+{
+    unsigned long total = 0;
+    unsigned char i;
+
+    for (i = 0; i < HOST_SFR_COUNT; i++)
+        total += counts[i];
+    return total;
+}
+
+int main(int argc, char **argv)
+{
+    const BenchCase *bench = 0;
+    unsigned long reads, writes, clocks;
+    unsigned int calls;
+    unsigned int i;
+
+    for (i = 0; i < BENCH_CASES; i++)
+    {
+        if (argc < 2)
+            printf("%s\n", Cases[i].name);
+        else if (!strcmp(argv[1], Cases[i].name))
+            bench = &Cases[i];
+    }
+    if (argc < 2)
+        return 0;
+    if (!bench)
+    {
+        fprintf(stderr, "bench: no case %s\n", argv[1]);
+        return 1;
+    }
+
+    HostReset();
+    if (bench->setup)
+        bench->setup();
+    HostSync();
+    reads = BenchTotal(HostReads);
+    writes = BenchTotal(HostWrites);
+    clocks = HostClocks;
+    __gcov_reset();
+
+    calls = bench->run();
+
+    HostSync();
+    printf("%s %u %lu %lu %lu\n", bench->name, calls,
+           BenchTotal(HostReads) - reads, BenchTotal(HostWrites) - writes, HostClocks - clocks);
+    return 0;
+}
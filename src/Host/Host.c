@@ -0,0 +1,614 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Host.c
+ * @brief Implementation of the host register file and peripheral model.
+ * The model keeps a copy of the file as it last saw it. At each access it
+ * first settles the previous one: registers that changed were written, and
+ * the previous access, if its register did not change, was a read. The model
+ * changes registers itself through HostSet(), which keeps the copy in step so
+ * its own changes are never taken for the program's.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "Host.h"
+#include "Interrupt.h"
+
+// Vectors of Interrupt.c, weak so the ones compiled out stay 0
+#undef __attribute__
+extern void PLT0CompairISR(void) __attribute__((weak));
+extern void ExternalPin0ISR(void) __attribute__((weak));
+extern void ExternalPin1ISR(void) __attribute__((weak));
+extern void UniversalSerialInterfaceISR(void) __attribute__((weak));
+extern void LowVoltageDetectISR(void) __attribute__((weak));
+extern void ADConverterISR(void) __attribute__((weak));
+extern void EEPROMISR(void) __attribute__((weak));
+extern void PTMCompairPISR(void) __attribute__((weak));
+extern void PTMCompairAISR(void) __attribute__((weak));
+extern void STMCompairPISR(void) __attribute__((weak));
+extern void STMCompairAISR(void) __attribute__((weak));
+extern void BaseTimer0ISR(void) __attribute__((weak));
+extern void BaseTimer1ISR(void) __attribute__((weak));
+extern void PLT1CompairISR(void) __attribute__((weak));
+
+/** @brief One interrupt vector: its INTCn register, enable bit and service routine.
+ * The request flag is the enable bit shifted up by four.
+ */
+typedef struct
+{
+    unsigned char reg;
+    unsigned char enable;
+    void (*isr)(void);
+} HostVector;
+
+/** @brief Vectors indexed by ISR_VECTOR_INDEX(), highest priority first. */
+static const HostVector HostVectors[ISR_VECTOR_COUNT] =
+{
+    { HOST_INTC0, 0x02, PLT0CompairISR },               // 0x04
+    { HOST_INTC0, 0x04, ExternalPin0ISR },              // 0x08
+    { HOST_INTC0, 0x08, ExternalPin1ISR },              // 0x0C
+    { HOST_INTC1, 0x01, UniversalSerialInterfaceISR },  // 0x10, the UART
+    { HOST_INTC1, 0x02, LowVoltageDetectISR },          // 0x14
+    { HOST_INTC1, 0x04, ADConverterISR },               // 0x18
+    { HOST_INTC1, 0x08, EEPROMISR },                    // 0x1C
+    { HOST_INTC2, 0x01, PTMCompairPISR },               // 0x20
+    { HOST_INTC2, 0x02, PTMCompairAISR },               // 0x24
+    { HOST_INTC2, 0x04, STMCompairPISR },               // 0x28
+    { HOST_INTC2, 0x08, STMCompairAISR },               // 0x2C
+    { HOST_INTC3, 0x01, BaseTimer0ISR },                // 0x30
+    { HOST_INTC3, 0x02, BaseTimer1ISR },                // 0x34
+    { HOST_INTC3, 0x04, PLT1CompairISR },               // 0x38
+};
+
+#define HOST_REGISTER_NAME(index, name)  #name,
+const char *const HostSfrName[HOST_SFR_COUNT] = { HOST_REGISTERS(HOST_REGISTER_NAME) };
+
+volatile HostRegister HostSfr[HOST_SFR_COUNT];
+unsigned long HostReads[HOST_SFR_COUNT];
+unsigned long HostWrites[HOST_SFR_COUNT];
+unsigned long HostClocks;
+unsigned char HostEeprom[HOST_EEPROM_SIZE];
+HostHook HostReadHook;
+HostHook HostWriteHook;
+void (*HostUartTransmit)(unsigned char data);
+
+static unsigned char HostSeen[HOST_SFR_COUNT];  // The file as the model last saw it
+static unsigned char HostLast = HOST_SFR_COUNT; // Register of the access not settled yet
+static unsigned char HostLastRx;                // URXIF was set at that access
+static unsigned char HostInIsr;
+static unsigned long HostTaken;                 // Interrupts taken, for _halt()
+
+static unsigned int HostStmCounter;
+static unsigned long HostStmPhase;
+static unsigned int HostPtmCounter;
+static unsigned long HostPtmPhase;
+static unsigned char HostPtmLevel;
+static unsigned long HostTbPhase[2];
+static unsigned long HostEepromLeft;            // Clocks left in a write cycle
+static unsigned long HostAdcLeft;               // Clocks left in a conversion
+static unsigned long HostUartLeft;              // Clocks left in a transmission
+static unsigned int HostAdc[16];
+
+// EEC bits, on IAR1 when MP1 = 0x140
+#define HOST_EEC_RD     0x01
+#define HOST_EEC_RDEN   0x02
+#define HOST_EEC_WR     0x04
+#define HOST_EEC_WREN   0x08
+
+#define HOST_PTM_CAPTURE  1     // PTM1~0 of capture input mode
+
+#define HOST_HIRCC_RESET  0x07    // HIRC on and stable at 4 MHz
+#if HOST_F_SYS != 4000000
+    #error "HOST_HIRCC_RESET must select HOST_F_SYS"
+#endif
+
+/** @brief Sets a register from the model, not as a program write. */
+static void HostSet(unsigned char reg, unsigned char value)
+{
+    HostSfr[reg].byte = value;
+    HostSeen[reg] = value;
+}
+
+/** @brief Raises the request flag of a vector. */
+static void HostRaise(unsigned char address)
+{
+    const HostVector *vector = &HostVectors[ISR_VECTOR_INDEX(address)];
+
+    HostSet(vector->reg, HostSfr[vector->reg].byte | (vector->enable << 4));
+}
+
+/** @brief Whether EEC is the register behind IAR1. */
+static char HostOnEec(void)
+{
+    return HostSfr[HOST_MP1H].byte == 0x01 && HostSfr[HOST_MP1L].byte == 0x40;
+}
+
+/** @brief fH in Hz from HIRCC, 0 while the HIRC is off. */
+static unsigned long HostHighHz(void)
+{
+    unsigned char hircc = HostSfr[HOST_HIRCC].byte;
+
+    return (hircc & 0x01) ? 2000000UL << ((hircc >> 2) & 3) : 0;
+}
+
+/** @brief fSYS in Hz from SCC: fH / 2^CKS, or fSUB for CKS = 7 or with fH off. */
+static unsigned long HostSysHz(void)
+{
+    unsigned char cks = HostSfr[HOST_SCC].byte >> 5;
+
+    return (cks == 7 || !HostHighHz()) ? HOST_F_SUB : HostHighHz() >> cks;
+}
+
+/** @brief fSYS clocks of a character at the current baud rate, from fH. */
+static unsigned long HostUartCharClocks(void)
+{
+    unsigned long divider = HostSfr[HOST_UUCR2].bits.b5 ? 16 : 64;
+
+    if (!HostHighHz())
+        return 0xFFFFFFFFUL;   // Stalls until the HIRC runs again
+    return 10 * divider * (HostSfr[HOST_UBRG].byte + 1UL) * HostSysHz() / HostHighHz();
+}
+
+/** @brief Starts sending one byte. */
+static void HostUartSend(unsigned char data)
+{
+    if (!HostSfr[HOST_UUCR1].bits.b7 || !HostSfr[HOST_UUCR2].bits.b7)
+        return;
+    if (HostUartTransmit)
+        HostUartTransmit(data);
+    HostSet(HOST_UUSR, HostSfr[HOST_UUSR].byte & ~0x02);
+    HostUartLeft = HostUartCharClocks();
+}
+
+/** @brief Reacts to a program write. */
+static void HostWrite(unsigned char reg, unsigned char old, unsigned char value)
+{
+    unsigned char address;
+
+    switch (reg)
+    {
+    case HOST_IAR1:
+        if (!HostOnEec())
+            break;
+        address = HostSfr[HOST_EEA].byte % HOST_EEPROM_SIZE;
+        if ((value & (HOST_EEC_WR | HOST_EEC_WREN)) == (HOST_EEC_WR | HOST_EEC_WREN) &&
+            !(old & HOST_EEC_WR) && !HostEepromLeft)
+        {
+            HostEeprom[address] = HostSfr[HOST_EED].byte;
+            HostEepromLeft = (unsigned long)HOST_EEPROM_WRITE_US * HostSysHz() / 1000000;
+        }
+        if ((value & (HOST_EEC_RD | HOST_EEC_RDEN)) == (HOST_EEC_RD | HOST_EEC_RDEN))
+        {
+            HostSet(HOST_EED, HostEeprom[address]);
+            HostSet(HOST_IAR1, value & ~HOST_EEC_RD);
+        }
+        break;
+
+    case HOST_SADC0:
+        // A conversion starts on the falling edge of START
+        if ((old & 0x80) && !(value & 0x80) && (value & 0x20))
+        {
+            HostSet(HOST_SADC0, value | 0x40);
+            HostAdcLeft = (unsigned long)HOST_ADC_CLOCKS << (HostSfr[HOST_SADC1].byte & 7);
+        }
+        break;
+
+    case HOST_STMC0:
+        if ((old & 0x08) && !(value & 0x08))
+            HostStmCounter = 0;
+        break;
+
+    case HOST_PTMC0:
+        if ((old & 0x08) && !(value & 0x08))
+            HostPtmCounter = 0;
+        break;
+
+    case HOST_UTXR_RXR:
+        HostUartSend(value);
+        break;
+
+    case HOST_HIRCC:
+        // The HIRC is stable as soon as it is on
+        HostSet(HOST_HIRCC, (value & ~0x02) | ((value & 0x01) << 1));
+        break;
+    }
+}
+
+/** @brief Settles the accesses since the last call. */
+void HostSync(void)
+{
+    unsigned char reg;
+    unsigned char old;
+    unsigned char value;
+
+    for (reg = 0; reg < HOST_SFR_COUNT; reg++)
+    {
+        value = HostSfr[reg].byte;
+        if (value == HostSeen[reg])
+            continue;
+        old = HostSeen[reg];
+        HostSeen[reg] = value;
+        HostWrites[reg]++;
+        if (reg == HostLast)
+            HostLast = HOST_SFR_COUNT;
+        HostWrite(reg, old, value);
+        if (HostWriteHook)
+            HostWriteHook(reg, value);
+    }
+
+    reg = HostLast;
+    if (reg == HOST_SFR_COUNT)
+        return;
+    HostLast = HOST_SFR_COUNT;
+    value = HostSfr[reg].byte;
+
+    // The same byte twice still goes out; a read happens only with one received
+    if (reg == HOST_UTXR_RXR && !HostLastRx)
+    {
+        HostWrites[reg]++;
+        HostUartSend(value);
+        if (HostWriteHook)
+            HostWriteHook(reg, value);
+        return;
+    }
+
+    HostReads[reg]++;
+    if (reg == HOST_UTXR_RXR)
+        HostSet(HOST_UUSR, HostSfr[HOST_UUSR].byte & ~0x01);
+    if (HostReadHook)
+        HostReadHook(reg, value);
+}
+
+/** @brief Counter clock of a timer, as a fraction of fSYS: number of counts per den clocks. */
+static unsigned long HostTimerRate(unsigned char select, unsigned long *den)
+{
+    switch (select)
+    {
+    case 0:  *den = 4;                return 1;
+    case 1:  *den = 1;                return 1;
+    case 2:  *den = 16 * HostSysHz(); return HostHighHz();
+    case 3:  *den = 64 * HostSysHz(); return HostHighHz();
+    case 4:
+    case 5:  *den = HostSysHz();      return HOST_F_SUB;
+    default: *den = 1;                return 0;   // External clock, never counts here
+    }
+}
+
+/** @brief Counts the STM once. */
+static void HostStmCount(void)
+{
+    unsigned char control = HostSfr[HOST_STMC0].byte;
+    unsigned int period = (control & 7) ? (control & 7) * 128U : 1024;
+    unsigned int ccra = ((HostSfr[HOST_STMAH].byte & 3) << 8) | HostSfr[HOST_STMAL].byte;
+    unsigned char clearOnA = HostSfr[HOST_STMC1].bits.b0;
+
+    if (!ccra)
+        ccra = 1024;
+    HostStmCounter++;
+    if (HostStmCounter == ccra)
+    {
+        HostRaise(STM_COMPAIR_A_ISR_ADDRESS);
+        if (clearOnA)
+            HostStmCounter = 0;
+    }
+    if (HostStmCounter == period)
+    {
+        HostRaise(STM_COMPAIR_P_ISR_ADDRESS);
+        if (!clearOnA)
+            HostStmCounter = 0;
+    }
+    if (HostStmCounter >= 1024)
+        HostStmCounter = 0;
+}
+
+/** @brief Counts the PTM once. */
+static void HostPtmCount(void)
+{
+    unsigned int ccrp = ((HostSfr[HOST_PTMRPH].byte & 3) << 8) | HostSfr[HOST_PTMRPL].byte;
+    unsigned int ccra = ((HostSfr[HOST_PTMAH].byte & 3) << 8) | HostSfr[HOST_PTMAL].byte;
+    unsigned char mode = HostSfr[HOST_PTMC1].byte >> 6;
+    unsigned char clearOnA = HostSfr[HOST_PTMC1].bits.b0;
+
+    if (!ccrp)
+        ccrp = 1024;
+    if (!ccra)
+        ccra = 1024;
+    HostPtmCounter++;
+
+    // In capture mode CCRA holds captures, so only P compares
+    if (mode != HOST_PTM_CAPTURE && HostPtmCounter == ccra)
+    {
+        HostRaise(PTM_COMPAIR_A_ISR_ADDRESS);
+        if (clearOnA)
+            HostPtmCounter = 0;
+    }
+    if (HostPtmCounter == ccrp)
+    {
+        HostRaise(PTM_COMPAIR_P_ISR_ADDRESS);
+        if (!clearOnA || mode == HOST_PTM_CAPTURE)
+            HostPtmCounter = 0;
+    }
+    if (HostPtmCounter >= 1024)
+        HostPtmCounter = 0;
+}
+
+/** @brief Runs one time base for some clocks. */
+static void HostTimeBase(unsigned char n, unsigned char reg, unsigned long clocks)
+{
+    unsigned char control = HostSfr[reg].byte;
+    unsigned long num;
+    unsigned long den;
+    unsigned long period;
+
+    if (!(control & 0x80))
+    {
+        HostTbPhase[n] = 0;
+        return;
+    }
+    switch (HostSfr[HOST_PSCR].byte & 3)
+    {
+    case 0:  num = 1; den = 1; break;
+    case 1:  num = 1; den = 4; break;
+    default: num = HOST_F_SUB; den = HostSysHz(); break;
+    }
+
+    period = (256UL << (control & 7)) * den;
+    HostTbPhase[n] += clocks * num;
+    while (HostTbPhase[n] >= period)
+    {
+        HostTbPhase[n] -= period;
+        HostRaise(n ? BASE_TIMER1_ISR_ADDRESS : BASE_TIMER0_ISR_ADDRESS);
+    }
+}
+
+/** @brief Counts down a busy time; 1 when it just ran out. */
+static char HostElapse(unsigned long *left, unsigned long clocks)
+{
+    if (!*left)
+        return 0;
+    if (*left > clocks)
+    {
+        *left -= clocks;
+        return 0;
+    }
+    *left = 0;
+    return 1;
+}
+
+/** @brief Takes the highest priority interrupt that is requested and enabled. */
+static void HostDispatch(void)
+{
+    unsigned char i;
+    const HostVector *vector;
+    unsigned char flag;
+
+    if (HostInIsr || !HostSfr[HOST_INTC0].bits.b0)
+        return;
+
+    for (i = 0; i < ISR_VECTOR_COUNT; i++)
+    {
+        vector = &HostVectors[i];
+        flag = vector->enable << 4;
+        if ((HostSfr[vector->reg].byte & (vector->enable | flag)) != (vector->enable | flag))
+            continue;
+
+        // Entering the vector clears its flag and EMI; RETI sets EMI again
+        HostSet(vector->reg, HostSfr[vector->reg].byte & ~flag);
+        HostSet(HOST_INTC0, HostSfr[HOST_INTC0].byte & ~0x01);
+        HostInIsr = 1;
+        HostTaken++;
+        if (vector->isr)
+            vector->isr();
+        HostSync();
+        HostInIsr = 0;
+        HostSet(HOST_INTC0, HostSfr[HOST_INTC0].byte | 0x01);
+        return;
+    }
+}
+
+/** @brief Lets a few clocks pass and takes a pending interrupt. */
+static void HostStep(unsigned long clocks)
+{
+    unsigned long num;
+    unsigned long den;
+    unsigned int value;
+    unsigned char control;
+
+    HostSync();
+    HostClocks += clocks;
+
+    control = HostSfr[HOST_STMC0].byte;
+    if ((control & 0x08) && !(control & 0x80))
+    {
+        num = HostTimerRate((control >> 4) & 7, &den);
+        for (HostStmPhase += clocks * num; HostStmPhase >= den; HostStmPhase -= den)
+            HostStmCount();
+        HostSet(HOST_STMDL, (unsigned char)HostStmCounter);
+        HostSet(HOST_STMDH, (unsigned char)(HostStmCounter >> 8));
+    }
+
+    control = HostSfr[HOST_PTMC0].byte;
+    if ((control & 0x08) && !(control & 0x80))
+    {
+        num = HostTimerRate((control >> 4) & 7, &den);
+        for (HostPtmPhase += clocks * num; HostPtmPhase >= den; HostPtmPhase -= den)
+            HostPtmCount();
+        HostSet(HOST_PTMDL, (unsigned char)HostPtmCounter);
+        HostSet(HOST_PTMDH, (unsigned char)(HostPtmCounter >> 8));
+    }
+
+    HostTimeBase(0, HOST_TB0C, clocks);
+    HostTimeBase(1, HOST_TB1C, clocks);
+
+    if (HostElapse(&HostEepromLeft, clocks))
+    {
+        if (HostOnEec())
+            HostSet(HOST_IAR1, HostSfr[HOST_IAR1].byte & ~HOST_EEC_WR);
+        HostRaise(EEPROM_ISR_ADDRESS);
+    }
+
+    if (HostElapse(&HostAdcLeft, clocks))
+    {
+        value = HostAdc[HostSfr[HOST_SADC0].byte & 0x0F] & 0x0FFF;
+        if (HostSfr[HOST_SADC0].bits.b4)
+        {
+            HostSet(HOST_SADOH, (unsigned char)(value >> 8));
+            HostSet(HOST_SADOL, (unsigned char)value);
+        }
+        else
+        {
+            HostSet(HOST_SADOH, (unsigned char)(value >> 4));
+            HostSet(HOST_SADOL, (unsigned char)(value << 4));
+        }
+        HostSet(HOST_SADC0, HostSfr[HOST_SADC0].byte & ~0x40);
+        HostRaise(ADC_ISR_ADDRESS);
+    }
+
+    if (HostElapse(&HostUartLeft, clocks))
+    {
+        HostSet(HOST_UUSR, HostSfr[HOST_UUSR].byte | 0x02);
+        if (HostSfr[HOST_UUCR2].bits.b1)
+            HostRaise(USIM_ISR_ADDRESS);
+    }
+
+    HostDispatch();
+}
+
+/** @brief Accounts for one access and runs the model up to it. */
+volatile HostRegister *HostAccess(unsigned char reg)
+{
+    HostStep(HOST_ACCESS_CLOCKS);
+    HostSync();
+    HostLast = reg;
+    HostLastRx = HostSfr[HOST_UUSR].bits.b0;
+    return &HostSfr[reg];
+}
+
+/** @brief Clears the registers, counters and time; the EEPROM reads 0xFF. */
+void HostReset(void)
+{
+    unsigned char reg;
+    unsigned char i;
+
+    for (reg = 0; reg < HOST_SFR_COUNT; reg++)
+    {
+        HostSet(reg, 0);
+        HostReads[reg] = 0;
+        HostWrites[reg] = 0;
+    }
+    HostSet(HOST_UUSR, 0x02);   // Transmitter empty
+    HostSet(HOST_HIRCC, HOST_HIRCC_RESET);
+    for (i = 0; i < HOST_EEPROM_SIZE; i++)
+        HostEeprom[i] = 0xFF;
+
+    HostLast = HOST_SFR_COUNT;
+    HostInIsr = 0;
+    HostClocks = 0;
+    HostStmCounter = 0;
+    HostStmPhase = 0;
+    HostPtmCounter = 0;
+    HostPtmPhase = 0;
+    HostPtmLevel = 0;
+    HostTbPhase[0] = 0;
+    HostTbPhase[1] = 0;
+    HostEepromLeft = 0;
+    HostAdcLeft = 0;
+    HostUartLeft = 0;
+}
+
+/** @brief Lets time pass, running the peripherals and taking interrupts. */
+void HostRun(unsigned long clocks)
+{
+    HostSync();
+    while (clocks >= HOST_ACCESS_CLOCKS)
+    {
+        HostStep(HOST_ACCESS_CLOCKS);
+        clocks -= HOST_ACCESS_CLOCKS;
+    }
+    if (clocks)
+        HostStep(clocks);
+}
+
+/** @brief Raises the request flag of a vector. */
+void HostInterrupt(unsigned char address)
+{
+    HostSync();
+    HostRaise(address);
+}
+
+/** @brief Delivers one received byte to the UART. */
+void HostUartReceive(unsigned char data)
+{
+    HostSync();
+    if (HostSfr[HOST_UUSR].bits.b0)
+        HostSet(HOST_UUSR, HostSfr[HOST_UUSR].byte | 0x10);    // Overrun
+    HostSet(HOST_UTXR_RXR, data);
+    HostSet(HOST_UUSR, HostSfr[HOST_UUSR].byte | 0x01);
+    if (HostSfr[HOST_UUCR2].bits.b2)
+        HostRaise(USIM_ISR_ADDRESS);
+}
+
+/** @brief Sets the 12-bit result the ADC returns for a channel. */
+void HostAdcSet(unsigned char channel, unsigned int value)
+{
+    HostAdc[channel & 0x0F] = value;
+}
+
+/** @brief Changes the level of the PTM capture input. */
+void HostPtmInput(unsigned char level)
+{
+    unsigned char edges;
+    unsigned char clear;
+
+    HostSync();
+    level = level ? 1 : 0;
+    if (level == HostPtmLevel)
+        return;
+    HostPtmLevel = level;
+
+    if (!HostSfr[HOST_PTMC0].bits.b3 || (HostSfr[HOST_PTMC1].byte >> 6) != HOST_PTM_CAPTURE)
+        return;
+
+    // PTIO: 0 rising, 1 falling, 2 both, 3 none
+    edges = (HostSfr[HOST_PTMC1].byte >> 4) & 3;
+    if (edges == 3 || (edges == 0 && !level) || (edges == 1 && level))
+        return;
+
+    HostSet(HOST_PTMAL, (unsigned char)HostPtmCounter);
+    HostSet(HOST_PTMAH, (unsigned char)(HostPtmCounter >> 8));
+    HostSet(HOST_PTMC2, (HostSfr[HOST_PTMC2].byte & ~0x04) | (level << 2));
+    HostRaise(PTM_COMPAIR_A_ISR_ADDRESS);
+
+    // PTTCLR: 0 P match only, 1 rising, 2 falling, 3 both edges
+    clear = HostSfr[HOST_PTMC2].byte & 3;
+    if (clear == 3 || (clear == 1 && level) || (clear == 2 && !level))
+        HostPtmCounter = 0;
+}
+
+/** @brief HALT: sleeps until an interrupt is taken. */
+void _halt(void)
+{
+    unsigned long taken = HostTaken;
+    unsigned long clocks;
+
+    HostSync();
+    for (clocks = 0; clocks < HOST_HALT_LIMIT && HostTaken == taken; clocks += HOST_ACCESS_CLOCKS)
+        HostStep(HOST_ACCESS_CLOCKS);
+}
+
+/** @brief NOP: one instruction. */
+void _nop(void)
+{
+    HostStep(HOST_ACCESS_CLOCKS);
+}
+
+/** @brief CLR WDT: one instruction; there is no watchdog. */
+void _clrwdt(void)
+{
+    HostStep(HOST_ACCESS_CLOCKS);
+}
@@ -0,0 +1,95 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Host.h
+ * @brief Header file for the host register file and peripheral model.
+ * The simulated register file sits behind the host BA45F5240.h. Time is
+ * counted in fSYS clocks: each SFR access stands for one instruction
+ * (HOST_ACCESS_CLOCKS), and HostRun() or _halt() move it further. fSYS and
+ * fH follow SCC and HIRCC, so after a clock switch a clock is shorter or
+ * longer and the peripherals count at their new rates. As time
+ * passes the model runs the STM, PTM, time bases, EEPROM, ADC and UART, raises
+ * their request flags and calls the vectors of Interrupt.c when EMI and the
+ * enable bit allow, one at a time, just as the device would.
+ *
+ * Writes are found by comparing the file with a copy at the next access,
+ * so writing a register the value it already holds reads as a read. The UART
+ * data register is the exception: touching it with no byte received transmits.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include "BA45F5240.h"
+
+/** @brief Model settings */
+//=========================================================================
+#define HOST_ACCESS_CLOCKS     4        // fSYS clocks per SFR access, one instruction
+#define HOST_F_SYS             4000000  // fSYS = fH in Hz after reset
+#define HOST_F_SUB             32768    // fSUB in Hz
+#define HOST_EEPROM_SIZE       64
+#define HOST_EEPROM_WRITE_US   4000     // Write cycle time
+#define HOST_ADC_CLOCKS        16       // Conversion time in ADC clocks
+#define HOST_HALT_LIMIT        HOST_F_SYS   // Longest _halt() before giving up, in clocks
+//=========================================================================
+
+/** @brief Hook called for each register access.
+ * @param reg HOST_xxx index of the register.
+ * @param value The value read, or the value written.
+ */
+typedef void (*HostHook)(unsigned char reg, unsigned char value);
+
+/** @brief Register names, indexed by HOST_xxx. */
+extern const char *const HostSfrName[HOST_SFR_COUNT];
+
+/** @brief Accesses of each register since HostReset(). */
+extern unsigned long HostReads[HOST_SFR_COUNT];
+extern unsigned long HostWrites[HOST_SFR_COUNT];
+
+/** @brief fSYS clocks since HostReset(). */
+extern unsigned long HostClocks;
+
+/** @brief Data EEPROM contents. */
+extern unsigned char HostEeprom[HOST_EEPROM_SIZE];
+
+/** @brief Called after every register read and write, 0 for none. */
+extern HostHook HostReadHook;
+extern HostHook HostWriteHook;
+
+/** @brief Called with each byte the UART transmits, 0 to drop them. */
+extern void (*HostUartTransmit)(unsigned char data);
+
+/** @brief Clears the registers, counters and time; the EEPROM reads 0xFF. */
+void HostReset(void);
+
+/** @brief Settles the last access, e.g. before looking at the UART output or the counters.
+ * Any access, HostRun() and the other calls below do this first.
+ */
+void HostSync(void);
+
+/** @brief Lets time pass, running the peripherals and taking interrupts.
+ * @param clocks fSYS clocks to run.
+ */
+void HostRun(unsigned long clocks);
+
+/** @brief Raises the request flag of a vector, e.g. an external pin.
+ * @param address Vector address from Interrupt.h.
+ */
+void HostInterrupt(unsigned char address);
+
+/** @brief Delivers one received byte to the UART. */
+void HostUartReceive(unsigned char data);
+
+/** @brief Sets the 12-bit result the ADC returns for a channel. */
+void HostAdcSet(unsigned char channel, unsigned int value);
+
+/** @brief Changes the level of the PTM capture input, capturing on the selected edges. */
+void HostPtmInput(unsigned char level);
+
+#endif // HOST_H
@@ -0,0 +1,19 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Main.h
+ * @brief Host stand-in for the project main header included by the timer drivers.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef MAIN_H
+#define MAIN_H
+
+#include "BA45F5240.h"
+
+#endif // MAIN_H
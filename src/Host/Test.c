@@ -0,0 +1,913 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Test.c
+ * @brief Tests of the drivers against the host model.
+ * Each case starts from a reset model with the UART running at 9600 baud and
+ * its output captured, drives a driver through its public API and checks what
+ * comes out. Run with no argument to run every case, or with case names to run
+ * those; each prints "name ok" or "name FAIL: why", and the exit status is 1
+ * if any failed.
+ *
+ * The telemetry case also writes telemetry.bin, the frames as sent, and
+ * telemetry.txt, the windows tools/telemetry_decode.py must print for them,
+ * to the current directory. "make test" runs every case in build/test and
+ * compares the two.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Host.h"
+#include "DHT11.h"
+#include "EEPROM.h"
+#include "EventQueue.h"
+#include "Format.h"
+#include "History.h"
+#include "Interrupt.h"
+#include "SevenSeg.h"
+#include "Telemetry.h"
+#include "UART.h"
+
+/** @brief One test case. */
+typedef struct
+{
+    const char *name;
+    char (*run)(void);            /**< Returns 1 if it passed */
+} TestCase;
+
+static char TestOutput[8192];     // UART output since TestStart()
+static unsigned int TestLength;
+
+/** @brief Prints why a case failed.
+ * @return 0, for the case to return.
+ */
+static char TestFail(const char *format, ...)
+{
+    va_list args;
+
+    printf("FAIL: ");
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+    return 0;
+}
+
+/** @brief Keeps each byte the UART transmits. */
+static void TestCapture(unsigned char data)
+{
+    if (TestLength < sizeof(TestOutput))
+        TestOutput[TestLength++] = (char)data;
+}
+
+/** @brief Resets the model and starts the UART with its output captured. */
+static void TestStart(void)
+{
+    HostReset();
+    HostReadHook = 0;
+    HostWriteHook = 0;
+    HostUartTransmit = TestCapture;
+    TestLength = 0;
+    UART_Init(9600);
+}
+
+/** @brief Transmits a string and a number. */
+static char TestUartTransmit(void)
+{
+    UART_TransmitString("AAB");
+    UART_TransmitNumber(1234);
+    HostSync();
+    if (TestLength != 7 || memcmp(TestOutput, "AAB1234", 7))
+        return TestFail("sent '%.*s', expected 'AAB1234'", (int)TestLength, TestOutput);
+    return 1;
+}
+
+#if USIM_ISR
+static char TestReceived[16];     // Bytes given to the UART receive handler
+static unsigned int TestReceivedLength;
+
+/** @brief Keeps each byte the receive handler is given. */
+static void TestReceive(char c)
+{
+    if (TestReceivedLength < sizeof(TestReceived))
+        TestReceived[TestReceivedLength++] = c;
+}
+
+/** @brief Receives a line through the receive interrupt. */
+static char TestUartReceive(void)
+{
+    const char *line = "OK\r\n";
+    unsigned char i;
+
+    TestReceivedLength = 0;
+    UART_SetReceiveHandler(TestReceive);
+    _emi = 1;
+    for (i = 0; line[i]; i++)
+    {
+        HostUartReceive((unsigned char)line[i]);
+        HostRun(4000);
+    }
+    if (TestReceivedLength != 4 || memcmp(TestReceived, line, 4))
+        return TestFail("handler got %u bytes '%.*s'", TestReceivedLength,
+                        (int)TestReceivedLength, TestReceived);
+    return 1;
+}
+#endif
+
+/** @brief Writes a byte and reads it back. */
+static char TestEeprom(void)
+{
+    char data = 0;
+
+    writeToEEPROM(5, 0x5A);
+    readFromEEPROM(5, &data);
+    if ((unsigned char)data != 0x5A || HostEeprom[5] != 0x5A)
+        return TestFail("read %02X, EEPROM holds %02X", (unsigned char)data, HostEeprom[5]);
+    return 1;
+}
+
+static char TestFormatted[32];    // Characters given to the format output
+static unsigned int TestFormattedLength;
+
+/** @brief Keeps each character Format() writes. */
+static void TestFormatPut(char c)
+{
+    if (TestFormattedLength < sizeof(TestFormatted))
+        TestFormatted[TestFormattedLength++] = c;
+}
+
+/** @brief Formats through FormatV() and compares the output and its count.
+ * @return 1 if both match expected.
+ */
+static char TestFormatOne(const char *expected, const char *format, ...)
+{
+    va_list args;
+    unsigned int count;
+
+    TestFormattedLength = 0;
+    va_start(args, format);
+    count = FormatV(TestFormatPut, format, args);
+    va_end(args);
+    if (count != TestFormattedLength || TestFormattedLength != strlen(expected) ||
+        memcmp(TestFormatted, expected, TestFormattedLength))
+        return TestFail("\"%s\" wrote \"%.*s\" counting %u, expected \"%s\"", format,
+                        (int)TestFormattedLength, TestFormatted, count, expected);
+    return 1;
+}
+
+/** @brief Runs each conversion, flag and width through the format output. */
+static char TestFormat(void)
+{
+    unsigned int count;
+
+    TestFormattedLength = 0;
+    count = Format(TestFormatPut, "%s=%u", "n", 7u);
+    if (count != 3 || TestFormattedLength != 3 || memcmp(TestFormatted, "n=7", 3))
+        return TestFail("Format() wrote \"%.*s\" counting %u, expected \"n=7\"",
+                        (int)TestFormattedLength, TestFormatted, count);
+
+    return TestFormatOne("[  42|42  |0042]", "[%4d|%-4d|%04d]", 42, 42, 42) &&
+           TestFormatOne("[ -42|-042|-42 ]", "[%4d|%04d|%-4d]", -42, -42, -42) &&
+           TestFormatOne("-123456789 -2147483648", "%ld %ld", -123456789L, -2147483647L - 1) &&
+           TestFormatOne("65535 4294967295", "%u %lu", 65535u, 4294967295UL) &&
+           TestFormatOne("0 00 0", "%x %02x %X", 0u, 0u, 0u) &&
+           TestFormatOne("beef BEEF 0001e240", "%x %X %08lx", 0xBEEFu, 0xBEEFu, 123456UL) &&
+           TestFormatOne("[ab  |  c]", "[%-4s|%3c]", "ab", 'c') &&
+           TestFormatOne("2.00 0.00", "%q %q", FIXED_CONST(1.999), FIXED_CONST(-0.001)) &&
+           TestFormatOne("-10.0 -1.0000", "%.1q %.4q", FIXED_CONST(-9.96), FIXED_CONST(-0.99999)) &&
+           TestFormatOne("[  3.0|-1.50 ]", "[%5.1hq|%-6hq]", FIXED8_CONST(2.98), FIXED8_CONST(-1.5)) &&
+           TestFormatOne("%y%5k 100%", "%y%5k %d%%", 100) &&
+           TestFormatOne("50%", "%d%", 50);
+}
+
+#if BASE_TIMER0_ISR
+static unsigned int TestTimeBase;
+
+/** @brief Counts time base 0 interrupts. */
+static void TestTimeBaseISR(void)
+{
+    TestTimeBase++;
+}
+
+/** @brief Takes ten time base 0 interrupts of 256 clocks. */
+static char TestTimeBaseRun(void)
+{
+    TestTimeBase = 0;
+    InterruptRegister(BASE_TIMER0_ISR_ADDRESS, TestTimeBaseISR);
+    _tb0c = 0x80;
+    _pscr = 0;
+    EnableInterrupt(BASE_TIMER0_ISR_ADDRESS);
+    _emi = 1;
+    HostRun(256 * 10);
+    if (TestTimeBase < 9 || TestTimeBase > 11)
+        return TestFail("%u interrupts, expected 10", TestTimeBase);
+    return 1;
+}
+#endif
+
+#if EVENT_COALESCE_MASK & 1
+/** @brief Floods a coalesced source past the 8-bit post count.
+ * Every flood must come out as one record counting 255 or more posts, with
+ * the data of the last post.
+ */
+static char TestEventCoalesce(void)
+{
+    static const unsigned int floods[] = { 3, 255, 256, 300, 511, 512 };
+    Event event;
+    unsigned int i;
+    unsigned int n;
+
+    for (i = 0; i < sizeof(floods) / sizeof(floods[0]); i++)
+    {
+        for (n = 0; n < floods[i]; n++)
+        {
+            if (!EventPost(0, (unsigned char)n))
+                return TestFail("post %u of %u refused", n, floods[i]);
+        }
+        if (!EventGet(&event))
+            return TestFail("no record after %u posts", floods[i]);
+        if (event.source != 0 || event.count != (floods[i] < 255 ? floods[i] : 255) ||
+            event.data != (unsigned char)(floods[i] - 1))
+            return TestFail("after %u posts: source %u count %u data %u", floods[i],
+                            event.source, event.count, event.data);
+        if (EventGet(&event))
+            return TestFail("a second record after %u posts, count %u", floods[i], event.count);
+    }
+    return 1;
+}
+#endif
+
+//=========================================================================
+// History
+//=========================================================================
+
+#define TEST_HISTORY_SAMPLES  48
+#define TEST_HISTORY_AFTER    3     // Appends after a power cut
+
+/** @brief A history sample and its dump line. */
+typedef struct
+{
+    unsigned long time;
+    unsigned char temperature;
+    unsigned char humidity;
+    unsigned char outputs;
+    char line[24];
+} TestSample;
+
+static TestSample TestSamples[TEST_HISTORY_SAMPLES + TEST_HISTORY_AFTER];
+static unsigned long TestRandom = 1;
+
+/** @brief Pseudo-random numbers, the same on every run. */
+static unsigned int TestNext(void)
+{
+    TestRandom = TestRandom * 1103515245UL + 12345;
+    return (unsigned int)(TestRandom >> 16) & 0x7FFF;
+}
+
+/** @brief Clamps a value to 0 to 127. */
+static unsigned char TestClamp(int value)
+{
+    return value < 0 ? 0 : (value > 127 ? 127 : (unsigned char)value);
+}
+
+/** @brief Makes samples that give keyframes, deltas and repeats. */
+static void TestHistorySamples(void)
+{
+    unsigned long time = 100;
+    int temperature = 20;
+    int humidity = 40;
+    unsigned char outputs = 1;
+    unsigned int random;
+    unsigned int i;
+
+    TestRandom = 1;
+    for (i = 0; i < TEST_HISTORY_SAMPLES + TEST_HISTORY_AFTER; i++)
+    {
+        random = TestNext();
+        time += (random % 11 == 0) ? 4 : 1;               // Gap: keyframe
+        if (random % 3)
+        {
+            temperature += (int)((random >> 4) % 5) - 2;
+            humidity += (int)((random >> 7) % 9) - 4;
+        }
+        if (random % 13 == 0)
+            temperature += 9;                             // Step too large for a delta
+        if (i % 15 == 14)
+            outputs ^= 2;
+        TestSamples[i].time = time;
+        TestSamples[i].temperature = TestClamp(temperature);
+        TestSamples[i].humidity = TestClamp(humidity);
+        TestSamples[i].outputs = outputs;
+        sprintf(TestSamples[i].line, "%lu,%u,%u,%u", time, TestSamples[i].temperature,
+                TestSamples[i].humidity, outputs);
+    }
+}
+
+/** @brief Appends one of the samples. */
+static void TestAppend(unsigned int i)
+{
+    HistoryAppend(TestSamples[i].time, TestSamples[i].temperature, TestSamples[i].humidity,
+                  TestSamples[i].outputs);
+}
+
+/** @brief Dumps the log and checks it is the newest of the expected lines.
+ * Old records are overwritten, so the dump may start anywhere, but it must end
+ * with the last expected line and hold at least one line if any are expected.
+ * @param expected Indexes into TestSamples, oldest first.
+ * @param count Number of indexes.
+ * @param lines Receives the number of lines dumped.
+ * @return 1 if it matched.
+ */
+static char TestDumpMatches(const unsigned int *expected, unsigned int count, unsigned int *lines)
+{
+    const char *line;
+    const char *end;
+    unsigned int n;
+
+    TestLength = 0;
+    HistoryDumpStart();
+    n = 0;
+    while (n <= count && HistoryDumpNext())
+        n++;
+    HostSync();
+    *lines = n;
+    if (n > count || (count && !n))
+        return 0;
+
+    line = TestOutput;
+    for (expected += count - n; n; n--, expected++)
+    {
+        end = strstr(line, "\r\n");
+        if (!end || (size_t)(end - line) != strlen(TestSamples[*expected].line) ||
+            memcmp(line, TestSamples[*expected].line, (size_t)(end - line)))
+            return 0;
+        line = end + 2;
+    }
+    return line == TestOutput + TestLength;
+}
+
+/** @brief Appends the samples one by one, dumping the log after each. */
+static char TestHistory(void)
+{
+    unsigned int expected[TEST_HISTORY_SAMPLES];
+    unsigned int lines;
+    unsigned int i;
+
+    TestHistorySamples();
+    HistoryInit();
+    for (i = 0; i < TEST_HISTORY_SAMPLES; i++)
+    {
+        TestAppend(i);
+        expected[i] = i;
+        if (!TestDumpMatches(expected, i + 1, &lines))
+            return TestFail("after sample %u the dump is %u lines '%.*s'", i, lines,
+                            (int)TestLength, TestOutput);
+    }
+    return 1;
+}
+
+static jmp_buf TestPowerCut;
+static unsigned int TestWrites;   // EEPROM writes started since the count was cleared
+static unsigned int TestCutAt;    // Cut the power after this write, 0 never
+
+/** @brief Counts EEPROM writes and cuts the power after the chosen one.
+ * Only EEC is reached through IAR1, so a write setting WR and WREN there is an
+ * EEPROM write; the model has stored the byte by the time the hook runs.
+ */
+static void TestEepromWrite(unsigned char reg, unsigned char value)
+{
+    if (reg != HOST_IAR1 || (value & 0x0C) != 0x0C)
+        return;
+    if (++TestWrites == TestCutAt)
+        longjmp(TestPowerCut, 1);
+}
+
+/** @brief Cuts the power after each EEPROM write of each append.
+ * After the restart the log must still dump as the newest samples, holding the
+ * cut sample or not, and take further appends.
+ */
+static char TestHistoryPowerCut(void)
+{
+    static unsigned int expected[TEST_HISTORY_SAMPLES + TEST_HISTORY_AFTER];
+    static unsigned int count;
+    static unsigned int sample;
+    static unsigned int cut;
+    static char done;
+    unsigned char image[HOST_EEPROM_SIZE];
+    unsigned int lines;
+    unsigned int i;
+
+    TestHistorySamples();
+    for (sample = 0; sample < TEST_HISTORY_SAMPLES; sample++)
+    {
+        for (cut = 1, done = 0; !done; cut++)
+        {
+            TestStart();
+            HistoryInit();
+            for (i = 0; i < sample; i++)
+                TestAppend(i);
+
+            TestWrites = 0;
+            TestCutAt = cut;
+            HostWriteHook = TestEepromWrite;
+            if (!setjmp(TestPowerCut))
+            {
+                TestAppend(sample);
+                done = 1;       // Every write of the append landed
+            }
+            HostWriteHook = 0;
+
+            // Power back: only the EEPROM is kept
+            memcpy(image, HostEeprom, sizeof(image));
+            TestStart();
+            memcpy(HostEeprom, image, sizeof(image));
+            HistoryInit();
+
+            for (count = 0; count < sample; count++)
+                expected[count] = count;
+            expected[count++] = sample;
+            if (!TestDumpMatches(expected, count, &lines))
+            {
+                count--;
+                if (done || !TestDumpMatches(expected, count, &lines))
+                    return TestFail("cut after write %u of sample %u: dump of %u lines '%.*s'",
+                                    cut, sample, lines, (int)TestLength, TestOutput);
+            }
+
+            for (i = 1; i <= TEST_HISTORY_AFTER; i++)
+            {
+                TestAppend(sample + i);
+                expected[count++] = sample + i;
+            }
+            if (!TestDumpMatches(expected, count, &lines))
+                return TestFail("appends after a cut after write %u of sample %u: "
+                                "dump of %u lines '%.*s'", cut, sample, lines,
+                                (int)TestLength, TestOutput);
+        }
+    }
+    return 1;
+}
+
+//=========================================================================
+// DHT11
+//=========================================================================
+
+/** @brief Holds the data line at a level for a time. */
+static void TestLevel(unsigned char level, unsigned long us)
+{
+    HostPtmInput(level);
+    HostRun(us * (HOST_F_SYS / 1000000));
+}
+
+/** @brief Reads one frame sent by a simulated sensor.
+ * @param frame The 5 bytes the sensor sends.
+ * @param humidity Receives the humidity.
+ * @param temperature Receives the temperature.
+ * @return What Dht11Read() returned.
+ */
+static signed char TestDht11Frame(const unsigned char *frame, unsigned char *humidity,
+                                  unsigned char *temperature)
+{
+    unsigned char bit;
+    unsigned char i;
+
+    Dht11Init();
+    _emi = 1;
+    if (!Dht11Start())
+        return DHT11_BUSY;
+    // The sensor answers once the start pulse ends and the pin is let go
+    for (i = 0; !DHT11_PIN_DIR && i < 250; i++)
+        HostRun(100 * (HOST_F_SYS / 1000000));
+    if (!DHT11_PIN_DIR)
+        return DHT11_NO_RESPONSE;
+
+    // Response: 80us low, 80us high, then per bit 50us low and 26us or 70us high
+    TestLevel(1, 30);
+    TestLevel(0, 80);
+    TestLevel(1, 80);
+    for (i = 0; i < 40; i++)
+    {
+        bit = (frame[i / 8] >> (7 - i % 8)) & 1;
+        TestLevel(0, 50);
+        TestLevel(1, bit ? 70 : 26);
+    }
+    TestLevel(0, 50);
+    TestLevel(1, 3000);
+    return Dht11Read(humidity, temperature);
+}
+
+/** @brief Decodes a good frame and rejects one with a wrong checksum. */
+static char TestDht11(void)
+{
+    static const unsigned char good[5] = { 45, 0, 23, 0, 68 };
+    static const unsigned char bad[5] = { 45, 0, 23, 0, 69 };
+    unsigned char humidity = 0;
+    unsigned char temperature = 0;
+    signed char result;
+
+    result = TestDht11Frame(good, &humidity, &temperature);
+    if (result != DHT11_OK || humidity != 45 || temperature != 23)
+        return TestFail("read %d rh=%u t=%u, expected 0 rh=45 t=23", result, humidity, temperature);
+
+    TestStart();
+    result = TestDht11Frame(bad, &humidity, &temperature);
+    if (result != DHT11_CHECKSUM_ERROR)
+        return TestFail("read %d with a wrong checksum, expected %d", result, DHT11_CHECKSUM_ERROR);
+    return 1;
+}
+
+//=========================================================================
+// Telemetry
+//=========================================================================
+
+#define TEST_WINDOWS        500
+#define TEST_RECORDS        (TEST_WINDOWS + 8)
+#define TEST_WINDOW         (1 << TELEMETRY_WINDOW_SHIFT)
+
+/** @brief A recorded window. */
+typedef struct
+{
+    unsigned int gap;
+    unsigned char mask;
+    int average[TELEMETRY_CHANNELS];
+    int min[TELEMETRY_CHANNELS];
+    int max[TELEMETRY_CHANNELS];
+} TestRecord;
+
+static TestRecord TestReference[TEST_RECORDS];   // What should be recorded
+static unsigned int TestReferenceCount;
+static TestRecord TestDecoded;
+static unsigned int TestDecodedCount;
+static int TestLast[TELEMETRY_CHANNELS];         // Last recorded averages
+static unsigned int TestGap;
+static unsigned char TestSequence;
+static unsigned long TestWindowNumber;
+static char TestBounded;
+static FILE *TestCaptureFile;
+static FILE *TestWindowsFile;
+
+/** @brief Reads a LEB128 varint, 0 past the end of the frame. */
+static unsigned int TestVarint(const unsigned char *frame, unsigned char length, unsigned char *at)
+{
+    unsigned int value = 0;
+    unsigned char shift = 0;
+
+    while (*at < length)
+    {
+        value |= (unsigned int)(frame[*at] & 0x7F) << shift;
+        shift += 7;
+        if (!(frame[(*at)++] & 0x80))
+            break;
+    }
+    return value;
+}
+
+/** @brief Works out what a window should record, as the device must. */
+static void TestReferenceWindow(const int samples[][TELEMETRY_CHANNELS])
+{
+    static const int deadband[TELEMETRY_CHANNELS] = TELEMETRY_DEADBANDS;
+    TestRecord *record = &TestReference[TestReferenceCount];
+    long sum;
+    int delta;
+    unsigned char c;
+    unsigned char i;
+
+    record->mask = 0;
+    for (c = 0; c < TELEMETRY_CHANNELS; c++)
+    {
+        sum = 0;
+        record->min[c] = record->max[c] = samples[0][c];
+        for (i = 0; i < TEST_WINDOW; i++)
+        {
+            sum += samples[i][c];
+            if (samples[i][c] < record->min[c])
+                record->min[c] = samples[i][c];
+            if (samples[i][c] > record->max[c])
+                record->max[c] = samples[i][c];
+        }
+        // The average rounds down, also below zero
+        record->average[c] = (int)((sum - (sum < 0 ? TEST_WINDOW - 1 : 0)) / TEST_WINDOW);
+        delta = record->average[c] - TestLast[c];
+        if (!TestReferenceCount || delta > deadband[c] || -delta > deadband[c] ||
+            record->max[c] - record->min[c] > deadband[c])
+            record->mask |= 1 << c;
+    }
+
+    if (!record->mask)
+    {
+        if (TestGap < TELEMETRY_GAP_SATURATED)
+            TestGap++;
+        return;
+    }
+    record->gap = TestGap;
+    for (c = 0; c < TELEMETRY_CHANNELS; c++)
+    {
+        if (record->mask & (1 << c))
+            TestLast[c] = record->average[c];
+    }
+    TestGap = 0;
+    if (TestReferenceCount < TEST_RECORDS - 1)
+        TestReferenceCount++;
+}
+
+/** @brief Decodes a frame and compares its records with the reference. */
+static char TestTelemetryFrame(const unsigned char *frame, unsigned char length)
+{
+    static int average[TELEMETRY_CHANNELS];
+    const TestRecord *reference;
+    unsigned char at = 3;
+    unsigned int zigzag;
+    unsigned char c;
+    char number[16];
+    char line[TELEMETRY_CHANNELS * 24];
+
+    fwrite(frame, 1, length, TestCaptureFile);
+    if (frame[1] == 2)
+        fputc(0x00, TestCaptureFile);   // A stray byte the decoder must skip
+
+    if (length < 3 || frame[2] != length || frame[1] != TestSequence++)
+        return TestFail("frame %u: length %u, header %u, sequence %u", TestSequence - 1,
+                        length, frame[2], frame[1]);
+    if (frame[0] == TELEMETRY_HEART)
+        return length == 3 ? 1 : TestFail("heartbeat of %u bytes", length);
+    if (frame[0] != (TestDecodedCount ? TELEMETRY_DELTA : TELEMETRY_KEY))
+        return TestFail("frame %u is '%c'", frame[1], frame[0]);
+    if (frame[0] == TELEMETRY_KEY)
+        memset(average, 0, sizeof(average));
+
+    while (at < length)
+    {
+        TestDecoded.gap = TestVarint(frame, length, &at);
+        TestDecoded.mask = at < length ? frame[at++] : 0;
+        TestWindowNumber += TestDecoded.gap + (TestDecodedCount ? 1 : 0);
+        if (TestDecoded.gap >= TELEMETRY_GAP_SATURATED)
+            TestBounded = 1;
+        sprintf(number, "%s%lu", TestBounded ? ">=" : "", TestWindowNumber);
+        line[0] = 0;
+        for (c = 0; c < TELEMETRY_CHANNELS; c++)
+        {
+            if (!(TestDecoded.mask & (1 << c)))
+                continue;
+            zigzag = TestVarint(frame, length, &at);
+            average[c] += (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+            TestDecoded.average[c] = average[c];
+            TestDecoded.min[c] = average[c] - (int)TestVarint(frame, length, &at);
+            TestDecoded.max[c] = average[c] + (int)TestVarint(frame, length, &at);
+            sprintf(line + strlen(line), "%s%u=%d[%d..%d]", line[0] ? " " : "", c, average[c],
+                    TestDecoded.min[c], TestDecoded.max[c]);
+        }
+        // As tools/telemetry_decode.py prints it
+        fprintf(TestWindowsFile, "%8s  %s\n", number, line);
+
+        if (TestDecodedCount >= TestReferenceCount)
+            return TestFail("record %u was never recorded", TestDecodedCount);
+        reference = &TestReference[TestDecodedCount];
+        if (TestDecoded.gap != reference->gap || TestDecoded.mask != reference->mask)
+            return TestFail("record %u: gap %u mask %02X, expected gap %u mask %02X",
+                            TestDecodedCount, TestDecoded.gap, TestDecoded.mask,
+                            reference->gap, reference->mask);
+        for (c = 0; c < TELEMETRY_CHANNELS; c++)
+        {
+            if ((TestDecoded.mask & (1 << c)) &&
+                (TestDecoded.average[c] != reference->average[c] ||
+                 TestDecoded.min[c] != reference->min[c] || TestDecoded.max[c] != reference->max[c]))
+                return TestFail("record %u channel %u: %d[%d..%d], expected %d[%d..%d]",
+                                TestDecodedCount, c, TestDecoded.average[c], TestDecoded.min[c],
+                                TestDecoded.max[c], reference->average[c], reference->min[c],
+                                reference->max[c]);
+        }
+        TestDecodedCount++;
+    }
+    return 1;
+}
+
+/** @brief Runs one window through the aggregator and takes the frames due. */
+static char TestTelemetryWindow(const int samples[][TELEMETRY_CHANNELS])
+{
+    const unsigned char *frame;
+    unsigned char length;
+    unsigned char i;
+
+    TestReferenceWindow(samples);
+    for (i = 0; i < TEST_WINDOW; i++)
+    {
+        TelemetrySample(samples[i]);
+        frame = TelemetryTake(&length);
+        if (frame && !TestTelemetryFrame(frame, length))
+            return 0;
+    }
+    return 1;
+}
+
+/** @brief Aggregates 500 windows of wandering, noisy and quiet channels.
+ * Every window the device records must decode to the min, max and average
+ * worked out here, and every window it leaves out must be within the
+ * deadbands. A long quiet stretch then saturates the gap.
+ */
+static char TestTelemetry(void)
+{
+    int samples[TEST_WINDOW][TELEMETRY_CHANNELS];
+    int level[TELEMETRY_CHANNELS] = { 0 };
+    unsigned int random;
+    unsigned int window;
+    unsigned char c;
+    unsigned char i;
+    char calm;
+    char passed = 0;
+
+    TestCaptureFile = fopen("telemetry.bin", "wb");
+    TestWindowsFile = fopen("telemetry.txt", "w");
+    if (!TestCaptureFile || !TestWindowsFile)
+        return TestFail("cannot write telemetry.bin or telemetry.txt");
+
+    TestRandom = 7;
+    memset(TestLast, 0, sizeof(TestLast));
+    TestReferenceCount = TestDecodedCount = 0;
+    TestGap = 0;
+    TestSequence = 0;
+    TestWindowNumber = 0;
+    TestBounded = 0;
+    TelemetryInit();
+
+    for (window = 0; window < TEST_WINDOWS; window++)
+    {
+        calm = TestNext() % 3 == 0;     // Every channel holds still
+        for (c = 0; c < TELEMETRY_CHANNELS; c++)
+        {
+            random = TestNext();
+            if (!calm && random % 4 == 0)
+                level[c] += (int)(random >> 4) % 7 - 3;
+            if (!calm && random % 61 == 0)
+                level[c] += (random & 0x100) ? 2000 : -2000;    // Multi-byte deltas
+            for (i = 0; i < TEST_WINDOW; i++)
+            {
+                samples[i][c] = level[c];
+                if (!calm && random % 3 == 0)
+                    samples[i][c] += (int)(TestNext() % 5) - 2;
+            }
+        }
+        if (!TestTelemetryWindow((const int (*)[TELEMETRY_CHANNELS])samples))
+            goto done;
+    }
+
+    // Quiet at the last recorded averages until the gap saturates, then a change
+    for (i = 0; i < TEST_WINDOW; i++)
+    {
+        for (c = 0; c < TELEMETRY_CHANNELS; c++)
+            samples[i][c] = TestLast[c];
+    }
+    for (window = 0; window < TELEMETRY_GAP_SATURATED + 10; window++)
+    {
+        if (!TestTelemetryWindow((const int (*)[TELEMETRY_CHANNELS])samples))
+            goto done;
+    }
+    for (window = 0; window < TELEMETRY_BATCH; window++)
+    {
+        samples[window][0] += 5;
+        if (!TestTelemetryWindow((const int (*)[TELEMETRY_CHANNELS])samples))
+            goto done;
+    }
+
+    // Quiet again until a heartbeat takes the last records
+    for (i = 0; i < TEST_WINDOW; i++)
+    {
+        for (c = 0; c < TELEMETRY_CHANNELS; c++)
+            samples[i][c] = TestLast[c];
+    }
+    for (window = 0; window < TELEMETRY_HEARTBEAT; window++)
+    {
+        if (!TestTelemetryWindow((const int (*)[TELEMETRY_CHANNELS])samples))
+            goto done;
+    }
+
+    if (TestDecodedCount != TestReferenceCount)
+        TestFail("%u records decoded of %u", TestDecodedCount, TestReferenceCount);
+    else if (!TestBounded)
+        TestFail("the quiet stretch did not saturate the gap");
+    else
+        passed = 1;
+
+done:
+    fclose(TestCaptureFile);
+    fclose(TestWindowsFile);
+    return passed;
+}
+
+#if SEVEN_SEG
+/** @brief Shows 1234 and follows two rounds of the multiplex.
+ * Each slot must light one common, PA2, PA4, PA5 and PA7 in turn, with the
+ * segments of its digit, and leave the other port A pins alone. The first
+ * slot after start-up may stay dark, blanked by the CCRA STimerInit() left,
+ * so the rounds start at the first digit lit.
+ */
+static char TestSevenSeg(void)
+{
+    static const unsigned char commons[SEG_DIGITS] = { 0x04, 0x10, 0x20, 0x80 };
+    static const unsigned char patterns[SEG_DIGITS] =
+    {
+        SEG_B | SEG_C,
+        SEG_A | SEG_B | SEG_D | SEG_E | SEG_G,
+        SEG_A | SEG_B | SEG_C | SEG_D | SEG_G,
+        SEG_B | SEG_C | SEG_F | SEG_G
+    };
+    unsigned char others;
+    unsigned char lit;
+    unsigned char last = 0;
+    unsigned char slots = 0;
+    unsigned char first = SEG_DIGITS;
+    unsigned char digit;
+    unsigned long step;
+
+    others = _pa & ~SEG_DIGIT_PINS;
+    SevenSegInit();
+    SevenSegWriteNumber(1234);
+    STimerInit();
+    _emi = 1;
+
+    for (step = 0; step < 4000 && slots < 2 * SEG_DIGITS; step++)
+    {
+        HostRun(64);
+        if ((_pa & ~SEG_DIGIT_PINS) != others)
+            return TestFail("port A went %02X outside the commons", _pa);
+
+        lit = ~_pa & SEG_DIGIT_PINS;   // The commons are active low
+        if (lit == last)
+            continue;
+        last = lit;
+        if (!lit)
+            continue;
+        if (first == SEG_DIGITS)
+        {
+            for (first = 0; first < SEG_DIGITS && commons[first] != lit; first++)
+                ;
+        }
+        digit = (first + slots) % SEG_DIGITS;
+        if (lit != commons[digit])
+            return TestFail("slot %u lit commons %02X, expected %02X", slots, lit, commons[digit]);
+        if (_pb != patterns[digit])
+            return TestFail("slot %u showed %02X, expected %02X", slots, _pb, patterns[digit]);
+        slots++;
+    }
+    if (slots < 2 * SEG_DIGITS)
+        return TestFail("%u slots lit", slots);
+    return 1;
+}
+#endif
+
+static const TestCase Cases[] =
+{
+    { "uart",               TestUartTransmit },
+#if USIM_ISR
+    { "uart-receive",       TestUartReceive },
+#endif
+    { "eeprom",             TestEeprom },
+    { "format",             TestFormat },
+#if BASE_TIMER0_ISR
+    { "time-base",          TestTimeBaseRun },
+#endif
+#if EVENT_COALESCE_MASK & 1
+    { "event-coalesce",     TestEventCoalesce },
+#endif
+#if SEVEN_SEG
+    { "seven-seg",          TestSevenSeg },
+#endif
+    { "history",            TestHistory },
+    { "history-power-cut",  TestHistoryPowerCut },
+    { "dht11",              TestDht11 },
+    { "telemetry",          TestTelemetry },
+};
+
+#define TEST_CASES  (sizeof(Cases) / sizeof(Cases[0]))
+
+int main(int argc, char **argv)
+{
+    unsigned int failed = 0;
+    unsigned int i;
+    int arg;
+
+    for (i = 0; i < TEST_CASES; i++)
+    {
+        for (arg = 1; arg < argc && strcmp(argv[arg], Cases[i].name); arg++)
+            ;
+        if (argc > 1 && arg == argc)
+            continue;
+
+        printf("%s ", Cases[i].name);
+        fflush(stdout);
+        TestStart();
+        if (Cases[i].run())
+            printf("ok\n");
+        else
+            failed++;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file EventQueue.c
+ * @brief Implementation of the deferred interrupt work queue.
+ * The producer only writes EventHead and the consumer only writes EventTail,
+ * both single bytes, so no interrupt masking is needed. Coalescing follows
+ * the same rule: the producer advances EventPosted, the consumer EventTaken.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "EventQueue.h"
+
+#if (EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) || EVENT_QUEUE_SIZE > 128
+    #error "EVENT_QUEUE_SIZE must be a power of two up to 128"
+#endif
+
+static Event EventRing[EVENT_QUEUE_SIZE];
+static volatile unsigned char EventHead;  // Written by the producer only
+static volatile unsigned char EventTail;  // Written by the consumer only
+
+volatile unsigned char EventOverflows;
+
+#if EVENT_COALESCE_MASK
+static volatile unsigned char EventQueued[EVENT_SOURCES];  // Set by the producer, cleared by the consumer
+static volatile unsigned char EventPosted[EVENT_SOURCES];  // Written by the producer only
+static unsigned char EventTaken[EVENT_SOURCES];            // Written by the consumer only
+static unsigned char EventAhead[EVENT_SOURCES];            // Its waiting record was counted early, consumer only
+static volatile unsigned char EventLast[EVENT_SOURCES];    // Latest data of a coalesced source
+
+#define EVENT_COALESCED(source)  ((EVENT_COALESCE_MASK >> (source)) & 1)
+#endif
+
+/** @brief Posts an event.
+ * @param source The event source, below EVENT_SOURCES.
+ * @param data Event data.
+ * @return 1 if the event was queued or coalesced, 0 if the queue was full.
+ */
+char EventPost(unsigned char source, unsigned char data)
+{
+    unsigned char head = EventHead;
+    Event *slot;
+
+    #if EVENT_COALESCE_MASK
+        if (EVENT_COALESCED(source))
+        {
+            EventLast[source] = data;
+            // Saturate rather than wrap, so a flood cannot read as no posts
+            if ((unsigned char)(EventPosted[source] - EventTaken[source]) != 0xFF)
+                EventPosted[source]++;
+            if (EventQueued[source])
+                return 1;  // Merged into the event already waiting
+        }
+    #endif
+
+    if ((unsigned char)(head - EventTail) >= EVENT_QUEUE_SIZE)
+    {
+        EventOverflows++;
+        return 0;
+    }
+
+    slot = &EventRing[head & (EVENT_QUEUE_SIZE - 1)];
+    slot->source = source;
+    slot->data = data;
+    slot->count = 1;
+
+    #if EVENT_COALESCE_MASK
+        if (EVENT_COALESCED(source))
+            EventQueued[source] = 1;
+    #endif
+
+    // Publish the record only after it is complete
+    EventHead = head + 1;
+    return 1;
+}
+
+/** @brief Takes the oldest event.
+ *
+ * For a coalesced source the record reports every post since the previous
+ * event of that source, up to 255. A post landing just after the re-arm below
+ * queues a record that this event may already count; EventQueued shows it,
+ * and that record is skipped if nothing was posted after it.
+ *
+ * @param event Pointer to the record that receives the event.
+ * @return 1 if an event was taken, 0 if the queue is empty.
+ */
+char EventGet(Event *event)
+{
+    unsigned char tail = EventTail;
+
+    while (tail != EventHead)
+    {
+        *event = EventRing[tail & (EVENT_QUEUE_SIZE - 1)];
+        EventTail = ++tail;
+
+        #if EVENT_COALESCE_MASK
+            if (EVENT_COALESCED(event->source))
+            {
+                unsigned char source = event->source;
+                unsigned char posted;
+                unsigned char ahead = EventAhead[source];
+
+                // Re-arm first so that a later post queues a new record
+                EventQueued[source] = 0;
+                posted = EventPosted[source];
+                event->count = posted - EventTaken[source];
+                event->data = EventLast[source];
+                EventTaken[source] = posted;
+
+                // A record queued since the re-arm may hold posts counted here
+                EventAhead[source] = EventQueued[source];
+                if (ahead && event->count == 0)
+                    continue;
+            }
+        #endif
+
+        return 1;
+    }
+
+    return 0;
+}
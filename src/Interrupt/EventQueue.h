@@ -0,0 +1,68 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file EventQueue.h
+ * @brief Header file for the deferred interrupt work queue for Holtek MCUs.
+ * Interrupt service routines post small event records with EventPost() and
+ * return; the main loop drains them with EventGet() and does the long work
+ * there, with interrupts enabled. The queue is single-producer/single-consumer
+ * and lock-free: interrupts do not nest, so all ISRs together form the one
+ * producer and the main loop is the one consumer.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+/** @brief Number of records in the queue, a power of two up to 128.
+ * Each record costs 3 bytes of RAM.
+ */
+#define EVENT_QUEUE_SIZE      8
+
+/** @brief Number of event sources.
+ * Interrupt vectors use ISR_VECTOR_INDEX(address) as source, 0 to 13;
+ * the application may use the sources above them.
+ */
+#define EVENT_SOURCES         16
+
+/** @brief Sources whose events are coalesced, one bit per source.
+ * While an event of a coalesced source waits in the queue, further posts of
+ * that source only bump its count, so a flood cannot overflow the queue.
+ * Coalescing costs 5 bytes of RAM per source, for all EVENT_SOURCES once any
+ * bit is set; 0 compiles it out.
+ */
+//=========================================================================
+#define EVENT_COALESCE_MASK   0x0000
+//=========================================================================
+
+/** @brief One queued event. */
+typedef struct
+{
+    unsigned char source;  /**< Posting source */
+    unsigned char data;    /**< Data of the event (latest post when coalesced) */
+    unsigned char count;   /**< Number of posts merged into this event, 255 meaning 255 or more */
+} Event;
+
+/** @brief Number of events dropped because the queue was full. */
+extern volatile unsigned char EventOverflows;
+
+/** @brief Posts an event. Call only from interrupt service routines,
+ * or from the main loop with interrupts disabled.
+ * @param source The event source, below EVENT_SOURCES.
+ * @param data Event data.
+ * @return 1 if the event was queued or coalesced, 0 if the queue was full.
+ */
+char EventPost(unsigned char source, unsigned char data);
+
+/** @brief Takes the oldest event. Call only from the main loop.
+ * @param event Pointer to the record that receives the event.
+ * @return 1 if an event was taken, 0 if the queue is empty.
+ */
+char EventGet(Event *event);
+
+#endif // EVENT_QUEUE_H
@@ -14,266 +14,258 @@
  */
 
 #include <Interrupt.h>
+#include <Idle.h>
+#include <IsrStats.h>
+#include <Profiler.h>
+
+#if TICKLESS_IDLE && !BASE_TIMER1_ISR
+    #error "TICKLESS_IDLE requires BASE_TIMER1_ISR = Enable"
+#endif
+
+// Interrupt enable bits of INTC0~INTC3 (the upper bits hold request flags)
+#define INTC0_ENABLE_BITS   0x0E
+#define INTC1_ENABLE_BITS   0x0F
+#define INTC2_ENABLE_BITS   0x0F
+#define INTC3_ENABLE_BITS   0x07
+
+/** @brief Enable bit of one interrupt vector. */
+typedef struct
+{
+    volatile unsigned char *reg;  /**< INTCn register holding the enable bit */
+    unsigned char mask;           /**< Enable bit, 0 when the ISR is compiled out */
+} InterruptBit;
+
+/** @brief Enable bits indexed by ISR_VECTOR_INDEX(), kept in ROM.
+ * Vectors whose ISR is compiled out get an empty mask so they can never be
+ * enabled without a service routine behind them.
+ */
+static const InterruptBit InterruptBits[ISR_VECTOR_COUNT] =
+{
+    { &_intc0, PLT_COMPAIR0_ISR  * 0x02 },  // 0x04
+    { &_intc0, EXTERNAL_PIN0_ISR * 0x04 },  // 0x08
+    { &_intc0, EXTERNAL_PIN1_ISR * 0x08 },  // 0x0C
+    { &_intc1, USIM_ISR          * 0x01 },  // 0x10
+    { &_intc1, LVD_ISR           * 0x02 },  // 0x14
+    { &_intc1, ADC_ISR           * 0x04 },  // 0x18
+    { &_intc1, EEPROM_ISR        * 0x08 },  // 0x1C
+    { &_intc2, PTM_COMPAIR_P_ISR * 0x01 },  // 0x20
+    { &_intc2, PTM_COMPAIR_A_ISR * 0x02 },  // 0x24
+    { &_intc2, STM_COMPAIR_P_ISR * 0x04 },  // 0x28
+    { &_intc2, STM_COMPAIR_A_ISR * 0x08 },  // 0x2C
+    { &_intc3, BASE_TIMER0_ISR   * 0x01 },  // 0x30
+    { &_intc3, BASE_TIMER1_ISR   * 0x02 },  // 0x34
+    { &_intc3, PLT_COMPAIR1_ISR  * 0x04 },  // 0x38
+};
 
 /** @brief Initializes the interrupts.
- * This function enables the global interrupt and configures individual interrupts
- * based on predefined settings. It sets up each interrupt based on whether it's enabled or disabled.
+ * This function enables every vector whose ISR is compiled in and then the
+ * global interrupt. Vectors switched off in Interrupt.h stay disabled.
  */
 void IntrruptInit(void)
 {
+    Interrupt_SetMask(ISR_COMPILED_MASK);
     GLOBAL_INTERRUPT = Enable;
+}
 
-    #if EXTERNAL_PIN0_ISR
-        _pltc0e = EXTERNAL_PIN0_ISR;
-    #endif
+/** @brief Enables a specific interrupt dynamically.
+ * @param interruptAddress The address of the interrupt to be enabled.
+ */
+void EnableInterrupt(char interruptAddress)
+{
+    unsigned char index = ISR_VECTOR_INDEX(interruptAddress);
 
-    #if EXTERNAL_PIN1_ISR
-        _int0e = EXTERNAL_PIN0_ISR;
-    #endif
+    if (index < ISR_VECTOR_COUNT)
+        *InterruptBits[index].reg |= InterruptBits[index].mask;
+}
 
-    #if USIM_ISR
-        _usime = USIM_ISR;
-    #endif
+/** @brief Disables a specific interrupt dynamically.
+ * @param interruptAddress The address of the interrupt to be disabled.
+ */
+void DisableInterrupt(char interruptAddress)
+{
+    unsigned char index = ISR_VECTOR_INDEX(interruptAddress);
 
-    #if LVD_ISR
-        _lve = LVD_ISR;
-    #endif
+    if (index < ISR_VECTOR_COUNT)
+        *InterruptBits[index].reg &= ~InterruptBits[index].mask;
+}
 
-    #if ADC_ISR
-        _ade = ADC_ISR;
-    #endif
+/** @brief Applies a whole set of enabled vectors.
+ * @param mask The vectors to enable; every other vector is disabled.
+ *
+ * Each register takes one AND and one OR, single read-modify-write
+ * instructions, so request flags raised meanwhile are not lost.
+ */
+void Interrupt_SetMask(IntMask mask)
+{
+    unsigned char bits;
 
-    #if EEPROM_ISR
-        _dee = EEPROM_ISR;
-    #endif
+    mask &= ISR_COMPILED_MASK;
 
-    #if PTM_COMPAIR_P_ISR
-        _ptmpe = PTM_COMPAIR_P_ISR;
-    #endif
+    bits = (unsigned char)mask & INTC0_ENABLE_BITS;
+    _intc0 &= bits | ~INTC0_ENABLE_BITS;
+    _intc0 |= bits;
 
-    #if PTM_COMPAIR_A_ISR
-        _ptmae = PTM_COMPAIR_A_ISR;
-    #endif
+    bits = (unsigned char)(mask >> 4) & INTC1_ENABLE_BITS;
+    _intc1 &= bits | ~INTC1_ENABLE_BITS;
+    _intc1 |= bits;
 
-    #if STM_COMPAIR_P_ISR
-        _stmpe = STM_COMPAIR_P_ISR;
-    #endif
+    bits = (unsigned char)(mask >> 8) & INTC2_ENABLE_BITS;
+    _intc2 &= bits | ~INTC2_ENABLE_BITS;
+    _intc2 |= bits;
 
-    #if STM_COMPAIR_A_ISR
-        _stmae = STM_COMPAIR_A_ISR;
-    #endif
+    bits = (unsigned char)(mask >> 12) & INTC3_ENABLE_BITS;
+    _intc3 &= bits | ~INTC3_ENABLE_BITS;
+    _intc3 |= bits;
+}
 
-    #if BASE_TIMER0_ISR
-        _tb0e = BASE_TIMER0_ISR;
-    #endif
+/** @brief Reads the set of enabled vectors.
+ * @return The enabled vectors, one bit per vector as in INT_MASK().
+ */
+IntMask Interrupt_GetMask(void)
+{
+    return (_intc0 & INTC0_ENABLE_BITS) |
+           ((IntMask)(_intc1 & INTC1_ENABLE_BITS) << 4) |
+           ((IntMask)(_intc2 & INTC2_ENABLE_BITS) << 8) |
+           ((IntMask)(_intc3 & INTC3_ENABLE_BITS) << 12);
+}
 
-    #if BASE_TIMER1_ISR
-        _tb1e = BASE_TIMER1_ISR;
-    #endif
+/** @brief Enters a nesting-safe critical section.
+ * @return The global interrupt state before the call.
+ */
+CritState crit_enter(void)
+{
+    CritState state = GLOBAL_INTERRUPT;
 
-    #if PLT_COMPAIR0_ISR
-        _pltc0e = PLT_COMPAIR0_ISR;
-    #endif
+    GLOBAL_INTERRUPT = Disable;
+    return state;
+}
 
-    #if PLT_COMPAIR1_ISR
-        _pltc1e = PLT_COMPAIR1_ISR;
-    #endif
+/** @brief Leaves a critical section, restoring the saved global interrupt state.
+ * @param state The value returned by the matching crit_enter().
+ */
+void crit_exit(CritState state)
+{
+    GLOBAL_INTERRUPT = state;
 }
 
-/** @brief Enables a specific interrupt dynamically.
- * @param interruptAddress The address of the interrupt to be enabled.
+/** @brief Disables selected vectors and reports which of them were enabled.
+ * @param mask The vectors to hold off.
+ * @return The vectors of mask that were enabled.
+ *
+ * Each register is cleared with a single AND so request flags are kept.
  */
-void EnableInterrupt(char interruptAddress)
+IntMask IntMaskSave(IntMask mask)
 {
-    switch (interruptAddress)
-    {
-        #if EXTERNAL_PIN0_ISR
-            case EXTERNAL_PIN0_ISR_ADDRESS:
-                _int0e = InterruptEnable;
-                break;
-        #endif
-
-        #if EXTERNAL_PIN1_ISR
-            case EXTERNAL_PIN1_ISR_ADDRESS:
-                _int1e = InterruptEnable;
-                break;
-        #endif
-
-        #if USIM_ISR
-            case USIM_ISR_ADDRESS:
-                _usime = InterruptEnable;
-                break;
-        #endif
-
-        #if LVD_ISR
-            case LVD_ISR_ADDRESS:
-                _lve = InterruptEnable;
-                break;
-        #endif
-
-        #if ADC_ISR
-            case ADC_ISR_ADDRESS:
-                _ade = InterruptEnable;
-                break;
-        #endif
-
-        #if EEPROM_ISR
-            case EEPROM_ISR_ADDRESS:
-                _dee = InterruptEnable;
-                break;
-        #endif
-
-        #if PTM_COMPAIR_P_ISR
-            case PTM_COMPAIR_P_ISR_ADDRESS:
-                _ptmpe = InterruptEnable;
-                break;
-        #endif
-
-        #if PTM_COMPAIR_A_ISR
-            case PTM_COMPAIR_A_ISR_ADDRESS:
-                _ptmae = InterruptEnable;
-                break;
-        #endif
-
-        #if STM_COMPAIR_P_ISR
-            case STM_COMPAIR_P_ISR_ADDRESS:
-                _stmpe = InterruptEnable;
-                break;
-        #endif
-
-        #if STM_COMPAIR_A_ISR
-            case STM_COMPAIR_A_ISR_ADDRESS:
-                _stmae = InterruptEnable;
-                break;
-        #endif
-
-        #if BASE_TIMER0_ISR
-            case BASE_TIMER0_ISR_ADDRESS:
-                _tb0e = InterruptEnable;
-                break;
-        #endif
-
-        #if BASE_TIMER1_ISR
-            case BASE_TIMER1_ISR_ADDRESS:
-                _tb1e = InterruptEnable;
-                break;
-        #endif
-
-        #if PLT_COMPAIR0_ISR
-            case PLT_COMPAIR0_ISR_ADDRESS:
-                _pltc0e = InterruptEnable;
-                break;
-        #endif
-
-        #if PLT_COMPAIR1_ISR
-            case PLT_COMPAIR1_ISR_ADDRESS:
-                _pltc1e = InterruptEnable;
-                break;
-        #endif
-
-        default:
-            // Handle invalid interrupt type
-            break;
-    }
+    IntMask enabled;
+    unsigned char bits;
+
+    bits = _intc0 & (unsigned char)mask & INTC0_ENABLE_BITS;
+    _intc0 &= ~bits;
+    enabled = bits;
+
+    bits = _intc1 & (unsigned char)(mask >> 4) & INTC1_ENABLE_BITS;
+    _intc1 &= ~bits;
+    enabled |= (IntMask)bits << 4;
+
+    bits = _intc2 & (unsigned char)(mask >> 8) & INTC2_ENABLE_BITS;
+    _intc2 &= ~bits;
+    enabled |= (IntMask)bits << 8;
+
+    bits = _intc3 & (unsigned char)(mask >> 12) & INTC3_ENABLE_BITS;
+    _intc3 &= ~bits;
+    enabled |= (IntMask)bits << 12;
+
+    return enabled;
 }
 
-/** @brief Disables a specific interrupt dynamically.
- * @param interruptAddress The address of the interrupt to be disabled.
+/** @brief Re-enables the vectors disabled by IntMaskSave().
+ * @param saved The value returned by the matching IntMaskSave().
  */
-void DisableInterrupt(char interruptAddress)
+void IntMaskRestore(IntMask saved)
 {
-    switch (interruptAddress)
-    {
-        #if EXTERNAL_PIN0_ISR
-            case EXTERNAL_PIN0_ISR_ADDRESS:
-                _int0e = InterruptDisable;
-                break;
-        #endif
-
-        #if EXTERNAL_PIN1_ISR
-            case EXTERNAL_PIN1_ISR_ADDRESS:
-                _int1e = InterruptDisable;
-                break;
-        #endif
-
-        #if USIM_ISR
-            case USIM_ISR_ADDRESS:
-                _usime = InterruptDisable;
-                break;
-        #endif
-
-        #if LVD_ISR
-            case LVD_ISR_ADDRESS:
-                _lve = InterruptDisable;
-                break;
-        #endif
-
-        #if ADC_ISR
-            case ADC_ISR_ADDRESS:
-                _ade = InterruptDisable;
-                break;
-        #endif
-
-        #if EEPROM_ISR
-            case EEPROM_ISR_ADDRESS:
-                _dee = InterruptDisable;
-                break;
-        #endif
-
-        #if PTM_COMPAIR_P_ISR
-            case PTM_COMPAIR_P_ISR_ADDRESS:
-                _ptmpe = InterruptDisable;
-                break;
-        #endif
-
-        #if PTM_COMPAIR_A_ISR
-            case PTM_COMPAIR_A_ISR_ADDRESS:
-                _ptmae = InterruptDisable;
-                break;
-        #endif
-
-        #if STM_COMPAIR_P_ISR
-            case STM_COMPAIR_P_ISR_ADDRESS:
-                _stmpe = InterruptDisable;
-                break;
-        #endif
-
-        #if STM_COMPAIR_A_ISR
-            case STM_COMPAIR_A_ISR_ADDRESS:
-                _stmae = InterruptDisable;
-                break;
-        #endif
-
-        #if BASE_TIMER0_ISR
-            case BASE_TIMER0_ISR_ADDRESS:
-                _tb0e = InterruptDisable;
-                break;
-        #endif
-
-        #if BASE_TIMER1_ISR
-            case BASE_TIMER1_ISR_ADDRESS:
-                _tb1e = InterruptDisable;
-                break;
-        #endif
-
-        #if PLT_COMPAIR0_ISR
-            case PLT_COMPAIR0_ISR_ADDRESS:
-                _pltc0e = InterruptDisable;
-                break;
-        #endif
-
-        #if PLT_COMPAIR1_ISR
-            case PLT_COMPAIR1_ISR_ADDRESS:
-                _pltc1e = InterruptDisable;
-                break;
-        #endif
-
-        default:
-            // Handle invalid interrupt type
-            break;
-    }
+    _intc0 |= (unsigned char)saved & INTC0_ENABLE_BITS;
+    _intc1 |= (unsigned char)(saved >> 4) & INTC1_ENABLE_BITS;
+    _intc2 |= (unsigned char)(saved >> 8) & INTC2_ENABLE_BITS;
+    _intc3 |= (unsigned char)(saved >> 12) & INTC3_ENABLE_BITS;
 }
 
+#if ISR_DISPATCH_TABLE
+/** @brief Handlers registered at run time, indexed by ISR_VECTOR_INDEX(). */
+static IsrHandler IsrTable[ISR_VECTOR_COUNT];
+
+/** @brief Calls the handler registered for a vector, if any. */
+#define ISR_DISPATCH(address) \
+    do { \
+        if (IsrTable[ISR_VECTOR_INDEX(address)]) IsrTable[ISR_VECTOR_INDEX(address)](); \
+    } while (0)
+
+/** @brief Registers the handler called from an interrupt vector.
+ * @param interruptAddress The address of the interrupt vector.
+ * @param handler The function to call, or 0 to remove the handler.
+ *
+ * The global interrupt is held off while the pointer is written so that the
+ * vector never sees a half-written handler.
+ */
+void InterruptRegister(char interruptAddress, IsrHandler handler)
+{
+    unsigned char index = ISR_VECTOR_INDEX(interruptAddress);
+    CritState state;
+
+    if (index >= ISR_VECTOR_COUNT)
+        return;
+
+    state = crit_enter();
+    IsrTable[index] = handler;
+    crit_exit(state);
+}
+#else
+#define ISR_DISPATCH(address)  do { } while (0)
+#endif
+
+// Handlers known at compile time are called directly from their vector
+#ifdef PLT_COMPAIR0_ISR_HANDLER
+void PLT_COMPAIR0_ISR_HANDLER(void);
+#endif
+#ifdef EXTERNAL_PIN0_ISR_HANDLER
+void EXTERNAL_PIN0_ISR_HANDLER(void);
+#endif
+#ifdef EXTERNAL_PIN1_ISR_HANDLER
+void EXTERNAL_PIN1_ISR_HANDLER(void);
+#endif
+#ifdef USIM_ISR_HANDLER
+void USIM_ISR_HANDLER(void);
+#endif
+#ifdef LVD_ISR_HANDLER
+void LVD_ISR_HANDLER(void);
+#endif
+#ifdef ADC_ISR_HANDLER
+void ADC_ISR_HANDLER(void);
+#endif
+#ifdef EEPROM_ISR_HANDLER
+void EEPROM_ISR_HANDLER(void);
+#endif
+#ifdef PTM_COMPAIR_P_ISR_HANDLER
+void PTM_COMPAIR_P_ISR_HANDLER(void);
+#endif
+#ifdef PTM_COMPAIR_A_ISR_HANDLER
+void PTM_COMPAIR_A_ISR_HANDLER(void);
+#endif
+#ifdef STM_COMPAIR_P_ISR_HANDLER
+void STM_COMPAIR_P_ISR_HANDLER(void);
+#endif
+#ifdef STM_COMPAIR_A_ISR_HANDLER
+void STM_COMPAIR_A_ISR_HANDLER(void);
+#endif
+#ifdef BASE_TIMER0_ISR_HANDLER
+void BASE_TIMER0_ISR_HANDLER(void);
+#endif
+#ifdef BASE_TIMER1_ISR_HANDLER
+void BASE_TIMER1_ISR_HANDLER(void);
+#endif
+#ifdef PLT_COMPAIR1_ISR_HANDLER
+void PLT_COMPAIR1_ISR_HANDLER(void);
+#endif
+
 /** @brief External Pin 0 Interrupt Service Routine.
  * This function handles the interrupt from external pin 0.
  * It is executed when an interrupt is triggered by external pin 0.
@@ -281,7 +273,15 @@ void DisableInterrupt(char interruptAddress)
 #if EXTERNAL_PIN0_ISR
 void __attribute__((interrupt(EXTERNAL_PIN0_ISR_ADDRESS))) ExternalPin0ISR(void)
 {
-    // Here goes the code for External Pin 0 ISR
+    ISR_ENTER(EXTERNAL_PIN0_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #ifdef EXTERNAL_PIN0_ISR_HANDLER
+        EXTERNAL_PIN0_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(EXTERNAL_PIN0_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(EXTERNAL_PIN0_ISR_ADDRESS);
 }
 #endif
 
@@ -292,7 +292,15 @@ void __attribute__((interrupt(EXTERNAL_PIN0_ISR_ADDRESS))) ExternalPin0ISR(void)
 #if EXTERNAL_PIN1_ISR
 void __attribute__((interrupt(EXTERNAL_PIN1_ISR_ADDRESS))) ExternalPin1ISR(void)
 {
-    // Here goes the code for External Pin 1 ISR
+    ISR_ENTER(EXTERNAL_PIN1_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #ifdef EXTERNAL_PIN1_ISR_HANDLER
+        EXTERNAL_PIN1_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(EXTERNAL_PIN1_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(EXTERNAL_PIN1_ISR_ADDRESS);
 }
 #endif
 
@@ -303,7 +311,15 @@ void __attribute__((interrupt(EXTERNAL_PIN1_ISR_ADDRESS))) ExternalPin1ISR(void)
 #if USIM_ISR
 void __attribute__((interrupt(USIM_ISR_ADDRESS))) UniversalSerialInterfaceISR(void)
 {
-    // Here goes the code for Universal Serial Interface ISR
+    ISR_ENTER(USIM_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #ifdef USIM_ISR_HANDLER
+        USIM_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(USIM_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(USIM_ISR_ADDRESS);
 }
 #endif
 
@@ -314,7 +330,34 @@ void __attribute__((interrupt(USIM_ISR_ADDRESS))) UniversalSerialInterfaceISR(vo
 #if LVD_ISR
 void __attribute__((interrupt(LVD_ISR_ADDRESS))) LowVoltageDetectISR(void)
 {
-    // Here goes the code for Low Voltage Detect ISR
+    ISR_ENTER(LVD_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #ifdef LVD_ISR_HANDLER
+        LVD_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(LVD_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(LVD_ISR_ADDRESS);
+}
+#endif
+
+/** @brief Analog to Digital Converter Interrupt Service Routine.
+ * This function handles the interrupt from the Analog to Digital Converter (ADC).
+ * It is executed when an A/D conversion is complete.
+ */
+#if ADC_ISR
+void __attribute__((interrupt(ADC_ISR_ADDRESS))) ADConverterISR(void)
+{
+    ISR_ENTER(ADC_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #ifdef ADC_ISR_HANDLER
+        ADC_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(ADC_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(ADC_ISR_ADDRESS);
 }
 #endif
 
@@ -325,7 +368,15 @@ void __attribute__((interrupt(LVD_ISR_ADDRESS))) LowVoltageDetectISR(void)
 #if EEPROM_ISR
 void __attribute__((interrupt(EEPROM_ISR_ADDRESS))) EEPROMISR(void)
 {
-    // Here goes the code for EEPROM ISR
+    ISR_ENTER(EEPROM_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #ifdef EEPROM_ISR_HANDLER
+        EEPROM_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(EEPROM_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(EEPROM_ISR_ADDRESS);
 }
 #endif
 
@@ -336,7 +387,15 @@ void __attribute__((interrupt(EEPROM_ISR_ADDRESS))) EEPROMISR(void)
 #if PTM_COMPAIR_P_ISR
 void __attribute__((interrupt(PTM_COMPAIR_P_ISR_ADDRESS))) PTMCompairPISR(void)
 {
-    // Here goes the code for PTM Comparator P ISR
+    ISR_ENTER(PTM_COMPAIR_P_ISR_ADDRESS, ISR_LATENCY_PTM_COMPAIR_P);
+
+    #ifdef PTM_COMPAIR_P_ISR_HANDLER
+        PTM_COMPAIR_P_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(PTM_COMPAIR_P_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(PTM_COMPAIR_P_ISR_ADDRESS);
 }
 #endif
 
@@ -347,7 +406,15 @@ void __attribute__((interrupt(PTM_COMPAIR_P_ISR_ADDRESS))) PTMCompairPISR(void)
 #if PTM_COMPAIR_A_ISR
 void __attribute__((interrupt(PTM_COMPAIR_A_ISR_ADDRESS))) PTMCompairAISR(void)
 {
-    // Here goes the code for PTM Comparator A ISR
+    ISR_ENTER(PTM_COMPAIR_A_ISR_ADDRESS, ISR_LATENCY_PTM_COMPAIR_A);
+
+    #ifdef PTM_COMPAIR_A_ISR_HANDLER
+        PTM_COMPAIR_A_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(PTM_COMPAIR_A_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(PTM_COMPAIR_A_ISR_ADDRESS);
 }
 #endif
 
@@ -358,7 +425,19 @@ void __attribute__((interrupt(PTM_COMPAIR_A_ISR_ADDRESS))) PTMCompairAISR(void)
 #if STM_COMPAIR_P_ISR
 void __attribute__((interrupt(STM_COMPAIR_P_ISR_ADDRESS))) STMCompairPISR(void)
 {
-    // Here goes the code for STM Comparator P ISR
+    ISR_ENTER(STM_COMPAIR_P_ISR_ADDRESS, ISR_LATENCY_STM_COMPAIR_P);
+
+    #if PROFILER
+        ProfilerWrapISR();
+    #endif
+
+    #ifdef STM_COMPAIR_P_ISR_HANDLER
+        STM_COMPAIR_P_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(STM_COMPAIR_P_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(STM_COMPAIR_P_ISR_ADDRESS);
 }
 #endif
 
@@ -369,7 +448,15 @@ void __attribute__((interrupt(STM_COMPAIR_P_ISR_ADDRESS))) STMCompairPISR(void)
 #if STM_COMPAIR_A_ISR
 void __attribute__((interrupt(STM_COMPAIR_A_ISR_ADDRESS))) STMCompairAISR(void)
 {
-    // Here goes the code for STM Comparator A ISR
+    ISR_ENTER(STM_COMPAIR_A_ISR_ADDRESS, ISR_LATENCY_STM_COMPAIR_A);
+
+    #ifdef STM_COMPAIR_A_ISR_HANDLER
+        STM_COMPAIR_A_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(STM_COMPAIR_A_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(STM_COMPAIR_A_ISR_ADDRESS);
 }
 #endif
 
@@ -380,7 +467,15 @@ void __attribute__((interrupt(STM_COMPAIR_A_ISR_ADDRESS))) STMCompairAISR(void)
 #if BASE_TIMER0_ISR
 void __attribute__((interrupt(BASE_TIMER0_ISR_ADDRESS))) BaseTimer0ISR(void)
 {
-    // Here goes the code for Base Timer 0 ISR
+    ISR_ENTER(BASE_TIMER0_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #ifdef BASE_TIMER0_ISR_HANDLER
+        BASE_TIMER0_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(BASE_TIMER0_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(BASE_TIMER0_ISR_ADDRESS);
 }
 #endif
 
@@ -391,7 +486,19 @@ void __attribute__((interrupt(BASE_TIMER0_ISR_ADDRESS))) BaseTimer0ISR(void)
 #if BASE_TIMER1_ISR
 void __attribute__((interrupt(BASE_TIMER1_ISR_ADDRESS))) BaseTimer1ISR(void)
 {
-    // Here goes the code for Base Timer 1 ISR
+    ISR_ENTER(BASE_TIMER1_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #if TICKLESS_IDLE
+        IdleTickISR();
+    #endif
+
+    #ifdef BASE_TIMER1_ISR_HANDLER
+        BASE_TIMER1_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(BASE_TIMER1_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(BASE_TIMER1_ISR_ADDRESS);
 }
 #endif
 
@@ -402,7 +509,15 @@ void __attribute__((interrupt(BASE_TIMER1_ISR_ADDRESS))) BaseTimer1ISR(void)
 #if PLT_COMPAIR1_ISR
 void __attribute__((interrupt(PLT_COMPAIR1_ISR_ADDRESS))) PLT1CompairISR(void)
 {
-    // Here goes the code for PLT Comparator 1 ISR
+    ISR_ENTER(PLT_COMPAIR1_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #ifdef PLT_COMPAIR1_ISR_HANDLER
+        PLT_COMPAIR1_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(PLT_COMPAIR1_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(PLT_COMPAIR1_ISR_ADDRESS);
 }
 #endif
 
@@ -413,6 +528,14 @@ void __attribute__((interrupt(PLT_COMPAIR1_ISR_ADDRESS))) PLT1CompairISR(void)
 #if PLT_COMPAIR0_ISR
 void __attribute__((interrupt(PLT_COMPAIR0_ISR_ADDRESS))) PLT0CompairISR(void)
 {
-    // Here goes the code for PLT Comparator 0 ISR
+    ISR_ENTER(PLT_COMPAIR0_ISR_ADDRESS, ISR_LATENCY_NONE);
+
+    #ifdef PLT_COMPAIR0_ISR_HANDLER
+        PLT_COMPAIR0_ISR_HANDLER();
+    #else
+        ISR_DISPATCH(PLT_COMPAIR0_ISR_ADDRESS);
+    #endif
+
+    ISR_EXIT(PLT_COMPAIR0_ISR_ADDRESS);
 }
 #endif
@@ -34,12 +34,14 @@ extern char RXbit;
 #define InterruptDisable      0
 
 // Global interrupt control
+// Writing it switches all vectors on or off regardless of the previous state;
+// sections that may nest use crit_enter()/crit_exit() instead.
 #define GLOBAL_INTERRUPT        _emi
 
 // External interrupt settings
 #define EXTERNAL_PIN0_ISR      Disable
 #define EXTERNAL_PIN1_ISR      Disable
-#define USIM_ISR               Disable
+#define USIM_ISR               Disable  // Enable for UART_SetReceiveHandler(), e.g. for ESP8266
 #define LVD_ISR                Disable
 #define ADC_ISR                Disable
 #define EEPROM_ISR             Disable
@@ -52,6 +54,20 @@ extern char RXbit;
 #define PLT_COMPAIR0_ISR       Enable
 #define PLT_COMPAIR1_ISR       Enable
 
+// Interrupt handler dispatch
+//=========================================================================
+#define ISR_DISPATCH_TABLE     Enable   // Run-time handler registration table
+//=========================================================================
+
+/** @brief Handlers known at compile time
+ * Define XXX_ISR_HANDLER as a function name to have the vector call it directly,
+ * at the cost of a plain function call, instead of looking up the table.
+ */
+// #define BASE_TIMER0_ISR_HANDLER   KeyScanISR
+
+/** @brief Interrupt handler function type. */
+typedef void (*IsrHandler)(void);
+
 /** @brief Function to enable specific interrupts.
  * @param interruptAddress The address of the interrupt to be enabled.
  */
@@ -79,6 +95,100 @@ void DisableInterrupt(char interruptAddress);
 #define BASE_TIMER1_ISR_ADDRESS    0x34 // Priority 12
 #define PLT_COMPAIR1_ISR_ADDRESS   0x38 // Priority 13 (Low)
 
+/** @brief Table index of an interrupt vector address. */
+#define ISR_VECTOR_INDEX(address)  (((address) >> 2) - 1)
+#define ISR_VECTOR_COUNT           14
+
+/** @brief Function to register the handler of an interrupt vector.
+ * Available when ISR_DISPATCH_TABLE is Enable.
+ * @param interruptAddress The address of the interrupt vector.
+ * @param handler The function to call, or 0 to remove the handler.
+ */
+void InterruptRegister(char interruptAddress, IsrHandler handler);
+
+/** @brief Saved global interrupt state returned by crit_enter(). */
+typedef unsigned char CritState;
+
+/** @brief Function to enter a critical section.
+ * Saves the global interrupt state and disables all vectors. Sections nest:
+ * crit_exit() of an inner section leaves interrupts disabled.
+ * @return The state to hand to the matching crit_exit().
+ */
+CritState crit_enter(void);
+
+/** @brief Function to leave a critical section.
+ * @param state The value returned by the matching crit_enter().
+ */
+void crit_exit(CritState state);
+
+/** @brief Set of interrupt vectors, one bit per vector.
+ * Bit n stands for the vector at address 4 * n, so that each INTCn register
+ * takes its enable bits from the mask with a single shift:
+ * INTC0 bits 1~3 = vectors 0x04~0x0C, INTC1 bits 0~3 = vectors 0x10~0x1C,
+ * INTC2 bits 0~3 = vectors 0x20~0x2C, INTC3 bits 0~2 = vectors 0x30~0x38.
+ */
+typedef unsigned int IntMask;
+
+/** @brief Mask bit of an interrupt vector address. */
+#define INT_MASK(address)   ((IntMask)1 << ((address) >> 2))
+
+/** @brief Vectors whose ISR is compiled in, from the settings above. */
+#define ISR_COMPILED_MASK ( \
+    (PLT_COMPAIR0_ISR  ? INT_MASK(PLT_COMPAIR0_ISR_ADDRESS)  : 0) | \
+    (EXTERNAL_PIN0_ISR ? INT_MASK(EXTERNAL_PIN0_ISR_ADDRESS) : 0) | \
+    (EXTERNAL_PIN1_ISR ? INT_MASK(EXTERNAL_PIN1_ISR_ADDRESS) : 0) | \
+    (USIM_ISR          ? INT_MASK(USIM_ISR_ADDRESS)          : 0) | \
+    (LVD_ISR           ? INT_MASK(LVD_ISR_ADDRESS)           : 0) | \
+    (ADC_ISR           ? INT_MASK(ADC_ISR_ADDRESS)           : 0) | \
+    (EEPROM_ISR        ? INT_MASK(EEPROM_ISR_ADDRESS)        : 0) | \
+    (PTM_COMPAIR_P_ISR ? INT_MASK(PTM_COMPAIR_P_ISR_ADDRESS) : 0) | \
+    (PTM_COMPAIR_A_ISR ? INT_MASK(PTM_COMPAIR_A_ISR_ADDRESS) : 0) | \
+    (STM_COMPAIR_P_ISR ? INT_MASK(STM_COMPAIR_P_ISR_ADDRESS) : 0) | \
+    (STM_COMPAIR_A_ISR ? INT_MASK(STM_COMPAIR_A_ISR_ADDRESS) : 0) | \
+    (BASE_TIMER0_ISR   ? INT_MASK(BASE_TIMER0_ISR_ADDRESS)   : 0) | \
+    (BASE_TIMER1_ISR   ? INT_MASK(BASE_TIMER1_ISR_ADDRESS)   : 0) | \
+    (PLT_COMPAIR1_ISR  ? INT_MASK(PLT_COMPAIR1_ISR_ADDRESS)  : 0))
+
+/** @brief Whether the ISR of a vector address is compiled in; usable in #if. */
+#define ISR_ENABLED(address) ( \
+    (address) == PLT_COMPAIR0_ISR_ADDRESS  ? PLT_COMPAIR0_ISR  : \
+    (address) == EXTERNAL_PIN0_ISR_ADDRESS ? EXTERNAL_PIN0_ISR : \
+    (address) == EXTERNAL_PIN1_ISR_ADDRESS ? EXTERNAL_PIN1_ISR : \
+    (address) == USIM_ISR_ADDRESS          ? USIM_ISR          : \
+    (address) == LVD_ISR_ADDRESS           ? LVD_ISR           : \
+    (address) == ADC_ISR_ADDRESS           ? ADC_ISR           : \
+    (address) == EEPROM_ISR_ADDRESS        ? EEPROM_ISR        : \
+    (address) == PTM_COMPAIR_P_ISR_ADDRESS ? PTM_COMPAIR_P_ISR : \
+    (address) == PTM_COMPAIR_A_ISR_ADDRESS ? PTM_COMPAIR_A_ISR : \
+    (address) == STM_COMPAIR_P_ISR_ADDRESS ? STM_COMPAIR_P_ISR : \
+    (address) == STM_COMPAIR_A_ISR_ADDRESS ? STM_COMPAIR_A_ISR : \
+    (address) == BASE_TIMER0_ISR_ADDRESS   ? BASE_TIMER0_ISR   : \
+    (address) == BASE_TIMER1_ISR_ADDRESS   ? BASE_TIMER1_ISR   : \
+    (address) == PLT_COMPAIR1_ISR_ADDRESS  ? PLT_COMPAIR1_ISR  : 0)
+
+/** @brief Function to apply a whole set of enabled vectors, e.g. on a power mode change.
+ * Vectors outside the mask are disabled; vectors whose ISR is compiled out stay disabled.
+ * @param mask The vectors to enable.
+ */
+void Interrupt_SetMask(IntMask mask);
+
+/** @brief Function to read the set of enabled vectors.
+ * @return The enabled vectors.
+ */
+IntMask Interrupt_GetMask(void);
+
+/** @brief Function to disable selected vectors only.
+ * Vectors outside the mask, such as PLT_COMPAIR0, keep running.
+ * @param mask The vectors to hold off.
+ * @return The vectors of mask that were enabled, for IntMaskRestore().
+ */
+IntMask IntMaskSave(IntMask mask);
+
+/** @brief Function to re-enable the vectors disabled by IntMaskSave().
+ * @param saved The value returned by the matching IntMaskSave().
+ */
+void IntMaskRestore(IntMask saved);
+
 /** @brief Function to initialize interrupts. */
 void IntrruptInit(void);
 
@@ -94,6 +204,9 @@ void __attribute__((interrupt(USIM_ISR_ADDRESS))) UniversalSerialInterfaceISR(vo
 /** @brief Low Voltage Detector Interrupt Service Routine. */
 void __attribute__((interrupt(LVD_ISR_ADDRESS))) LowVoltageDetectISR(void);
 
+/** @brief Analog to Digital Converter Interrupt Service Routine. */
+void __attribute__((interrupt(ADC_ISR_ADDRESS))) ADConverterISR(void);
+
 /** @brief EEPROM Interrupt Service Routine. */
 void __attribute__((interrupt(EEPROM_ISR_ADDRESS))) EEPROMISR(void);
 
@@ -0,0 +1,114 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file IsrStats.c
+ * @brief Implementation of interrupt latency and occupancy instrumentation.
+ * Vectors do not nest, so a single entry stamp serves all of them.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "IsrStats.h"
+
+#if ISR_STATS
+
+static IsrVectorStats IsrStats[ISR_VECTOR_COUNT];
+static unsigned int IsrEntryStamp;   // STM counter at entry of the running vector
+static unsigned int IsrLastStamp;    // STM counter when the window was last extended
+static unsigned long IsrWindow;      // Time observed since the last reset
+static unsigned long IsrBusy;        // Time spent in all vectors since the last reset
+
+/** @brief Records the entry of a vector.
+ * @param index The vector index.
+ * @param latency Time between request and service, 0 if unknown.
+ */
+void IsrStatsEnter(unsigned char index, unsigned int latency)
+{
+    IsrEntryStamp = readSTimer();
+    IsrWindow += STM_ELAPSED(IsrLastStamp, IsrEntryStamp);
+    IsrLastStamp = IsrEntryStamp;
+
+    if (latency > IsrStats[index].maxLatency)
+        IsrStats[index].maxLatency = latency;
+}
+
+/** @brief Records the exit of a vector.
+ * @param index The vector index.
+ */
+void IsrStatsExit(unsigned char index)
+{
+    unsigned int duration = STM_ELAPSED(IsrEntryStamp, readSTimer());
+    IsrVectorStats *stats = &IsrStats[index];
+
+    stats->count++;
+    stats->busy += duration;
+    if (duration > stats->maxDuration)
+        stats->maxDuration = duration;
+    IsrBusy += duration;
+}
+
+/** @brief Copies the statistics of one vector with interrupts held off.
+ * @param interruptAddress The vector address.
+ * @param stats Pointer to the record that receives the statistics.
+ */
+void IsrStatsGet(char interruptAddress, IsrVectorStats *stats)
+{
+    CritState state = crit_enter();
+
+    *stats = IsrStats[ISR_VECTOR_INDEX(interruptAddress)];
+    crit_exit(state);
+}
+
+/** @brief Reports the overall interrupt load since the last reset.
+ * @param summary Pointer to the record that receives the summary.
+ */
+void IsrStatsSnapshot(IsrStatsSummary *summary)
+{
+    CritState state = crit_enter();
+    unsigned long window;
+    unsigned long busy;
+    unsigned int now;
+
+    now = readSTimer();
+    IsrWindow += STM_ELAPSED(IsrLastStamp, now);
+    IsrLastStamp = now;
+    window = IsrWindow;
+    busy = IsrBusy;
+    crit_exit(state);
+
+    summary->window = window;
+    summary->busy = busy;
+
+    // Scale down first so that busy * 100 cannot overflow
+    while (window > 0xFFFFFFUL)
+    {
+        window >>= 1;
+        busy >>= 1;
+    }
+    summary->load = window ? (unsigned char)(busy * 100 / window) : 0;
+}
+
+/** @brief Clears all statistics and restarts the window. */
+void IsrStatsReset(void)
+{
+    CritState state = crit_enter();
+    unsigned char i;
+
+    for (i = 0; i < ISR_VECTOR_COUNT; i++)
+    {
+        IsrStats[i].count = 0;
+        IsrStats[i].maxLatency = 0;
+        IsrStats[i].maxDuration = 0;
+        IsrStats[i].busy = 0;
+    }
+    IsrWindow = 0;
+    IsrBusy = 0;
+    IsrLastStamp = readSTimer();
+    crit_exit(state);
+}
+
+#endif // ISR_STATS
@@ -0,0 +1,124 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file IsrStats.h
+ * @brief Header file for interrupt latency and occupancy instrumentation.
+ * Every vector in Interrupt.c opens with ISR_ENTER() and closes with ISR_EXIT().
+ * When ISR_STATS is Enable the hooks timestamp the vector with the free-running
+ * STM counter and record per-vector count, maximum latency, maximum duration
+ * and cumulative busy time; otherwise they compile to nothing.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef ISR_STATS_H
+#define ISR_STATS_H
+
+#include "Interrupt.h"
+
+//=========================================================================
+#define ISR_STATS   Disable  // Enable costs 10 bytes of RAM per vector
+//=========================================================================
+
+/** @brief Statistics of one vector, in STM counter clocks. */
+typedef struct
+{
+    unsigned int  count;        /**< Number of times the vector was serviced */
+    unsigned int  maxLatency;   /**< Longest wait between request and service */
+    unsigned int  maxDuration;  /**< Longest time spent in the vector */
+    unsigned long busy;         /**< Total time spent in the vector */
+} IsrVectorStats;
+
+/** @brief Overall interrupt load since the last reset. */
+typedef struct
+{
+    unsigned long window;  /**< Time observed, in STM counter clocks */
+    unsigned long busy;    /**< Time spent in all vectors */
+    unsigned char load;    /**< busy as a percentage of window */
+} IsrStatsSummary;
+
+#if ISR_STATS
+
+#include "STM.h"
+#include "PTM.h"
+
+#if STM_SELECT_CLEAR_COMPARE_MATCH != STM_COMPARE_MATCH_P
+    #error "ISR_STATS requires STM_SELECT_CLEAR_COMPARE_MATCH = STM_COMPARE_MATCH_P"
+#endif
+
+// The STM P vector itself extends the window at least once per STM period
+#if !STM_COMPAIR_P_ISR
+    #error "ISR_STATS requires STM_COMPAIR_P_ISR = Enable in Interrupt.h"
+#endif
+
+/** @brief Latency sources
+ * A timer that restarts from zero on its compare match holds, at vector entry,
+ * the time since the request. This is known for the STM vectors and for the PTM
+ * vectors when the PTM counts the same clock and clears on comparator P; other
+ * vectors report a latency of 0. Comparator A is read back from the timer, as
+ * drivers such as SevenSeg move it at run time.
+ */
+#define ISR_LATENCY_STM_COMPAIR_P()   readSTimer()
+#define ISR_LATENCY_STM_COMPAIR_A()   \
+    STM_ELAPSED((_stmal | ((unsigned int)(_stmah & 3) << 8)), readSTimer())
+
+#if PTIMER_CLOCK == STIMER_CLOCK && PTM_SELECT_CLEAR_COMPARE_MATCH == PTM_COMPARE_MATCH_P && \
+    PTM_MODE != PTM_CAPTURE_INPUT_MODE
+    #define ISR_LATENCY_PTM_COMPAIR_P()   readPTimer()
+    #define ISR_LATENCY_PTM_COMPAIR_A()   \
+        PTM_ELAPSED((_ptmal | ((unsigned int)(_ptmah & 3) << 8)), readPTimer())
+#else
+    #define ISR_LATENCY_PTM_COMPAIR_P()   0
+    #define ISR_LATENCY_PTM_COMPAIR_A()   0
+#endif
+
+#define ISR_LATENCY_NONE()            0
+
+/** @brief Hook at the start of a vector.
+ * @param address The vector address.
+ * @param latency One of the ISR_LATENCY_xxx sources.
+ */
+#define ISR_ENTER(address, latency)   IsrStatsEnter(ISR_VECTOR_INDEX(address), latency())
+
+/** @brief Hook at the end of a vector.
+ * @param address The vector address.
+ */
+#define ISR_EXIT(address)             IsrStatsExit(ISR_VECTOR_INDEX(address))
+
+/** @brief Records the entry of a vector. Used by ISR_ENTER(). */
+void IsrStatsEnter(unsigned char index, unsigned int latency);
+
+/** @brief Records the exit of a vector. Used by ISR_EXIT(). */
+void IsrStatsExit(unsigned char index);
+
+/** @brief Copies the statistics of one vector with interrupts held off.
+ * @param interruptAddress The vector address.
+ * @param stats Pointer to the record that receives the statistics.
+ */
+void IsrStatsGet(char interruptAddress, IsrVectorStats *stats);
+
+/** @brief Reports the overall interrupt load since the last reset.
+ *
+ * The observed window is extended at every vector entry and at every call,
+ * across at most one STM wrap each time; the STM P vector guarantees an entry
+ * at least once per STM period.
+ *
+ * @param summary Pointer to the record that receives the summary.
+ */
+void IsrStatsSnapshot(IsrStatsSummary *summary);
+
+/** @brief Clears all statistics and restarts the window. */
+void IsrStatsReset(void);
+
+#else
+
+#define ISR_ENTER(address, latency)
+#define ISR_EXIT(address)
+
+#endif // ISR_STATS
+
+#endif // ISR_STATS_H
@@ -0,0 +1,115 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Keypad.c
+ * @brief Implementation of the timer-scanned 4x4 matrix keypad driver.
+ * The row for the next call is driven as soon as the current one is read, so
+ * the lines settle for a whole tick before they are sampled.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "Keypad.h"
+
+#if KEYPAD_TIMER && !ISR_ENABLED(KEYPAD_TIMER)
+    #error "The KEYPAD_TIMER vector must be enabled in Interrupt.h"
+#endif
+
+#if KEYPAD_EVENT_SOURCE >= EVENT_SOURCES
+    #error "KEYPAD_EVENT_SOURCE must be below EVENT_SOURCES"
+#endif
+
+#define KEYPAD_NO_KEY    0xFF
+
+static const unsigned char KeypadMap[16] = KEYPAD_KEYMAP;
+
+static unsigned char KeypadCount[16];      // Debounce counter of each key
+static unsigned int KeypadState;           // Debounced state, one bit per key
+static unsigned char KeypadRow;            // Row driven for the next scan
+static unsigned char KeypadRepeatKey;      // Key held for auto-repeat
+static unsigned char KeypadRepeatScans;    // Scans until its next repeat
+
+/** @brief Drives one row low and releases the others. */
+static void KeypadDriveRow(unsigned char row)
+{
+    KEYPAD_ROW_DIR = (KEYPAD_ROW_DIR | (0x0F << KEYPAD_ROW_SHIFT)) & ~((1 << row) << KEYPAD_ROW_SHIFT);
+}
+
+/** @brief Initializes the matrix pins and the scan and hooks KeypadScan(). */
+void KeypadInit(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < 16; i++)
+        KeypadCount[i] = 0;
+    KeypadState = 0;
+    KeypadRepeatKey = KEYPAD_NO_KEY;
+
+    KEYPAD_COL_DIR |= 0x0F << KEYPAD_COL_SHIFT;
+    KEYPAD_COL_PULLUP |= 0x0F << KEYPAD_COL_SHIFT;
+    KEYPAD_ROW_PORT &= ~(0x0F << KEYPAD_ROW_SHIFT);   // A driven row is low
+    KeypadRow = 0;
+    KeypadDriveRow(0);
+
+    #if KEYPAD_TIMER
+        #if ISR_DISPATCH_TABLE
+            InterruptRegister(KEYPAD_TIMER, KeypadScan);
+        #endif
+        EnableInterrupt(KEYPAD_TIMER);
+    #endif
+}
+
+/** @brief Scans one row and posts the events of its keys. */
+void KeypadScan(void)
+{
+    unsigned char pressed = ~(KEYPAD_COL_PORT >> KEYPAD_COL_SHIFT) & 0x0F;
+    unsigned char key = KeypadRow << 2;
+    unsigned char column;
+    unsigned int bit;
+
+    KeypadRow = (KeypadRow + 1) & 3;
+    KeypadDriveRow(KeypadRow);
+
+    for (column = 0; column < 4; column++, key++, pressed >>= 1)
+    {
+        if (pressed & 1)
+        {
+            if (KeypadCount[key] < KEYPAD_DEBOUNCE)
+                KeypadCount[key]++;
+        }
+        else if (KeypadCount[key])
+        {
+            KeypadCount[key]--;
+        }
+
+        bit = (unsigned int)1 << key;
+        if (!(KeypadState & bit) && KeypadCount[key] == KEYPAD_DEBOUNCE)
+        {
+            KeypadState |= bit;
+            EventPost(KEYPAD_EVENT_SOURCE, KEY_PRESS | KeypadMap[key]);
+            KeypadRepeatKey = key;
+            KeypadRepeatScans = KEYPAD_REPEAT_DELAY;
+        }
+        else if ((KeypadState & bit) && KeypadCount[key] == 0)
+        {
+            KeypadState &= ~bit;
+            EventPost(KEYPAD_EVENT_SOURCE, KEY_RELEASE | KeypadMap[key]);
+            if (KeypadRepeatKey == key)
+                KeypadRepeatKey = KEYPAD_NO_KEY;
+        }
+    }
+
+    // Repeat once per full scan, after the last row
+    if (KeypadRow == 0 && KeypadRepeatKey != KEYPAD_NO_KEY && KEYPAD_REPEAT_DELAY)
+    {
+        if (--KeypadRepeatScans == 0)
+        {
+            EventPost(KEYPAD_EVENT_SOURCE, KEY_REPEAT | KeypadMap[KeypadRepeatKey]);
+            KeypadRepeatScans = KEYPAD_REPEAT_RATE;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Keypad.h
+ * @brief Header file for the timer-scanned 4x4 matrix keypad driver for Holtek MCUs.
+ * KeypadScan() runs from a periodic interrupt and reads one row per call. Each
+ * key has a debounce counter that must reach KEYPAD_DEBOUNCE (or 0) before the
+ * key changes state. Press, release and auto-repeat events go into the
+ * EventQueue, so the main loop picks keys up with EventGet() and never waits.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+#include "Interrupt.h"
+#include "EventQueue.h"
+
+/** @brief Matrix pins
+ * Rows are four bits of one port from KEYPAD_ROW_SHIFT up, driven low one at a
+ * time and left as inputs otherwise; columns are four bits of a port from
+ * KEYPAD_COL_SHIFT up, read with pull-ups. The default takes the whole of port
+ * B, clear of the UART (PA3, PA6) and the DHT11 (PA1). Port A has no four free
+ * bits next to those, so a 4x4 keypad and the 4-bit LCD do not both fit; the
+ * check below stops such a build. KEYPAD_PINS_PA and KEYPAD_PINS_PB list the
+ * pins above as port masks, so keep them in step.
+ */
+//=========================================================================
+#define KEYPAD_ROW_PORT      _pb
+#define KEYPAD_ROW_DIR       _pbc    // Port control, 1 = input
+#define KEYPAD_ROW_SHIFT     0
+#define KEYPAD_COL_PORT      _pb
+#define KEYPAD_COL_DIR       _pbc
+#define KEYPAD_COL_PULLUP    _pbpu
+#define KEYPAD_COL_SHIFT     4
+#define KEYPAD_PINS_PA       0x00
+#define KEYPAD_PINS_PB       ((0x0F << KEYPAD_ROW_SHIFT) | (0x0F << KEYPAD_COL_SHIFT))
+//=========================================================================
+
+#if (KEYPAD_PINS_PA & UART_PINS_PA) || (KEYPAD_PINS_PB & UART_PINS_PB)
+    #error "The keypad pins overlap the UART pins"
+#endif
+#if (KEYPAD_PINS_PA & LCD_PINS_PA) || (KEYPAD_PINS_PB & LCD_PINS_PB)
+    #error "The keypad pins overlap the LCD pins"
+#endif
+#if (KEYPAD_PINS_PA & DHT11_PINS_PA) || (KEYPAD_PINS_PB & DHT11_PINS_PB)
+    #error "The DHT11 pin overlaps the keypad pins"
+#endif
+#if (KEYPAD_PINS_PA & SEG_PINS_PA) || (KEYPAD_PINS_PB & SEG_PINS_PB)
+    #error "The 7-segment pins overlap the keypad pins"
+#endif
+
+/** @brief Scan timing
+ * KeypadScan() is called by the KEYPAD_TIMER vector, e.g. BASE_TIMER0_ISR_ADDRESS,
+ * whose ISR must be enabled in Interrupt.h; with 0, call it from an existing
+ * periodic handler. A key is sampled once per four calls; the debounce and
+ * repeat times below are in such scans.
+ */
+//=========================================================================
+#define KEYPAD_TIMER         0
+#define KEYPAD_DEBOUNCE      3      // Scans of agreement to change state
+#define KEYPAD_REPEAT_DELAY  40     // Scans from press to the first repeat, 0 for none
+#define KEYPAD_REPEAT_RATE   10     // Scans between repeats
+//=========================================================================
+
+/** @brief Key codes by position, row by row.
+ * The default is a hex keypad: 0~9, A~D, * = 0x0F and # = 0x0E.
+ */
+//=========================================================================
+#define KEYPAD_KEYMAP { 0x01, 0x02, 0x03, 0x0A, \
+                        0x04, 0x05, 0x06, 0x0B, \
+                        0x07, 0x08, 0x09, 0x0C, \
+                        0x0F, 0x00, 0x0E, 0x0D }
+//=========================================================================
+
+/** @brief Event source of keypad events, above the interrupt vectors. */
+#define KEYPAD_EVENT_SOURCE  14
+
+/** @brief Event data: key code in the low nibble, event type above it. */
+#define KEY_PRESS            0x10
+#define KEY_RELEASE          0x20
+#define KEY_REPEAT           0x30
+#define KEY_CODE(data)       ((data) & 0x0F)
+#define KEY_TYPE(data)       ((data) & 0x30)
+
+/** @brief Initializes the matrix pins and the scan and hooks KeypadScan(). */
+void KeypadInit(void);
+
+/** @brief Scans one row. Called from the keypad timer vector. */
+void KeypadScan(void);
+
+#endif // KEYPAD_H
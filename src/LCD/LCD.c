@@ -0,0 +1,315 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file LCD.c
+ * @brief Implementation of the non-blocking HD44780 (LCD1602) character LCD driver.
+ * One dirty bit per cell stands in for a shadow copy of the display: writers
+ * store the character first and set the bit second, and the flush clears the
+ * bit before reading the character, so a write racing a flush is at worst
+ * sent twice, never lost.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "LCD.h"
+#include "Format.h"
+
+#define LCD_CELLS           (LCD_COLUMNS * LCD_ROWS)
+
+#if LCD_COLUMNS > 40 || LCD_ROWS > 2
+    #error "LCD supports up to 2 rows of 40 columns"
+#endif
+
+/** @brief Number of ticks covering a wait in us, at least 1. */
+#define LCD_TICKS(us)       (((us) + LCD_TICK_US - 1) / LCD_TICK_US)
+
+// HD44780 commands
+#define LCD_CMD_CLEAR       0x01
+#define LCD_CMD_ENTRY_INC   0x06
+#define LCD_CMD_DISPLAY_OFF 0x08
+#define LCD_CMD_DISPLAY_ON  0x0C
+#define LCD_CMD_DDRAM       0x80
+#define LCD_ROW1_ADDRESS    0x40
+
+#define LCD_NO_CURSOR       0xFF
+
+/** @brief Power-on sequence: byte and wait after it, in ticks.
+ * The first steps are written as a single transfer even in 4-bit mode, since
+ * the module starts in 8-bit mode; busy-flag reads are not valid until the
+ * function set, so the whole sequence is timed.
+ */
+#if LCD_BUS_8BIT
+    #define LCD_INIT_SINGLE  3
+    static const unsigned char LcdInitCode[] = { 0x30, 0x30, 0x30, 0x38, LCD_CMD_DISPLAY_OFF,
+                                                 LCD_CMD_CLEAR, LCD_CMD_ENTRY_INC, LCD_CMD_DISPLAY_ON };
+    static const unsigned int LcdInitWait[] = { LCD_TICKS(4100), LCD_TICKS(100), LCD_TICKS(40),
+                                                LCD_TICKS(40), LCD_TICKS(40), LCD_TICKS(1640),
+                                                LCD_TICKS(40), LCD_TICKS(40) };
+#else
+    #define LCD_INIT_SINGLE  4
+    static const unsigned char LcdInitCode[] = { 0x30, 0x30, 0x30, 0x20, 0x28, LCD_CMD_DISPLAY_OFF,
+                                                 LCD_CMD_CLEAR, LCD_CMD_ENTRY_INC, LCD_CMD_DISPLAY_ON };
+    static const unsigned int LcdInitWait[] = { LCD_TICKS(4100), LCD_TICKS(100), LCD_TICKS(40),
+                                                LCD_TICKS(40), LCD_TICKS(40), LCD_TICKS(40),
+                                                LCD_TICKS(1640), LCD_TICKS(40), LCD_TICKS(40) };
+#endif
+#define LCD_INIT_STEPS      (sizeof(LcdInitCode))
+
+static char LcdFrame[LCD_CELLS];                          // Characters to show
+static volatile unsigned char LcdDirty[(LCD_CELLS + 7) / 8];  // Cells not yet sent
+static volatile unsigned char LcdPending;                 // Some dirty bit may be set
+static unsigned char LcdCursor;                           // Cell at the module's address counter
+static unsigned int LcdWait;                              // Ticks before the next byte
+static unsigned char LcdInitStep;                         // Next power-on step
+static unsigned char LcdPrintColumn;                      // Next cell of LCD_Printf()
+static unsigned char LcdPrintRow;
+
+/** @brief Writes one transfer to the bus with RS and RW already set. */
+static void LcdBusWrite(unsigned char value)
+{
+    #if LCD_BUS_8BIT
+        LCD_DATA_PORT = value;
+    #else
+        LCD_DATA_PORT = (LCD_DATA_PORT & ~(0x0F << LCD_DATA_SHIFT)) | ((value >> 4) << LCD_DATA_SHIFT);
+    #endif
+    LCD_E = 1;
+    LCD_E = 0;
+}
+
+/** @brief Writes a command or data byte. */
+static void LcdWrite(unsigned char value, unsigned char rs)
+{
+    LCD_RS = rs;
+    LcdBusWrite(value);
+    #if !LCD_BUS_8BIT
+        LcdBusWrite(value << 4);
+    #endif
+}
+
+#if LCD_BUSY_FLAG
+/** @brief Reads the busy flag. */
+static char LcdBusy(void)
+{
+    unsigned char status;
+
+    #if LCD_BUS_8BIT
+        LCD_DATA_DIR = 0xFF;
+    #else
+        LCD_DATA_DIR |= 0x0F << LCD_DATA_SHIFT;
+    #endif
+    LCD_RS = 0;
+    LCD_RW = 1;
+    LCD_E = 1;
+    status = LCD_DATA_PORT;
+    LCD_E = 0;
+    #if !LCD_BUS_8BIT
+        status = (status >> LCD_DATA_SHIFT) << 4;   // D7 of the high nibble
+        LCD_E = 1;                                  // Clock out the low nibble
+        LCD_E = 0;
+    #endif
+    LCD_RW = 0;
+    #if LCD_BUS_8BIT
+        LCD_DATA_DIR = 0x00;
+    #else
+        LCD_DATA_DIR &= ~(0x0F << LCD_DATA_SHIFT);
+    #endif
+
+    return (status & 0x80) != 0;
+}
+#endif
+
+/** @brief Initializes the pins and starts the power-on sequence. */
+void LCD_Init(void)
+{
+    unsigned char i;
+
+    LCD_RS = 0;
+    LCD_RW = 0;
+    LCD_E = 0;
+    LCD_RS_DIR = 0;
+    LCD_RW_DIR = 0;
+    LCD_E_DIR = 0;
+    #if LCD_BUS_8BIT
+        LCD_DATA_DIR = 0x00;
+    #else
+        LCD_DATA_DIR &= ~(0x0F << LCD_DATA_SHIFT);
+    #endif
+
+    // The clear command blanks the module, so only non-blank cells are sent
+    for (i = 0; i < LCD_CELLS; i++)
+        LcdFrame[i] = ' ';
+    for (i = 0; i < sizeof(LcdDirty); i++)
+        LcdDirty[i] = 0;
+    LcdPending = 0;
+    LcdCursor = LCD_NO_CURSOR;
+    LcdInitStep = 0;
+    LcdWait = LCD_TICKS(15000);   // Supply rise to the first command
+}
+
+/** @brief Writes a character into the framebuffer, dropping it off the screen.
+ * @param column Column, 0 to LCD_COLUMNS - 1.
+ * @param row Row, 0 to LCD_ROWS - 1.
+ * @param c The character.
+ */
+void LCD_PutChar(unsigned char column, unsigned char row, char c)
+{
+    unsigned char cell;
+
+    if (column >= LCD_COLUMNS || row >= LCD_ROWS)
+        return;
+
+    cell = row * LCD_COLUMNS + column;
+    if (LcdFrame[cell] == c)
+        return;
+
+    LcdFrame[cell] = c;
+    LcdDirty[cell >> 3] |= (unsigned char)(1 << (cell & 7));
+    LcdPending = 1;
+}
+
+/** @brief Writes a string into the framebuffer, clipped at the end of the row.
+ * @param column Column of the first character.
+ * @param row Row, 0 to LCD_ROWS - 1.
+ * @param s The string.
+ */
+void LCD_PutString(unsigned char column, unsigned char row, const char *s)
+{
+    while (*s && column < LCD_COLUMNS)
+        LCD_PutChar(column++, row, *s++);
+}
+
+/** @brief Writes a character of LCD_Printf() at its cursor, dropping it past the row. */
+static void LcdPrintChar(char c)
+{
+    if (LcdPrintColumn < LCD_COLUMNS)
+        LCD_PutChar(LcdPrintColumn++, LcdPrintRow, c);
+}
+
+/** @brief Writes formatted text into the framebuffer, clipped at the end of the row.
+ * @param column Column of the first character.
+ * @param row Row, 0 to LCD_ROWS - 1.
+ * @param format The format string, followed by its arguments.
+ */
+void LCD_Printf(unsigned char column, unsigned char row, const char *format, ...)
+{
+    va_list args;
+
+    LcdPrintColumn = column;
+    LcdPrintRow = row;
+    va_start(args, format);
+    FormatV(LcdPrintChar, format, args);
+    va_end(args);
+}
+
+/** @brief Fills the framebuffer with spaces. */
+void LCD_Clear(void)
+{
+    unsigned char row;
+    unsigned char column;
+
+    for (row = 0; row < LCD_ROWS; row++)
+        for (column = 0; column < LCD_COLUMNS; column++)
+            LCD_PutChar(column, row, ' ');
+}
+
+/** @brief Finds the next dirty cell, starting at the cursor.
+ * @return The cell, or LCD_NO_CURSOR if none is dirty.
+ */
+static unsigned char LcdNextDirty(void)
+{
+    unsigned char cell = (LcdCursor < LCD_CELLS) ? LcdCursor : 0;
+    unsigned char n;
+
+    for (n = 0; n < LCD_CELLS; n++)
+    {
+        if (LcdDirty[cell >> 3] & (1 << (cell & 7)))
+            return cell;
+        if (++cell == LCD_CELLS)
+            cell = 0;
+    }
+    return LCD_NO_CURSOR;
+}
+
+/** @brief Sends the next command or cell.
+ * @return 1 if a byte was sent, 0 if there was nothing to send.
+ */
+static char LcdSendNext(void)
+{
+    unsigned char cell;
+
+    if (!LcdPending)
+        return 0;
+
+    cell = LcdNextDirty();
+    if (cell == LCD_NO_CURSOR)
+    {
+        LcdPending = 0;
+        // A cell marked after the scan passed it must not be stranded
+        if (LcdNextDirty() != LCD_NO_CURSOR)
+            LcdPending = 1;
+        return 0;
+    }
+
+    if (cell != LcdCursor)
+    {
+        LcdWrite(LCD_CMD_DDRAM | (cell >= LCD_COLUMNS ? LCD_ROW1_ADDRESS + cell - LCD_COLUMNS : cell), 0);
+        LcdCursor = cell;
+        return 1;
+    }
+
+    LcdDirty[cell >> 3] &= (unsigned char)~(1 << (cell & 7));
+    LcdWrite(LcdFrame[cell], 1);
+
+    // The address counter runs on within the row but not into the next one
+    LcdCursor = (cell + 1 == LCD_COLUMNS || cell + 1 == LCD_CELLS) ? LCD_NO_CURSOR : cell + 1;
+    return 1;
+}
+
+/** @brief Sends pending work to the module, called once per LCD_TICK_US. */
+void LCD_Flush(void)
+{
+    #if LCD_BUSY_FLAG
+        unsigned char budget;
+    #endif
+
+    if (LcdWait)
+    {
+        LcdWait--;
+        return;
+    }
+
+    if (LcdInitStep < LCD_INIT_STEPS)
+    {
+        LCD_RS = 0;
+        if (LcdInitStep < LCD_INIT_SINGLE)
+            LcdBusWrite(LcdInitCode[LcdInitStep]);
+        else
+            LcdWrite(LcdInitCode[LcdInitStep], 0);
+        // The next call is already one tick away
+        LcdWait = LcdInitWait[LcdInitStep] - 1;
+        LcdInitStep++;
+        return;
+    }
+
+    #if LCD_BUSY_FLAG
+        for (budget = LCD_FLUSH_BYTES; budget; budget--)
+        {
+            if (LcdBusy() || !LcdSendNext())
+                return;
+        }
+    #else
+        LcdSendNext();
+    #endif
+}
+
+/** @brief Reports whether the module shows the whole framebuffer.
+ * @return 1 when nothing is left to send, otherwise 0.
+ */
+char LCD_Idle(void)
+{
+    return LcdInitStep == LCD_INIT_STEPS && !LcdPending;
+}
@@ -0,0 +1,121 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file LCD.h
+ * @brief Header file for the non-blocking HD44780 (LCD1602) character LCD driver for Holtek MCUs.
+ * The application writes characters into a RAM framebuffer, which only marks
+ * the cells that changed. LCD_Flush(), called once per scheduler tick, sends
+ * the marked cells to the module a few bytes at a time, pacing itself on the
+ * busy flag or on the tick period, so no caller ever waits on the display.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef LCD_H
+#define LCD_H
+
+#include "BA45F5240.h"  // Include the microcontroller-specific header file
+
+#define Enable 1
+#define Disable 0
+
+/** @brief Display size */
+#define LCD_COLUMNS         16
+#define LCD_ROWS            2
+
+/** @brief Bus pins
+ * In 4-bit mode D7~D4 are the four port bits from LCD_DATA_SHIFT up; in 8-bit
+ * mode D7~D0 are the whole port. The pins must be left as I/O in the pin-share
+ * registers. The defaults keep clear of the UART (PA3, PA6 or PB3).
+ * LCD_PINS_PA and LCD_PINS_PB list the same pins as port masks for the overlap
+ * checks against the other drivers, so keep them in step with the pins above.
+ */
+//=========================================================================
+#define LCD_BUS_8BIT        Disable
+#define LCD_DATA_PORT       _pb
+#define LCD_DATA_DIR        _pbc   // Port control, 1 = input
+#define LCD_DATA_SHIFT      4
+#define LCD_RS              _pa0
+#define LCD_RS_DIR          _pac0
+#define LCD_RW              _pa4
+#define LCD_RW_DIR          _pac4
+#define LCD_E               _pa5
+#define LCD_E_DIR           _pac5
+#define LCD_PINS_PA         0x31   // RS, RW, E
+#define LCD_PINS_PB         (LCD_BUS_8BIT ? 0xFF : 0x0F << LCD_DATA_SHIFT)
+//=========================================================================
+
+#if (LCD_PINS_PA & UART_PINS_PA) || (LCD_PINS_PB & UART_PINS_PB)
+    #error "The LCD pins overlap the UART pins"
+#endif
+#if (LCD_PINS_PA & KEYPAD_PINS_PA) || (LCD_PINS_PB & KEYPAD_PINS_PB)
+    #error "The keypad pins overlap the LCD pins"
+#endif
+#if (LCD_PINS_PA & DHT11_PINS_PA) || (LCD_PINS_PB & DHT11_PINS_PB)
+    #error "The DHT11 pin overlaps the LCD pins"
+#endif
+#if (LCD_PINS_PA & SEG_PINS_PA) || (LCD_PINS_PB & SEG_PINS_PB)
+    #error "The 7-segment pins overlap the LCD pins"
+#endif
+
+/** @brief Pacing
+ * LCD_TICK_US is the period of the LCD_Flush() calls. With LCD_BUSY_FLAG the
+ * flush sends up to LCD_FLUSH_BYTES per tick while the module is ready;
+ * without it (RW tied low) one byte per tick, so the tick must be at least
+ * 50 us, and longer commands wait whole ticks.
+ */
+//=========================================================================
+#define LCD_TICK_US         1000
+#define LCD_BUSY_FLAG       Enable
+#define LCD_FLUSH_BYTES     4
+//=========================================================================
+
+/** @brief Initializes the pins and starts the power-on sequence.
+ * The sequence itself runs from LCD_Flush(); the framebuffer can be written
+ * at once and shows up when it completes.
+ */
+void LCD_Init(void);
+
+/** @brief Writes a character into the framebuffer, dropping it off the screen.
+ * @param column Column, 0 to LCD_COLUMNS - 1.
+ * @param row Row, 0 to LCD_ROWS - 1.
+ * @param c The character.
+ */
+void LCD_PutChar(unsigned char column, unsigned char row, char c);
+
+/** @brief Writes a string into the framebuffer, clipped at the end of the row.
+ * @param column Column of the first character.
+ * @param row Row, 0 to LCD_ROWS - 1.
+ * @param s The string.
+ */
+void LCD_PutString(unsigned char column, unsigned char row, const char *s);
+
+/** @brief Writes formatted text into the framebuffer, clipped at the end of the row.
+ * Characters go straight into the framebuffer as Format() produces them, and
+ * like any other write only the cells that change are sent; see Format.h for
+ * the conversions, e.g. LCD_Printf(0, 0, "temp: %02uC", t).
+ * Not for use from an interrupt while the main loop also calls it.
+ * @param column Column of the first character.
+ * @param row Row, 0 to LCD_ROWS - 1.
+ * @param format The format string, followed by its arguments.
+ */
+void LCD_Printf(unsigned char column, unsigned char row, const char *format, ...);
+
+/** @brief Fills the framebuffer with spaces. Only cells that were not blank are sent. */
+void LCD_Clear(void);
+
+/** @brief Sends pending work to the module, called once per LCD_TICK_US.
+ * Safe to call from a timer interrupt while the main loop writes the framebuffer.
+ */
+void LCD_Flush(void);
+
+/** @brief Reports whether the module shows the whole framebuffer.
+ * @return 1 when nothing is left to send, otherwise 0.
+ */
+char LCD_Idle(void);
+
+#endif // LCD_H
@@ -69,3 +69,42 @@ float temperature(int ADCValue, float VDD) {
     // Return the temperature in degrees Celsius.
     return temperatureCelsius;
 }
+
+#ifdef NTC_FIXED_POINT
+/**
+ * Steinhart-Hart coefficients scaled by 2^12 so that B and C keep their digits
+ * in Q16.16, with 2^8 more for C, which the result of its product gives back.
+ */
+#define NTC_FIXED_SCALE  4096
+#define NTC_FIXED_A      FIXED_CONST(A * NTC_FIXED_SCALE)
+#define NTC_FIXED_B      FIXED_CONST(B * NTC_FIXED_SCALE)
+#define NTC_FIXED_C      FIXED_CONST(C * NTC_FIXED_SCALE * 256)
+
+Q16_16 temperatureFixed(int ADCValue) {
+    // A rail reading, an open or shorted sensor, would take ln(0): read it as
+    // the last step before the rail.
+    if (ADCValue < 1)
+        ADCValue = 1;
+    else if (ADCValue > ADCNumerOfbits - 1)
+        ADCValue = ADCNumerOfbits - 1;
+
+    // ln(RNTC) from the divider ratio as a difference of logarithms, so neither
+    // end of the ADC range leaves Q16.16; VDD cancels out of the ratio.
+#ifdef NTC_IS_PULLUP
+    Q16_16 logResistance = FixedLn(FIXED_FROM_INT(ADCValue)) - FixedLn(FIXED_FROM_INT(ADCNumerOfbits - ADCValue));
+#else
+    Q16_16 logResistance = FixedLn(FIXED_FROM_INT(ADCNumerOfbits - ADCValue)) - FixedLn(FIXED_FROM_INT(ADCValue));
+#endif
+    logResistance += FixedLn(FIXED_FROM_INT(RES_CONNECTED_TO_NTC));
+
+    Q16_16 logCubed = FixedMul(FixedMul(logResistance, logResistance), logResistance);
+
+    // (A + B * ln(R) + C * ln(R)^3) * 2^12, then 1 / that * 2^12 in Kelvin.
+    Q16_16 inverse = NTC_FIXED_A + FixedMul(NTC_FIXED_B, logResistance) + (FixedMul(NTC_FIXED_C, logCubed) >> 8);
+    if (inverse <= 0)
+        return FIXED_MAX;   // Past the hot end of the curve
+    Q16_16 kelvin = FixedDiv(FIXED_FROM_INT(NTC_FIXED_SCALE), inverse);
+
+    return FixedSub(kelvin, FIXED_CONST(273.15));
+}
+#endif
@@ -32,6 +32,13 @@
     #define LOG_FUNCTION custom_log
 #endif
 
+// Comment out the following line to leave out temperatureFixed(), which needs FixedPoint
+#define NTC_FIXED_POINT
+
+#ifdef NTC_FIXED_POINT
+    #include "FixedPoint.h"
+#endif
+
 #define ADC_12bit  4095
 #define ADC_10bit  1023
 #define ADC_8bit   255
@@ -94,7 +101,6 @@
 /**
  * @brief Steinhart-Hart coefficients for temperature calculation.
  */	
-/*
 /*  3 point from your ntc in different temperatures , you can use from
   https://www.thinksrs.com/downloads/programs/therm%20calc/ntccalibrator/ntccalculator.html
   T1=-30^C   R1=154882kR
@@ -121,4 +127,18 @@
  */
 float temperature(int ADCValue, float VDD);
 
+#ifdef NTC_FIXED_POINT
+/**
+ * @brief Calculate the temperature in Celsius from an ADC value without floating point.
+ *
+ * Same Steinhart-Hart equation as temperature() in Q16.16. The supply voltage
+ * cancels out of the divider ratio, so only the ADC value is needed.
+ *
+ * @param ADCValue The ADC value corresponding to the voltage across the NTC; 0 and full scale
+ *                 read as the steps next to them.
+ * @return The calculated temperature in Celsius, Q16.16, FIXED_MAX past the hot end of the curve.
+ */
+Q16_16 temperatureFixed(int ADCValue);
+#endif
+
 #endif /* NTC_H */
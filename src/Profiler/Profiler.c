@@ -0,0 +1,106 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Profiler.c
+ * @brief Implementation of the section-level cycle profiler.
+ * This file accumulates the durations measured by PROF_BEGIN/PROF_END and
+ * transmits the resulting table over UART.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "Profiler.h"
+
+#if PROFILER
+
+#include "UART.h"
+
+#define PROF_STM_P_FLAG   0x40   // INTC2 STMPF, STM comparator P request
+
+ProfSection ProfTable[PROF_SECTIONS];
+unsigned long ProfStart[PROF_SECTIONS];
+
+static volatile unsigned int ProfWraps;   // STM periods counted by the vector
+
+/** @brief Counts one STM period. */
+void ProfilerWrapISR(void)
+{
+    ProfWraps++;
+}
+
+/** @brief Reads the STM counter extended by the periods counted so far.
+ *
+ * A comparator P request seen before the counter is read is a wrap the
+ * vector has not taken yet. The read is repeated if the vector runs or a
+ * request comes in meanwhile, since the counter may then be from either side
+ * of the wrap.
+ */
+unsigned long ProfilerNow(void)
+{
+    unsigned int wraps;
+    unsigned int count;
+    unsigned char pending;
+
+    do
+    {
+        wraps = ProfWraps;
+        pending = _intc2 & PROF_STM_P_FLAG;
+        count = readSTimer();
+    } while (wraps != ProfWraps || pending != (_intc2 & PROF_STM_P_FLAG));
+
+    if (pending)
+        wraps++;
+    return (unsigned long)(wraps & 0xFFFF) * STM_P_PERIOD_CLOCKS + count;
+}
+
+/** @brief Accumulates one run of a section.
+ * @param id The section identifier.
+ * @param stop The ProfilerNow() value at the end of the section.
+ */
+void ProfilerRecord(unsigned char id, unsigned long stop)
+{
+    ProfSection *section = &ProfTable[id];
+    unsigned long ticks = stop - ProfStart[id];
+
+    if (stop < ProfStart[id])
+        ticks += PROF_RANGE;   // Across the wrap of the period count
+
+    if (section->count == 0 || ticks < section->min)
+        section->min = ticks;
+    if (ticks > section->max)
+        section->max = ticks;
+    section->total += ticks;
+    section->count++;
+}
+
+/** @brief Clears all accumulated statistics. */
+void ProfilerReset(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < PROF_SECTIONS; i++)
+    {
+        ProfTable[i].min = 0;
+        ProfTable[i].max = 0;
+        ProfTable[i].total = 0;
+        ProfTable[i].count = 0;
+    }
+}
+
+/** @brief Sends the profiling table over UART, one section per line. */
+void ProfilerDump(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < PROF_SECTIONS; i++)
+    {
+        UART_Printf("%u %u %lu %lu %lu\r\n", i, ProfTable[i].count, ProfTable[i].min,
+                    ProfTable[i].max, ProfTable[i].total);
+    }
+}
+
+#endif // PROFILER
@@ -0,0 +1,122 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Profiler.h
+ * @brief Header file for the section-level cycle profiler for Holtek MCUs.
+ * Code sections are wrapped in PROF_BEGIN(id)/PROF_END(id); each pair samples the
+ * STM counter, extended by the STM periods counted in the comparator P vector,
+ * and accumulates min, max, total and count for that section.
+ * When PROFILER is Disable the macros compile to nothing.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Macros for enabling and disabling features
+#define Enable  1
+#define Disable 0
+
+//=========================================================================
+#define PROFILER        Disable  // Enable to compile in the profiler
+//=========================================================================
+
+/** @brief Number of sections in the profiling table.
+ * Each section costs 14 bytes of RAM for statistics plus 4 bytes for its start stamp.
+ */
+#define PROF_SECTIONS   4
+
+/** @brief Section identifiers
+ * Example identifiers for the sections usually measured; any value below
+ * PROF_SECTIONS can be used.
+ */
+#define PROF_ID_TEMPERATURE   0 // temperature()
+#define PROF_ID_UART_INIT     1 // UART_Init()
+#define PROF_ID_MAIN_LOOP     2 // Main loop body
+#define PROF_ID_USER          3 // Free for the application
+
+/** @brief Statistics of one profiled section, in STM counter clocks. */
+typedef struct
+{
+    unsigned long min;    /**< Shortest measured run */
+    unsigned long max;    /**< Longest measured run */
+    unsigned long total;  /**< Sum of all runs */
+    unsigned int  count;  /**< Number of runs */
+} ProfSection;
+
+#if PROFILER
+
+#include "STM.h"
+#include "Interrupt.h"
+
+/** @brief The STM must run free, cleared on comparator P, to be used as a time base,
+ * and its comparator P vector must run to count the periods.
+ */
+#if STM_SELECT_CLEAR_COMPARE_MATCH != STM_COMPARE_MATCH_P
+    #error "PROFILER requires STM_SELECT_CLEAR_COMPARE_MATCH = STM_COMPARE_MATCH_P"
+#endif
+#if !STM_COMPAIR_P_ISR
+    #error "PROFILER requires STM_COMPAIR_P_ISR = Enable in Interrupt.h"
+#endif
+
+/** @brief Longest section, in STM counter clocks.
+ * The period count is 16 bits, so a section may span 65535 STM periods:
+ * with the default fSYS clock and 1024-clock period, about 16.7 s at 4 MHz.
+ */
+#define PROF_RANGE       (65536UL * STM_P_PERIOD_CLOCKS)
+
+extern ProfSection ProfTable[PROF_SECTIONS];    /**< @brief Accumulated statistics */
+extern unsigned long ProfStart[PROF_SECTIONS];  /**< @brief Start stamps of open sections */
+
+/** @brief Marks the start of section id. */
+#define PROF_BEGIN(id)   (ProfStart[(id)] = ProfilerNow())
+
+/** @brief Marks the end of section id and accumulates its duration. */
+#define PROF_END(id)     ProfilerRecord((id), ProfilerNow())
+
+/** @brief Counts one STM period. Called from the STM comparator P vector. */
+void ProfilerWrapISR(void);
+
+/** @brief Reads the STM counter extended by the periods counted so far.
+ * A wrap whose vector is still pending, e.g. inside a critical section, is
+ * counted from the request flag, so interrupts may be held off for up to one
+ * STM period.
+ * @return The time stamp in STM counter clocks, modulo PROF_RANGE.
+ */
+unsigned long ProfilerNow(void);
+
+/** @brief Accumulates one run of a section.
+ *
+ * The run length is the distance between the start stamp and stop, modulo
+ * PROF_RANGE, so a section must be shorter than PROF_RANGE clocks.
+ *
+ * @param id The section identifier.
+ * @param stop The ProfilerNow() value at the end of the section.
+ */
+void ProfilerRecord(unsigned char id, unsigned long stop);
+
+/** @brief Clears all accumulated statistics. */
+void ProfilerReset(void);
+
+/** @brief Sends the profiling table over UART.
+ *
+ * One line per section is transmitted as "id count min max total", values
+ * in STM clocks. UART must be initialized before calling this function.
+ */
+void ProfilerDump(void);
+
+#else
+
+#define PROF_BEGIN(id)   ((void)0)
+#define PROF_END(id)     ((void)0)
+#define ProfilerReset()  ((void)0)
+#define ProfilerDump()   ((void)0)
+
+#endif // PROFILER
+
+#endif // PROFILER_H
@@ -0,0 +1,115 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file RCC.c
+ * @brief Implementation of run-time system clock switching.
+ * The CPU never runs from the HIRC while its frequency changes: fSYS moves to
+ * fSUB first, the HIRC is set up and waited for, and only then is the new
+ * divider selected.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "RCC.h"
+#include "Interrupt.h"
+#include <BA45F5240.h>
+
+#define RCC_HIRCC_MASK     0x0D   // HIRC1~HIRC0 and HIRCEN, without HIRCF
+#define RCC_CKS_SHIFT      5
+
+/** @brief Settings of each mode */
+static const unsigned char RccHirc[RCC_MODES] = { RCC_HIGH_HIRC, RCC_LOW_HIRC, RCC_SUB_HIRC };
+static const unsigned char RccClock[RCC_MODES] = { RCC_FH, RCC_LOW_CLOCK, RCC_FSUB };
+
+static unsigned char RccCurrent;
+static RccRetime RccRetimes[RCC_RETIME_SLOTS];
+
+/** @brief Selects fSYS, running from fSUB while the HIRC changes. */
+static void RccSelect(unsigned char hirc, unsigned char clock)
+{
+    unsigned char hircc = (hirc == RCC_HIRC_OFF) ? 0 : (unsigned char)((hirc << 2) | 0x01);
+    unsigned char scc = _scc & ~(7 << RCC_CKS_SHIFT);
+
+    if ((_hircc & RCC_HIRCC_MASK) != hircc)
+    {
+        _scc = scc | (RCC_FSUB << RCC_CKS_SHIFT);
+        _hircc = hircc;
+        if (hircc)
+        {
+            while (!_hircf)
+                ;
+        }
+    }
+    _scc = scc | (unsigned char)(clock << RCC_CKS_SHIFT);
+}
+
+/** @brief Selects the high-speed mode, the clock after reset. */
+void RccInit(void)
+{
+    RccSelect(RCC_HIGH_HIRC, RCC_FH);
+    RccCurrent = RCC_HIGH_SPEED;
+}
+
+/** @brief Switches the system clock and retimes the registered peripherals.
+ * @param mode RCC_HIGH_SPEED, RCC_LOW_SPEED or RCC_SUB_SPEED.
+ */
+void RccSwitch(unsigned char mode)
+{
+    CritState state;
+    unsigned char i;
+
+    if (mode >= RCC_MODES)
+        return;
+
+    state = crit_enter();
+    RccSelect(RccHirc[mode], RccClock[mode]);
+    RccCurrent = mode;
+    for (i = 0; i < RCC_RETIME_SLOTS && RccRetimes[i]; i++)
+        RccRetimes[i]();
+    crit_exit(state);
+}
+
+/** @brief The current mode. */
+unsigned char RccMode(void)
+{
+    return RccCurrent;
+}
+
+/** @brief fSYS of a mode in Hz. */
+unsigned long RccSystemHz(unsigned char mode)
+{
+    if (RccClock[mode] == RCC_FSUB)
+        return F_SUB;
+    return RCC_HIRC_HZ(RccHirc[mode]) >> RccClock[mode];
+}
+
+/** @brief fH of a mode in Hz, 0 when the HIRC is off. */
+unsigned long RccHighHz(unsigned char mode)
+{
+    return RCC_HIRC_HZ(RccHirc[mode]);
+}
+
+/** @brief Adds a peripheral to be retimed after each switch.
+ * @param retime The function.
+ * @return 1 if it is registered, 0 if all RCC_RETIME_SLOTS are taken.
+ */
+char RccRegister(RccRetime retime)
+{
+    unsigned char i;
+
+    for (i = 0; i < RCC_RETIME_SLOTS; i++)
+    {
+        if (RccRetimes[i] == retime)
+            return 1;
+        if (!RccRetimes[i])
+        {
+            RccRetimes[i] = retime;
+            return 1;
+        }
+    }
+    return 0;
+}
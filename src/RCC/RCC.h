@@ -0,0 +1,115 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file RCC.h
+ * @brief Header file for run-time system clock switching on Holtek MCUs.
+ * The device runs in one of three modes set up below: high speed, where
+ * fSYS = fH = F_CPU as every module is configured at compile time; low speed,
+ * with fSYS divided down from fH; and fSUB. RccSwitch() changes the HIRC and
+ * the SCC clock selection in a safe order and then calls the retime function
+ * of each registered peripheral.
+ *
+ * With RCC_RETIME, the UART, PTM, STM and Time Base init functions register
+ * themselves. Each one works out its divisors for all three modes when it is
+ * initialized, at full speed. A switch then only writes registers, so
+ * switching to fSUB costs no division at 32 kHz. Timers are retimed when
+ * their *_TARGET_PERIOD_US is defined.
+ *
+ * Timing fixed in counts at compile time, such as the DHT11 pulse widths
+ * and the LCD pacing, holds in the high-speed mode only.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef RCC_H
+#define RCC_H
+
+#define Enable  1
+#define Disable 0
+
+/** @brief HIRC frequencies, HIRCC HIRC1~HIRC0 */
+#define RCC_HIRC_2MHZ      0
+#define RCC_HIRC_4MHZ      1
+#define RCC_HIRC_8MHZ      2
+#define RCC_HIRC_OFF       0xFF
+
+/** @brief System clock selections, SCC CKS2~CKS0: fH / 2^n or fSUB */
+#define RCC_FH             0
+#define RCC_FH_DIVIDE_2    1
+#define RCC_FH_DIVIDE_4    2
+#define RCC_FH_DIVIDE_8    3
+#define RCC_FH_DIVIDE_16   4
+#define RCC_FH_DIVIDE_32   5
+#define RCC_FH_DIVIDE_64   6
+#define RCC_FSUB           7
+
+/** @brief Modes of RccSwitch() */
+#define RCC_HIGH_SPEED     0
+#define RCC_LOW_SPEED      1
+#define RCC_SUB_SPEED      2
+#define RCC_MODES          3
+
+/** @brief Mode settings
+ * The high-speed mode runs fSYS = fH from RCC_HIGH_HIRC, which must be F_CPU.
+ * In the fSUB mode the HIRC keeps running at RCC_SUB_HIRC for the UART and
+ * the fH/16 and fH/64 timer clocks, or stops with RCC_HIRC_OFF.
+ */
+//=========================================================================
+#define RCC_RETIME         Disable            // Peripherals follow RccSwitch()
+#define RCC_HIGH_HIRC      RCC_HIRC_4MHZ
+#define RCC_LOW_HIRC       RCC_HIRC_4MHZ
+#define RCC_LOW_CLOCK      RCC_FH_DIVIDE_16   // fSYS in the low-speed mode
+#define RCC_SUB_HIRC       RCC_HIRC_OFF
+#define RCC_RETIME_SLOTS   4                  // Registered peripherals
+//=========================================================================
+
+#ifndef F_CPU
+    #define F_CPU   4000000   /**< System clock fSYS (= fH) in Hz */
+#endif
+#ifndef F_SUB
+    #define F_SUB   32768     /**< Low speed clock fSUB in Hz */
+#endif
+
+/** @brief fH of a HIRC setting in Hz, 0 when off. */
+#define RCC_HIRC_HZ(hirc)  ((hirc) == RCC_HIRC_OFF ? 0 : 2000000UL << ((hirc) & 3))
+
+#if RCC_HIRC_HZ(RCC_HIGH_HIRC) != F_CPU
+    #error "RCC_HIGH_HIRC must run at F_CPU, the clock the other modules are configured for"
+#endif
+#if RCC_LOW_HIRC == RCC_HIRC_OFF || RCC_LOW_CLOCK == RCC_FSUB
+    #error "The low-speed mode must run from the HIRC; fSUB is RCC_SUB_SPEED"
+#endif
+
+/** @brief Reprograms a peripheral for the mode RccMode() returns. */
+typedef void (*RccRetime)(void);
+
+/** @brief Selects the high-speed mode, the clock after reset. */
+void RccInit(void);
+
+/** @brief Switches the system clock and retimes the registered peripherals.
+ * Interrupts are held off until every peripheral runs at the new clock.
+ * @param mode RCC_HIGH_SPEED, RCC_LOW_SPEED or RCC_SUB_SPEED.
+ */
+void RccSwitch(unsigned char mode);
+
+/** @brief The current mode. */
+unsigned char RccMode(void);
+
+/** @brief fSYS of a mode in Hz. */
+unsigned long RccSystemHz(unsigned char mode);
+
+/** @brief fH of a mode in Hz, 0 when the HIRC is off. */
+unsigned long RccHighHz(unsigned char mode);
+
+/** @brief Adds a peripheral to be retimed after each switch.
+ * Registering the same function again does nothing.
+ * @param retime The function.
+ * @return 1 if it is registered, 0 if all RCC_RETIME_SLOTS are taken.
+ */
+char RccRegister(RccRetime retime);
+
+#endif // RCC_H
@@ -0,0 +1,196 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Telemetry.c
+ * @brief Implementation of the batched, delta-encoded telemetry aggregator.
+ * Windows are encoded into the filling frame as they close, so no window
+ * history is kept beyond the bytes that will be sent.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "Telemetry.h"
+
+#define TELEMETRY_WINDOW   (1 << TELEMETRY_WINDOW_SHIFT)
+
+// Largest record: 2-byte gap, mask, and three 3-byte varints per channel
+#define TEL_RECORD_MAX     (3 + 9 * TELEMETRY_CHANNELS)
+#define TEL_HEADER         3   // Type, sequence, length
+
+#if TELEMETRY_CHANNELS > 8
+    #error "TELEMETRY_CHANNELS must be 8 or less"
+#endif
+
+#if TEL_HEADER + TEL_RECORD_MAX > TELEMETRY_FRAME_SIZE || TELEMETRY_FRAME_SIZE > 255
+    #error "TELEMETRY_FRAME_SIZE must hold a full record and stay below 256"
+#endif
+
+static const int TelDeadband[TELEMETRY_CHANNELS] = TELEMETRY_DEADBANDS;
+
+static unsigned char TelFrame[2][TELEMETRY_FRAME_SIZE];
+static unsigned char TelFill;           // Frame being filled
+static unsigned char TelLength;         // Bytes in it
+static unsigned char TelWindows;        // Records in it
+static unsigned char TelFillKey;        // It starts with a keyframe record
+static unsigned char TelKey;            // The next record is a keyframe record
+static unsigned char TelSequence;
+static unsigned char TelIdle;           // Windows since the last frame was taken
+static unsigned int TelGap;             // Windows left out since the last record
+
+static unsigned char TelCount;          // Samples in the current window
+static int TelMin[TELEMETRY_CHANNELS];
+static int TelMax[TELEMETRY_CHANNELS];
+static long TelSum[TELEMETRY_CHANNELS];
+static int TelLast[TELEMETRY_CHANNELS]; // Last recorded average
+
+/** @brief Appends an unsigned LEB128 varint to the filling frame. */
+static void TelPutVarint(unsigned int value)
+{
+    unsigned char *frame = TelFrame[TelFill];
+
+    while (value >= 0x80)
+    {
+        frame[TelLength++] = (unsigned char)value | 0x80;
+        value >>= 7;
+    }
+    frame[TelLength++] = (unsigned char)value;
+}
+
+/** @brief Empties the filling frame. */
+static void TelRestart(void)
+{
+    TelLength = TEL_HEADER;
+    TelWindows = 0;
+    TelFillKey = 0;
+}
+
+/** @brief Initializes the aggregator; the first frame is a keyframe. */
+void TelemetryInit(void)
+{
+    TelFill = 0;
+    TelSequence = 0;
+    TelCount = 0;
+    TelemetryResync();
+}
+
+/** @brief Starts over with a keyframe. */
+void TelemetryResync(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < TELEMETRY_CHANNELS; i++)
+        TelLast[i] = 0;
+    TelKey = 1;
+    TelIdle = 0;
+    TelGap = 0;
+    TelRestart();
+}
+
+/** @brief Closes a window: records the channels that changed, if any. */
+static void TelWindowClose(void)
+{
+    unsigned char i;
+    unsigned char mask = 0;
+    unsigned char bit;
+    int average[TELEMETRY_CHANNELS];
+    int delta;
+
+    if (TelIdle != 0xFF)
+        TelIdle++;
+
+    for (i = 0, bit = 1; i < TELEMETRY_CHANNELS; i++, bit <<= 1)
+    {
+        average[i] = (int)(TelSum[i] >> TELEMETRY_WINDOW_SHIFT);
+        delta = average[i] - TelLast[i];
+        if (delta < 0)
+            delta = -delta;
+        if (TelKey || delta > TelDeadband[i] || TelMax[i] - TelMin[i] > TelDeadband[i])
+            mask |= bit;
+    }
+
+    // Left out when nothing changed, or when the frame was not taken in time
+    if (!mask || TelLength > TELEMETRY_FRAME_SIZE - TEL_RECORD_MAX)
+    {
+        if (TelGap != TELEMETRY_GAP_SATURATED)
+            TelGap++;
+        return;
+    }
+
+    if (TelKey)
+        TelFillKey = 1;         // Always the first record: a resync empties the frame
+    TelPutVarint(TelGap);
+    TelFrame[TelFill][TelLength++] = mask;
+    for (i = 0, bit = 1; i < TELEMETRY_CHANNELS; i++, bit <<= 1)
+    {
+        if (!(mask & bit))
+            continue;
+        delta = average[i] - TelLast[i];
+        TelPutVarint(((unsigned int)delta << 1) ^ (unsigned int)(delta < 0 ? -1 : 0));
+        TelPutVarint((unsigned int)(average[i] - TelMin[i]));
+        TelPutVarint((unsigned int)(TelMax[i] - average[i]));
+        TelLast[i] = average[i];
+    }
+    TelGap = 0;
+    TelKey = 0;
+    TelWindows++;
+}
+
+/** @brief Adds one sample of every channel. */
+void TelemetrySample(const int *values)
+{
+    unsigned char i;
+
+    for (i = 0; i < TELEMETRY_CHANNELS; i++)
+    {
+        if (!TelCount)
+        {
+            TelMin[i] = values[i];
+            TelMax[i] = values[i];
+            TelSum[i] = 0;
+        }
+        else if (values[i] < TelMin[i])
+        {
+            TelMin[i] = values[i];
+        }
+        else if (values[i] > TelMax[i])
+        {
+            TelMax[i] = values[i];
+        }
+        TelSum[i] += values[i];
+    }
+
+    if (++TelCount == TELEMETRY_WINDOW)
+    {
+        TelCount = 0;
+        TelWindowClose();
+    }
+}
+
+/** @brief Takes the next frame if one is due. */
+const unsigned char *TelemetryTake(unsigned char *length)
+{
+    unsigned char *frame;
+
+    if (TelWindows < TELEMETRY_BATCH && TelLength <= TELEMETRY_FRAME_SIZE - TEL_RECORD_MAX &&
+        TelIdle < TELEMETRY_HEARTBEAT)
+        return 0;
+
+    // A keyframe still due must come first; a heartbeat would not carry it
+    if (!TelWindows && TelKey)
+        return 0;
+
+    frame = TelFrame[TelFill];
+    frame[0] = TelFillKey ? TELEMETRY_KEY : (TelWindows ? TELEMETRY_DELTA : TELEMETRY_HEART);
+    frame[1] = TelSequence++;
+    frame[2] = TelLength;
+    *length = TelLength;
+
+    TelFill ^= 1;
+    TelIdle = 0;
+    TelRestart();
+    return frame;
+}
@@ -0,0 +1,81 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Telemetry.h
+ * @brief Header file for the batched, delta-encoded telemetry aggregator.
+ * Samples are reduced to min/max/average per window. A window is recorded only
+ * for channels whose average moved past their deadband or whose values spread
+ * over it, and recorded windows are packed into frames of several windows:
+ *
+ *   frame:  type ('K' keyframe, 'D' delta, 'H' heartbeat), sequence, length,
+ *           records
+ *   record: gap, channel mask, then per channel in the mask
+ *           zigzag(average - previous average), average - min, max - average
+ *
+ * length counts the whole frame, so frames sent back to back as raw bytes can
+ * be split again. The gap and the numbers after the mask are LEB128 varints;
+ * gap counts the windows left out before the record and stops at
+ * TELEMETRY_GAP_SATURATED, which means that many or more. A keyframe's first
+ * record holds every channel, as deltas from 0. A heartbeat is only sent after
+ * TELEMETRY_HEARTBEAT windows with nothing recorded; tools/telemetry_decode.py
+ * decodes the frames.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/** @brief Channels and windows
+ * Up to 8 channels; a window is 2^TELEMETRY_WINDOW_SHIFT samples.
+ */
+//=========================================================================
+#define TELEMETRY_CHANNELS      5
+#define TELEMETRY_DEADBANDS     { 1, 1, 0, 0, 0 }
+#define TELEMETRY_WINDOW_SHIFT  3
+//=========================================================================
+
+/** @brief Frames
+ * A frame is due after TELEMETRY_BATCH recorded windows, when it is nearly
+ * full, or TELEMETRY_HEARTBEAT windows after the last frame. There are two
+ * frame buffers, one filling while the other is sent.
+ */
+//=========================================================================
+#define TELEMETRY_BATCH         4
+#define TELEMETRY_HEARTBEAT     16
+#define TELEMETRY_FRAME_SIZE    64
+//=========================================================================
+
+/** @brief Gap of a record after this many or more windows left out */
+#define TELEMETRY_GAP_SATURATED  0x3FFF
+
+/** @brief Frame types */
+#define TELEMETRY_KEY           'K'
+#define TELEMETRY_DELTA         'D'
+#define TELEMETRY_HEART         'H'
+
+/** @brief Initializes the aggregator; the first frame is a keyframe. */
+void TelemetryInit(void);
+
+/** @brief Starts over with a keyframe, e.g. after the link was lost.
+ * Windows recorded but not yet taken are dropped.
+ */
+void TelemetryResync(void);
+
+/** @brief Adds one sample of every channel.
+ * @param values TELEMETRY_CHANNELS values.
+ */
+void TelemetrySample(const int *values);
+
+/** @brief Takes the next frame if one is due.
+ * The frame stays valid until the following call that returns a frame.
+ * @param length Receives the frame length.
+ * @return The frame, or 0 if none is due.
+ */
+const unsigned char *TelemetryTake(unsigned char *length);
+
+#endif // TELEMETRY_H
@@ -16,6 +16,10 @@
 
 #include "BTM.h"
 
+#if TIM_BASE_RETIME
+static unsigned char TimerBasePeriods[RCC_MODES];  // Time-out of each mode, Time Base 0 in bits 0~2, 1 in bits 4~6
+#endif
+
 /** @brief Initializes the Time Base 0 & 1 timers.
  *
  * This function configures the prescaler clock source for the timers, enables or 
@@ -31,6 +35,10 @@
  */
 void TimerBaseInit(void)
 {
+#if TIM_BASE_RETIME
+    unsigned char mode;
+#endif
+
     // Set the prescaler clock source for the base timers
     _pscr = PRESCALER_CLOCK_SOURCE_BASE_TIMER;
 
@@ -42,6 +50,40 @@ void TimerBaseInit(void)
     _tb0c |= TIM_BASE0_PERIOD;
     _tb1c |= TIM_BASE1_PERIOD;
 
+#if TIM_BASE_RETIME
+    // Pick the time-outs of the other clock modes now, at full speed
+    for (mode = 0; mode < RCC_MODES; mode++)
+    {
+        TimerBasePeriods[mode] = 0;
+    #ifdef TIM_BASE0_TARGET_PERIOD_US
+        TimerBasePeriods[mode] |= TS_TB_SELECT(TIM_BASE0_TARGET_PERIOD_US, (long)RccSystemHz(mode), TB_SOLVED_DIV);
+    #endif
+    #ifdef TIM_BASE1_TARGET_PERIOD_US
+        TimerBasePeriods[mode] |= TS_TB_SELECT(TIM_BASE1_TARGET_PERIOD_US, (long)RccSystemHz(mode), TB_SOLVED_DIV) << 4;
+    #endif
+    }
+    TimerBaseRetime();
+    RccRegister(TimerBaseRetime);
+#endif
+
     // Enable global interrupts to allow the timers to trigger interrupt service routines
-    InterruptEnable;
+    GLOBAL_INTERRUPT = Enable;
+}
+
+#if TIM_BASE_RETIME
+/** @brief Sets the Time Base time-outs for RccMode().
+ *
+ * Only the time-outs with a target period change.
+ */
+void TimerBaseRetime(void)
+{
+    unsigned char periods = TimerBasePeriods[RccMode()];
+
+#ifdef TIM_BASE0_TARGET_PERIOD_US
+    _tb0c = (_tb0c & ~7) | (periods & 7);
+#endif
+#ifdef TIM_BASE1_TARGET_PERIOD_US
+    _tb1c = (_tb1c & ~7) | (periods >> 4);
+#endif
 }
+#endif
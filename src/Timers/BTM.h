@@ -17,6 +17,8 @@
 #define BTM_H
 
 #include "BA45F5240.h"  // Include the microcontroller-specific header file
+#include "Interrupt.h"  // Global interrupt control and critical sections
+#include "RCC.h"        // Clock modes for retiming
 
 // Macros for enabling and disabling features
 #define Enable  1
@@ -27,8 +29,7 @@
 #define TIME_BASE1  Enable
 
 // Timer Base Interrupts Status and Control
-#define InterruptEnable          _emi = Enable   // Macro to enable global interrupts
-#define InterruptDisable         _emi = Disable  // Macro to disable global interrupts
+// Global interrupts are switched with GLOBAL_INTERRUPT or crit_enter()/crit_exit() from Interrupt.h
 #define TIME_BASE0_INTERRUPT_FLAG _tb0f           // Interrupt flag for Time Base 0
 #define TIME_BASE1_INTERRUPT_FLAG _tb1f           // Interrupt flag for Time Base 1
 
@@ -57,6 +58,22 @@ enum
 #define TIM_BASE0_PERIOD   Default
 #define TIM_BASE1_PERIOD   Default
 
+// Or let TimerSolver.h pick the time-out period nearest to a target in microseconds
+// #define TIM_BASE0_TARGET_PERIOD_US   1000
+// #define TIM_BASE1_TARGET_PERIOD_US   500000
+
+#if defined(TIM_BASE0_TARGET_PERIOD_US) || defined(TIM_BASE1_TARGET_PERIOD_US)
+    #include "TimerSolver.h"
+    #ifdef TIM_BASE0_TARGET_PERIOD_US
+        #undef  TIM_BASE0_PERIOD
+        #define TIM_BASE0_PERIOD   TIM_BASE0_SOLVED_PERIOD
+    #endif
+    #ifdef TIM_BASE1_TARGET_PERIOD_US
+        #undef  TIM_BASE1_PERIOD
+        #define TIM_BASE1_PERIOD   TIM_BASE1_SOLVED_PERIOD
+    #endif
+#endif
+
 /** @brief Initializes Time Base 0 & 1 timers.
  *
  * This function configures the prescaler clock source, enables/disables the timers,
@@ -70,4 +87,18 @@ enum
  */
 void TimerBaseInit(void);
 
+/** @brief Time Base retiming
+ * With RCC_RETIME, a target period and a prescaler clocked from fSYS,
+ * TimerBaseInit() picks the time-out of every clock mode of RCC.h and
+ * registers TimerBaseRetime(), which sets it after each RccSwitch().
+ * From fSUB the periods do not depend on the mode.
+ */
+#if RCC_RETIME && (defined(TIM_BASE0_TARGET_PERIOD_US) || defined(TIM_BASE1_TARGET_PERIOD_US)) && \
+    PRESCALER_CLOCK_SOURCE_BASE_TIMER != TB_FSUB
+    #define TIM_BASE_RETIME  1
+    void TimerBaseRetime(void);
+#else
+    #define TIM_BASE_RETIME  0
+#endif
+
 #endif // BTM_H
@@ -0,0 +1,190 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Idle.c
+ * @brief Implementation of the tickless low-power idle layer.
+ * The Time Base 1 time-out periods are taps of one free-running fSUB divider,
+ * so a period of 2^n ticks always ends on a multiple of 2^n ticks. The tick
+ * count is kept aligned to that divider, which lets the interrupt service
+ * routine round it up to the end of whichever period has just elapsed.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "Idle.h"
+
+#if TICKLESS_IDLE
+
+#include "BTM.h"
+
+#if PRESCALER_CLOCK_SOURCE_BASE_TIMER != TB_FSUB
+    #error "TICKLESS_IDLE requires PRESCALER_CLOCK_SOURCE_BASE_TIMER = TB_FSUB"
+#endif
+
+/** @brief Longest period the idle layer may program, as a power of two of ticks.
+ * Lower it to bound how late a deadline armed after an early wake-up can be.
+ */
+#define IDLE_MAX_SHIFT   (_32768_DIVIDE_PSC - TIM_BASE1_PERIOD)
+
+// Time Base 1 time-out period bits in TB1C
+#define TB1_PERIOD_BITS  0x07
+
+volatile unsigned long IdleTicks;
+
+static volatile unsigned char IdleWeight;            // Ticks in the programmed period, 0 until aligned
+static unsigned long IdleDeadline[IDLE_TIMERS];      // Absolute tick of each deadline
+static unsigned char IdleArmed;                      // One bit per armed slot
+
+/** @brief Initializes the idle layer.
+ *
+ * The first interrupt is taken on the longest period so that it lands on a
+ * boundary of every period. It comes at an unknown point of that period, so
+ * it is not counted: the tick count starts there, aligned from then on.
+ */
+void IdleInit(void)
+{
+    CritState state = crit_enter();
+
+    IdleTicks = 0;
+    IdleArmed = 0;
+    IdleWeight = 0;
+    _tb1c = (_tb1c & ~TB1_PERIOD_BITS) | _32768_DIVIDE_PSC;
+    crit_exit(state);
+
+    // Keep fSUB running and stop fH while halted
+    _fhiden = 0;
+    _fsiden = 1;
+}
+
+/** @brief Reads the tick count with interrupts held off.
+ * @return The number of ticks since IdleInit().
+ */
+unsigned long IdleGetTicks(void)
+{
+    unsigned long ticks;
+    CritState state = crit_enter();
+
+    ticks = IdleTicks;
+    crit_exit(state);
+    return ticks;
+}
+
+/** @brief Arms a deadline slot.
+ * @param slot The slot number, below IDLE_TIMERS.
+ * @param ticks The number of ticks from now until the deadline.
+ */
+void IdleSetTimer(unsigned char slot, unsigned int ticks)
+{
+    IdleDeadline[slot] = IdleGetTicks() + ticks;
+    IdleArmed |= (unsigned char)(1 << slot);
+}
+
+/** @brief Disarms a deadline slot.
+ * @param slot The slot number, below IDLE_TIMERS.
+ */
+void IdleCancelTimer(unsigned char slot)
+{
+    IdleArmed &= (unsigned char)~(1 << slot);
+}
+
+/** @brief Checks a deadline slot.
+ * @param slot The slot number, below IDLE_TIMERS.
+ * @return 1 once the deadline has passed (the slot is disarmed), otherwise 0.
+ */
+char IdleTimerExpired(unsigned char slot)
+{
+    if (!(IdleArmed & (1 << slot)))
+        return 0;
+    if ((long)(IdleDeadline[slot] - IdleGetTicks()) > 0)
+        return 0;
+
+    IdleArmed &= (unsigned char)~(1 << slot);
+    return 1;
+}
+
+/** @brief Halts the CPU for at most a number of ticks.
+ *
+ * The sleep is shortened to the nearest armed deadline, then to the longest
+ * period whose end (the next multiple of its length) is not later than that.
+ *
+ * @param limit The maximum number of ticks to sleep.
+ */
+static void IdleSleepFor(unsigned long limit)
+{
+    unsigned long now = IdleGetTicks();
+    unsigned long remaining;
+    unsigned char shift;
+    unsigned char i;
+
+    for (i = 0; i < IDLE_TIMERS; i++)
+    {
+        if (!(IdleArmed & (1 << i)))
+            continue;
+        if ((long)(IdleDeadline[i] - now) <= 0)
+            return;
+        remaining = IdleDeadline[i] - now;
+        if (remaining < limit)
+            limit = remaining;
+    }
+
+    if (limit == 0)
+        return;
+
+    shift = IDLE_MAX_SHIFT;
+    while (shift && ((now | ((1UL << shift) - 1)) + 1) - now > limit)
+        shift--;
+
+    GLOBAL_INTERRUPT = Disable;
+    // Stretch only from a base period; a pending stretched period already ends early enough
+    if (shift && IdleWeight == 1 && IdleTicks == now)
+    {
+        IdleWeight = (unsigned char)(1 << shift);
+        _tb1c = (_tb1c & ~TB1_PERIOD_BITS) | (TIM_BASE1_PERIOD + shift);
+    }
+    // Interrupts must be on for the wake-up vector to run
+    GLOBAL_INTERRUPT = Enable;
+
+    _halt();
+}
+
+/** @brief Halts the CPU until the next pending deadline. */
+void IdleSleep(void)
+{
+    IdleSleepFor(0xFFFFFFFFUL);
+}
+
+/** @brief Halts the CPU for a number of ticks instead of spinning.
+ * @param ticks The number of ticks to wait.
+ */
+void IdleDelay(unsigned int ticks)
+{
+    unsigned long deadline = IdleGetTicks() + ticks;
+    long remaining;
+
+    while ((remaining = (long)(deadline - IdleGetTicks())) > 0)
+        IdleSleepFor((unsigned long)remaining);
+}
+
+/** @brief Advances the tick count.
+ *
+ * Rounds the tick count up to the end of the period that has just elapsed and
+ * returns Time Base 1 to its base period. The first interrupt after IdleInit()
+ * only aligns the count.
+ */
+void IdleTickISR(void)
+{
+    if (IdleWeight)
+        IdleTicks = (IdleTicks | (IdleWeight - 1)) + 1;
+
+    if (IdleWeight != 1)
+    {
+        IdleWeight = 1;
+        _tb1c = (_tb1c & ~TB1_PERIOD_BITS) | TIM_BASE1_PERIOD;
+    }
+}
+
+#endif // TICKLESS_IDLE
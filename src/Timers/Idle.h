@@ -0,0 +1,93 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file Idle.h
+ * @brief Header file for the tickless low-power idle layer for Holtek MCUs.
+ * Time Base 1, clocked from fSUB, keeps a tick count. When the application has
+ * nothing to do it calls IdleSleep(): the time-out period of Time Base 1 is
+ * stretched to the longest _xxx_DIVIDE_PSC period that ends before the next
+ * pending deadline and the CPU is halted until then.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef IDLE_H
+#define IDLE_H
+
+#include "BA45F5240.h"  // Include the microcontroller-specific header file
+
+// Macros for enabling and disabling features
+#define Enable  1
+#define Disable 0
+
+//=========================================================================
+#define TICKLESS_IDLE   Disable  // Enable requires BASE_TIMER1_ISR = Enable
+//=========================================================================
+
+/** @brief Number of software deadline slots.
+ * Each slot costs 4 bytes of RAM.
+ */
+#define IDLE_TIMERS     4
+
+/** @brief Tick count.
+ * One tick is the Time Base 1 period selected by TIM_BASE1_PERIOD, 256 fSUB
+ * clocks (7.8ms at 32768Hz) with the default setting.
+ */
+extern volatile unsigned long IdleTicks;
+
+/** @brief Initializes the idle layer.
+ *
+ * Clears the tick count and the deadline slots and keeps fSUB running while
+ * the CPU is halted. Call it right after TimerBaseInit().
+ *
+ * The count starts at the first Time Base 1 interrupt, up to one longest
+ * period (1s with the default setting) later, so a deadline armed before then
+ * is late by up to that time, never early.
+ */
+void IdleInit(void);
+
+/** @brief Reads the tick count with interrupts held off.
+ * @return The number of ticks since IdleInit().
+ */
+unsigned long IdleGetTicks(void);
+
+/** @brief Arms a deadline slot.
+ * @param slot The slot number, below IDLE_TIMERS.
+ * @param ticks The number of ticks from now until the deadline.
+ */
+void IdleSetTimer(unsigned char slot, unsigned int ticks);
+
+/** @brief Disarms a deadline slot.
+ * @param slot The slot number, below IDLE_TIMERS.
+ */
+void IdleCancelTimer(unsigned char slot);
+
+/** @brief Checks a deadline slot.
+ * @param slot The slot number, below IDLE_TIMERS.
+ * @return 1 once the deadline has passed (the slot is disarmed), otherwise 0.
+ */
+char IdleTimerExpired(unsigned char slot);
+
+/** @brief Halts the CPU until the next pending deadline.
+ *
+ * Returns immediately if a deadline is already due. Any enabled interrupt
+ * also wakes the CPU early; the tick count stays correct in both cases.
+ */
+void IdleSleep(void);
+
+/** @brief Halts the CPU for a number of ticks instead of spinning.
+ * @param ticks The number of ticks to wait.
+ */
+void IdleDelay(unsigned int ticks);
+
+/** @brief Advances the tick count.
+ *
+ * Must be called from the Time Base 1 interrupt service routine.
+ */
+void IdleTickISR(void);
+
+#endif // IDLE_H
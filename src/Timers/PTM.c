@@ -15,6 +15,12 @@
 
 #include <PTM.h>
 
+#if PTM_RETIME
+static unsigned char PtmClocks[RCC_MODES];  // Counter clock of each mode, TS_NO_CLOCK if out of reach
+static unsigned int PtmCounts[RCC_MODES];   // CCRP of each mode
+static unsigned char PtmHeld;               // Counter was on before a mode out of reach
+#endif
+
 /** @brief Initializes the Pulse Timer Module (PTM).
  *
  * This function configures the PTM's clock, mode, output settings, and
@@ -24,6 +30,10 @@
  */
 void PTimerInit(void)
 {
+#if PTM_RETIME
+    unsigned char mode;
+#endif
+
     _ifs06 = 1; // Clear interrupt flag for PTM
     _ifs07 = 0; // Initialize another interrupt flag
     
@@ -85,7 +95,49 @@ void PTimerInit(void)
 
     // Set PTM Comparator CCRP High Byte
     _ptmrph = PTM_CCRP_HIGH_BYTE_MASK & 3;
+
+#if PTM_RETIME
+    // Solve the other clock modes now, at full speed
+    for (mode = 0; mode < RCC_MODES; mode++)
+    {
+        PtmClocks[mode] = TimerSolve(PTM_TARGET_PERIOD_US, RccSystemHz(mode), RccHighHz(mode),
+                                     1, 1024, &PtmCounts[mode]);
+    }
+    PtmHeld = 0;
+    PTimerRetime();
+    RccRegister(PTimerRetime);
+#endif
+}
+
+#if PTM_RETIME
+/** @brief Sets the PTM clock and period for RccMode().
+ *
+ * The counter is off while the clock changes and is left as it was,
+ * or held off in a mode where no clock reaches the period.
+ *
+ * @return void
+ */
+void PTimerRetime(void)
+{
+    unsigned char mode = RccMode();
+    unsigned char clock = PtmClocks[mode];
+    unsigned char on = _pton | PtmHeld;
+
+    _pton = 0;
+    PtmHeld = 0;
+    if (clock == TS_NO_CLOCK)
+    {
+        PtmHeld = on;
+        return;
+    }
+    _ptck0 = clock & 1;
+    _ptck1 = (clock >> 1) & 1;
+    _ptck2 = (clock >> 2) & 1;
+    _ptmrpl = PtmCounts[mode] & 0xFF;
+    _ptmrph = (PtmCounts[mode] >> 8) & 3;
+    _pton = on;
 }
+#endif
 
 /** @brief Sets the PWM status.
  *
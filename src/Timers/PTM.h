@@ -17,6 +17,7 @@
 #define PTIMER_H
 
 #include <Main.h>
+#include "RCC.h"
 
 /** @brief PTM Counter Clock Selection
  * This section defines the clock sources for the PTM counter.
@@ -145,6 +146,46 @@
 #define PTM_CCRP_HIGH_BYTE_MASK 1 // Mask for PTM CCRP high byte MIN =1 MAX=0x3
 //=========================================================================
 
+/** @brief PTM period solver
+ * Define a target period to let TimerSolver.h pick PTIMER_CLOCK and the CCRP
+ * masks from F_CPU/F_SUB instead of setting them by hand.
+ */
+//=========================================================================
+// #define PTM_TARGET_PERIOD_US   1000
+//=========================================================================
+
+#ifdef PTM_TARGET_PERIOD_US
+    #include "TimerSolver.h"
+    #undef  PTIMER_CLOCK
+    #undef  PTM_CCRP_LOW_BYTE_MASK
+    #undef  PTM_CCRP_HIGH_BYTE_MASK
+    #define PTIMER_CLOCK             PTM_SOLVED_CLOCK
+    #define PTM_CCRP_LOW_BYTE_MASK   (PTM_SOLVED_COUNTS & 0xFF)
+    #define PTM_CCRP_HIGH_BYTE_MASK  ((PTM_SOLVED_COUNTS >> 8) & 3)
+#endif
+
+/** @brief PTM counter period
+ * Number of counter clocks in one comparator P period, read back from CCRP as
+ * PTimerRetime() may change it (0 counts 1024), and the distance between two
+ * counter values across at most one wrap when the counter clears on P.
+ */
+#define PTM_P_PERIOD_CLOCKS() \
+    ((((_ptmrpl | ((unsigned int)(_ptmrph & 3) << 8)) - 1) & 0x3FF) + 1)
+#define PTM_ELAPSED(from, to) \
+    ((to) >= (from) ? (to) - (from) : (to) + PTM_P_PERIOD_CLOCKS() - (from))
+
+/** @brief PTM retiming
+ * With RCC_RETIME and a target period, PTimerInit() solves the period for
+ * every clock mode of RCC.h and registers PTimerRetime(), which sets the
+ * clock and CCRP for the mode after each RccSwitch(). In a mode where no
+ * clock reaches the period the counter is held off.
+ */
+#if RCC_RETIME && defined(PTM_TARGET_PERIOD_US)
+    #define PTM_RETIME  1
+#else
+    #define PTM_RETIME  0
+#endif
+
 /** @brief Function declarations
  *
  * The following functions are declared for initializing and using the PTM.
@@ -152,5 +193,8 @@
 void PTimerInit(void);  /**< @brief Initializes the PTM */
 void PWMSeter(char status); /**< @brief Sets the PWM status (active or inactive) */
 unsigned int readPTimer(void);   /**< @brief Reads the current value of the PTM timer */
+#if PTM_RETIME
+void PTimerRetime(void); /**< @brief Sets the clock and period for RccMode() */
+#endif
 
 #endif  // End of PTIMER_H
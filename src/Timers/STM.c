@@ -14,6 +14,12 @@
 
 #include <STM.h>
 
+#if STM_RETIME
+static unsigned char StmClocks[RCC_MODES];  // Counter clock of each mode, TS_NO_CLOCK if out of reach
+static unsigned int StmCounts[RCC_MODES];   // CCRA or comparator P period code of each mode
+static unsigned char StmHeld;               // Counter was on before a mode out of reach
+#endif
+
 /** @brief Initializes the Standard Timer Module (STM).
  *
  * This function configures the STM counter, clock, mode, and other parameters
@@ -26,6 +32,10 @@
  * @return void
  */
 void STimerInit(void) {
+#if STM_RETIME
+    unsigned char mode;
+#endif
+
     // STPAU: STM Counter Pause Control
     // 0: Run, 1: Pause
     _stpau = 0; // Set STM counter to run mode
@@ -68,7 +78,52 @@ void STimerInit(void) {
 
     // Set STM Comparator CCRA High Byte
     _stmah = STM_CCRA_HIGH_BYTE_MASK & 3;
+
+#if STM_RETIME
+    // Solve the other clock modes now, at full speed
+    for (mode = 0; mode < RCC_MODES; mode++) {
+        StmClocks[mode] = TimerSolve(STM_TARGET_PERIOD_US, RccSystemHz(mode), RccHighHz(mode),
+                                     STM_SOLVED_STEP, STM_SOLVED_MAX, &StmCounts[mode]);
+    }
+    StmHeld = 0;
+    STimerRetime();
+    RccRegister(STimerRetime);
+#endif
+}
+
+#if STM_RETIME
+/** @brief Sets the STM clock and period for RccMode().
+ *
+ * The counter is off while the clock changes and is left as it was,
+ * or held off in a mode where no clock reaches the period.
+ *
+ * @return void
+ */
+void STimerRetime(void) {
+    unsigned char mode = RccMode();
+    unsigned char clock = StmClocks[mode];
+    unsigned char on = _ston | StmHeld;
+
+    _ston = 0;
+    StmHeld = 0;
+    if (clock == TS_NO_CLOCK) {
+        StmHeld = on;
+        return;
+    }
+    _stck0 = clock & 1;
+    _stck1 = (clock >> 1) & 1;
+    _stck2 = (clock >> 2) & 1;
+#if STM_SELECT_CLEAR_COMPARE_MATCH == STM_COMPARE_MATCH_P
+    _strp0 = StmCounts[mode] & 1;
+    _strp1 = (StmCounts[mode] >> 1) & 1;
+    _strp2 = (StmCounts[mode] >> 2) & 1;
+#else
+    _stmal = StmCounts[mode] & 0xFF;
+    _stmah = (StmCounts[mode] >> 8) & 3;
+#endif
+    _ston = on;
 }
+#endif
 
 /** @brief Reads the value of the Standard Timer Module (STM).
  *
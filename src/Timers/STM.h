@@ -17,6 +17,7 @@
 #define STIMER_H
 
 #include <Main.h>  // Assuming this includes necessary main header file
+#include "RCC.h"
 
 /** @brief STM Counter Clock Selection
  * This section defines the clock sources for the STM counter.
@@ -115,7 +116,7 @@
  * This section defines the duty and period control for the PWM.
  */
 #define STM_DUTY        1
-#define STM_PERIOD      0
+#define STM_PWM_PERIOD  0
 //=========================================================================
 #define STM_PWM_DUTY    STM_DUTY
 //=========================================================================
@@ -141,11 +142,63 @@
 #define STM_CCRA_HIGH_BYTE_MASK 0x0 // Mask for STM CCRA high byte Max=0x03
 //=========================================================================
 
+/** @brief STM period solver
+ * Define a target period to let TimerSolver.h pick STIMER_CLOCK and, depending
+ * on STM_SELECT_CLEAR_COMPARE_MATCH, either the CCRA masks or STM_PERIOD.
+ */
+//=========================================================================
+// #define STM_TARGET_PERIOD_US   1000
+//=========================================================================
+
+#ifdef STM_TARGET_PERIOD_US
+    #include "TimerSolver.h"
+    #undef  STIMER_CLOCK
+    #define STIMER_CLOCK    STM_SOLVED_CLOCK
+    #if STM_SELECT_CLEAR_COMPARE_MATCH == STM_COMPARE_MATCH_P
+        #undef  STM_PERIOD
+        #define STM_PERIOD  STM_SOLVED_COUNTS
+    #else
+        #undef  STM_CCRA_LOW_BYTE_MASK
+        #undef  STM_CCRA_HIGH_BYTE_MASK
+        #define STM_CCRA_LOW_BYTE_MASK   (STM_SOLVED_COUNTS & 0xFF)
+        #define STM_CCRA_HIGH_BYTE_MASK  ((STM_SOLVED_COUNTS >> 8) & 3)
+    #endif
+#endif
+
+/** @brief STM counter period
+ * Number of counter clocks in one comparator P period, the wrap of a free-running
+ * counter, and the distance between two counter values across at most one wrap.
+ */
+#if STM_PERIOD == STM_1024_CLOCKS
+    #define STM_P_PERIOD_CLOCKS   1024
+#else
+    #define STM_P_PERIOD_CLOCKS   (STM_PERIOD * 128)
+#endif
+#define STM_ELAPSED(from, to) \
+    ((to) >= (from) ? (to) - (from) : (to) + STM_P_PERIOD_CLOCKS - (from))
+
+/** @brief STM retiming
+ * With RCC_RETIME and a target period, STimerInit() solves the period for
+ * every clock mode of RCC.h and registers STimerRetime(), which sets the
+ * clock and CCRA or comparator P period for the mode after each RccSwitch().
+ * A comparator P period may then differ from STM_P_PERIOD_CLOCKS outside the
+ * high-speed mode. In a mode where no clock reaches the period the counter
+ * is held off.
+ */
+#if RCC_RETIME && defined(STM_TARGET_PERIOD_US)
+    #define STM_RETIME  1
+#else
+    #define STM_RETIME  0
+#endif
+
 /** @brief Function declarations
  *
  * The following functions are declared for initializing and using the STM.
  */
 void STimerInit(void);  /**< @brief Initializes the STM */
 unsigned int readSTimer(void);   /**< @brief Reads the current value of the STM timer */
+#if STM_RETIME
+void STimerRetime(void); /**< @brief Sets the clock and period for RccMode() */
+#endif
 
 #endif  // End of STIMER_H
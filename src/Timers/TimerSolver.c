@@ -0,0 +1,79 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file TimerSolver.c
+ * @brief Run-time form of the PTM and STM period solver of TimerSolver.h,
+ * used by the retiming of RCC.h only.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "TimerSolver.h"
+#include "RCC.h"
+
+#if RCC_RETIME
+
+/** @brief Candidates in the order of the #if chains, so ties resolve alike. */
+static const unsigned char TimerSolveOrder[5] =
+{
+    TS_CLOCK_SYS, TS_CLOCK_SYS_DIVIDE_4, TS_CLOCK_H_DIVIDE_16, TS_CLOCK_H_DIVIDE_64, TS_CLOCK_SUB
+};
+
+/** @brief Prescaler of each TS_CLOCK_xxx selection. */
+static const unsigned char TimerSolveDivide[5] = { 4, 1, 16, 64, 1 };
+
+/** @brief Clock in Hz behind a TS_CLOCK_xxx selection. */
+static long TimerSolveHz(unsigned char clock, unsigned long fSys, unsigned long fH)
+{
+    if (clock == TS_CLOCK_SUB)
+        return F_SUB;
+    return (long)(clock <= TS_CLOCK_SYS ? fSys : fH);
+}
+
+/** @brief Picks the counter clock and count for a period at run-time clocks.
+ * @param us Target period in us.
+ * @param fSys fSYS in Hz.
+ * @param fH fH in Hz, 0 when stopped.
+ * @param step Counts per compare step, 128 for the STM comparator P period, otherwise 1.
+ * @param max Most steps, a power of 2.
+ * @param counts Receives the steps, with max written as 0.
+ * @return The TS_CLOCK_xxx selection, or TS_NO_CLOCK when none is within tolerance.
+ */
+unsigned char TimerSolve(long us, unsigned long fSys, unsigned long fH,
+                         unsigned int step, unsigned int max, unsigned int *counts)
+{
+    unsigned char best = TS_NO_CLOCK;
+    unsigned char clock;
+    unsigned char i;
+    long least = TS_UNREACHABLE;
+    long error;
+    long f;
+    long div;
+
+    for (i = 0; i < sizeof(TimerSolveOrder); i++)
+    {
+        clock = TimerSolveOrder[i];
+        f = TimerSolveHz(clock, fSys, fH);
+        if (f < 64)
+            continue;   // Clock stopped
+        div = (long)TimerSolveDivide[clock] * step;
+        error = TS_CANDIDATE_ERROR(us, f, div, (long)max);
+        if (error < least)
+        {
+            least = error;
+            best = clock;
+        }
+    }
+    if (best == TS_NO_CLOCK || TS_OUT_OF_TOLERANCE(least, us))
+        return TS_NO_CLOCK;
+
+    f = TimerSolveHz(best, fSys, fH);
+    div = (long)TimerSolveDivide[best] * step;
+    *counts = (unsigned int)TS_COUNTS(us, f, div) & (max - 1);
+    return best;
+}
+#endif
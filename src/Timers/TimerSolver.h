@@ -0,0 +1,268 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file TimerSolver.h
+ * @brief Compile-time period solver for the Time Base, PTM and STM timers.
+ * Given a target period in microseconds and the fSYS/fSUB clocks, the solver
+ * picks the clock source, prescaler and compare value with the least error and
+ * stops the build with #error when the target cannot be met within
+ * TIMER_SOLVER_TOLERANCE_PERCENT. It is included by BTM.h, PTM.h and STM.h
+ * when their *_TARGET_PERIOD_US macro is defined.
+ *
+ * All expressions stay below 2^31 so a 32-bit preprocessor evaluates them;
+ * both clocks must therefore be multiples of 64Hz. 1s = 64 * 15625 us.
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef TIMER_SOLVER_H
+#define TIMER_SOLVER_H
+
+//=========================================================================
+#ifndef F_CPU
+    #define F_CPU   4000000   /**< System clock fSYS (= fH) in Hz */
+#endif
+#ifndef F_SUB
+    #define F_SUB   32768     /**< Low speed clock fSUB in Hz */
+#endif
+#ifndef TIMER_SOLVER_TOLERANCE_PERCENT
+    #define TIMER_SOLVER_TOLERANCE_PERCENT  5  /**< Largest accepted period error */
+#endif
+//=========================================================================
+
+/** @brief Error reported for a candidate that cannot produce the target. */
+#define TS_UNREACHABLE   0x7FFFFFFFL
+
+/** @brief Longest period in us with max counts of clock f / div. */
+#define TS_MAX_US(f, div, max)   (15625L * (div) * (max) / ((f) / 64))
+
+/** @brief Nearest number of counts of clock f / div for a period of us.
+ * The long constants promote us before multiplying, so a 16-bit int never
+ * overflows, and the macros stay usable in #if. us * f / 64 must still fit in
+ * a long: us may not exceed TS_MAX_US(f, div, max), which TS_CANDIDATE_ERROR()
+ * checks first. Every candidate here has 15625 * div * max below 2^31.
+ */
+#define TS_COUNTS(us, f, div)    (((us) * ((f) / 64L) + 15625L * (div) / 2) / (15625L * (div)))
+
+/** @brief Error of TS_COUNTS in 1/16 us, over the same range. */
+#define TS_ERROR(us, f, div) \
+    ((TS_COUNTS(us, f, div) * 15625L * (div) > (us) * ((f) / 64L) ? \
+      TS_COUNTS(us, f, div) * 15625L * (div) - (us) * ((f) / 64L) : \
+      (us) * ((f) / 64L) - TS_COUNTS(us, f, div) * 15625L * (div)) * 16 / ((f) / 64))
+
+/** @brief Error of a candidate in 1/16 us, or TS_UNREACHABLE when the count is out of 1..max.
+ * The range check comes first, so any us that fits in a long is safe.
+ */
+#define TS_CANDIDATE_ERROR(us, f, div, max) \
+    ((us) > TS_MAX_US(f, div, max) ? TS_UNREACHABLE : \
+     TS_COUNTS(us, f, div) < 1 ? TS_UNREACHABLE : TS_ERROR(us, f, div))
+
+/** @brief True when an error in 1/16 us is outside the tolerance for a period of us.
+ * Valid for us up to 2^31 / (16 * TIMER_SOLVER_TOLERANCE_PERCENT), 26 s at 5 percent.
+ */
+#define TS_OUT_OF_TOLERANCE(error, us) \
+    ((error) > (us) * 16L * TIMER_SOLVER_TOLERANCE_PERCENT / 100)
+
+/** @brief Counter clock candidates shared by the PTM and STM.
+ * The values match both the PT_xxx and the ST_xxx clock selections.
+ */
+#define TS_CLOCK_SYS_DIVIDE_4   0
+#define TS_CLOCK_SYS            1
+#define TS_CLOCK_H_DIVIDE_16    2
+#define TS_CLOCK_H_DIVIDE_64    3
+#define TS_CLOCK_SUB            4
+
+/** @brief Time Base period in us for time-out selection k (2^(8+k) clocks of f / div). */
+#define TS_TB_PERIOD_US(k, f, div)   ((256L << (k)) * 15625 * (div) / ((f) / 64))
+
+/** @brief No counter clock reaches the period, returned by TimerSolve(). */
+#define TS_NO_CLOCK             0xFF
+
+/** @brief The PTM and STM solver below, run for clocks known only at run time.
+ * Candidates are tried in the same order with the same expressions, all below
+ * 2^31 with 32-bit longs since each count is checked against max first.
+ * It costs a few long divisions per candidate, so the RCC_RETIME users call
+ * it at init for every clock mode rather than on each switch.
+ * @param us Target period in us.
+ * @param fSys fSYS in Hz.
+ * @param fH fH in Hz, 0 when stopped.
+ * @param step Counts per compare step, 128 for the STM comparator P period, otherwise 1.
+ * @param max Most steps, a power of 2.
+ * @param counts Receives the steps, with max written as 0.
+ * @return The TS_CLOCK_xxx selection, or TS_NO_CLOCK when none is within tolerance.
+ */
+unsigned char TimerSolve(long us, unsigned long fSys, unsigned long fH,
+                         unsigned int step, unsigned int max, unsigned int *counts);
+
+/** @brief Time-out selection nearest to a period of us.
+ * Between two neighbouring periods p and 2p the nearest one changes at 1.5p.
+ */
+#define TS_TB_SELECT(us, f, div) \
+    (((us) * 2L > TS_TB_PERIOD_US(0, f, div) * 3) + ((us) * 2L > TS_TB_PERIOD_US(1, f, div) * 3) + \
+     ((us) * 2L > TS_TB_PERIOD_US(2, f, div) * 3) + ((us) * 2L > TS_TB_PERIOD_US(3, f, div) * 3) + \
+     ((us) * 2L > TS_TB_PERIOD_US(4, f, div) * 3) + ((us) * 2L > TS_TB_PERIOD_US(5, f, div) * 3) + \
+     ((us) * 2L > TS_TB_PERIOD_US(6, f, div) * 3))
+
+/** @brief Error in us of the nearest Time Base period. */
+#define TS_TB_ERROR(us, f, div) \
+    (TS_TB_PERIOD_US(TS_TB_SELECT(us, f, div), f, div) > (us) ? \
+     TS_TB_PERIOD_US(TS_TB_SELECT(us, f, div), f, div) - (us) : \
+     (us) - TS_TB_PERIOD_US(TS_TB_SELECT(us, f, div), f, div))
+
+#endif // TIMER_SOLVER_H
+
+//=========================================================================
+// Time Base 0 & 1: time-out selection for the configured prescaler clock
+//=========================================================================
+#if (defined(TIM_BASE0_TARGET_PERIOD_US) || defined(TIM_BASE1_TARGET_PERIOD_US)) && !defined(TB_SOLVED_F)
+    #if PRESCALER_CLOCK_SOURCE_BASE_TIMER == TB_FSYS
+        #define TB_SOLVED_F     F_CPU
+        #define TB_SOLVED_DIV   1
+    #elif PRESCALER_CLOCK_SOURCE_BASE_TIMER == TB_FSYS_DIVIDE_4
+        #define TB_SOLVED_F     F_CPU
+        #define TB_SOLVED_DIV   4
+    #else
+        #define TB_SOLVED_F     F_SUB
+        #define TB_SOLVED_DIV   1
+    #endif
+
+    #ifdef TIM_BASE0_TARGET_PERIOD_US
+        #define TIM_BASE0_SOLVED_PERIOD  TS_TB_SELECT(TIM_BASE0_TARGET_PERIOD_US, TB_SOLVED_F, TB_SOLVED_DIV)
+        #if TS_TB_ERROR(TIM_BASE0_TARGET_PERIOD_US, TB_SOLVED_F, TB_SOLVED_DIV) * 100 > \
+            TIM_BASE0_TARGET_PERIOD_US * TIMER_SOLVER_TOLERANCE_PERCENT
+            #error "TIM_BASE0_TARGET_PERIOD_US cannot be reached with the Time Base prescaler clock"
+        #endif
+    #endif
+
+    #ifdef TIM_BASE1_TARGET_PERIOD_US
+        #define TIM_BASE1_SOLVED_PERIOD  TS_TB_SELECT(TIM_BASE1_TARGET_PERIOD_US, TB_SOLVED_F, TB_SOLVED_DIV)
+        #if TS_TB_ERROR(TIM_BASE1_TARGET_PERIOD_US, TB_SOLVED_F, TB_SOLVED_DIV) * 100 > \
+            TIM_BASE1_TARGET_PERIOD_US * TIMER_SOLVER_TOLERANCE_PERCENT
+            #error "TIM_BASE1_TARGET_PERIOD_US cannot be reached with the Time Base prescaler clock"
+        #endif
+    #endif
+#endif
+
+//=========================================================================
+// PTM: counter clock and CCRP (1..1024 counts, counter cleared on comparator P)
+//=========================================================================
+#if defined(PTM_TARGET_PERIOD_US) && !defined(PTM_SOLVED_CLOCK)
+    #define PTM_SOLVED_CLOCK   TS_CLOCK_SYS
+    #define PTM_SOLVED_F       F_CPU
+    #define PTM_SOLVED_DIV     1
+    #define PTM_SOLVED_ERROR   TS_CANDIDATE_ERROR(PTM_TARGET_PERIOD_US, F_CPU, 1, 1024)
+
+    #if TS_CANDIDATE_ERROR(PTM_TARGET_PERIOD_US, F_CPU, 4, 1024) < PTM_SOLVED_ERROR
+        #undef  PTM_SOLVED_CLOCK
+        #undef  PTM_SOLVED_DIV
+        #undef  PTM_SOLVED_ERROR
+        #define PTM_SOLVED_CLOCK   TS_CLOCK_SYS_DIVIDE_4
+        #define PTM_SOLVED_DIV     4
+        #define PTM_SOLVED_ERROR   TS_CANDIDATE_ERROR(PTM_TARGET_PERIOD_US, F_CPU, 4, 1024)
+    #endif
+
+    #if TS_CANDIDATE_ERROR(PTM_TARGET_PERIOD_US, F_CPU, 16, 1024) < PTM_SOLVED_ERROR
+        #undef  PTM_SOLVED_CLOCK
+        #undef  PTM_SOLVED_DIV
+        #undef  PTM_SOLVED_ERROR
+        #define PTM_SOLVED_CLOCK   TS_CLOCK_H_DIVIDE_16
+        #define PTM_SOLVED_DIV     16
+        #define PTM_SOLVED_ERROR   TS_CANDIDATE_ERROR(PTM_TARGET_PERIOD_US, F_CPU, 16, 1024)
+    #endif
+
+    #if TS_CANDIDATE_ERROR(PTM_TARGET_PERIOD_US, F_CPU, 64, 1024) < PTM_SOLVED_ERROR
+        #undef  PTM_SOLVED_CLOCK
+        #undef  PTM_SOLVED_DIV
+        #undef  PTM_SOLVED_ERROR
+        #define PTM_SOLVED_CLOCK   TS_CLOCK_H_DIVIDE_64
+        #define PTM_SOLVED_DIV     64
+        #define PTM_SOLVED_ERROR   TS_CANDIDATE_ERROR(PTM_TARGET_PERIOD_US, F_CPU, 64, 1024)
+    #endif
+
+    #if TS_CANDIDATE_ERROR(PTM_TARGET_PERIOD_US, F_SUB, 1, 1024) < PTM_SOLVED_ERROR
+        #undef  PTM_SOLVED_CLOCK
+        #undef  PTM_SOLVED_F
+        #undef  PTM_SOLVED_DIV
+        #undef  PTM_SOLVED_ERROR
+        #define PTM_SOLVED_CLOCK   TS_CLOCK_SUB
+        #define PTM_SOLVED_F       F_SUB
+        #define PTM_SOLVED_DIV     1
+        #define PTM_SOLVED_ERROR   TS_CANDIDATE_ERROR(PTM_TARGET_PERIOD_US, F_SUB, 1, 1024)
+    #endif
+
+    #if TS_OUT_OF_TOLERANCE(PTM_SOLVED_ERROR, PTM_TARGET_PERIOD_US)
+        #error "PTM_TARGET_PERIOD_US cannot be reached with any PTM clock"
+    #endif
+
+    /** @brief Solved CCRP value; 1024 is written as 0. */
+    #define PTM_SOLVED_COUNTS  (TS_COUNTS(PTM_TARGET_PERIOD_US, PTM_SOLVED_F, PTM_SOLVED_DIV) & 0x3FF)
+#endif
+
+//=========================================================================
+// STM: counter clock and either CCRA (1..1024 counts, cleared on comparator A)
+// or the comparator P period (128..1024 counts in steps of 128, cleared on P)
+//=========================================================================
+#if defined(STM_TARGET_PERIOD_US) && !defined(STM_SOLVED_CLOCK)
+    #if STM_SELECT_CLEAR_COMPARE_MATCH == STM_COMPARE_MATCH_P
+        #define STM_SOLVED_STEP    128   // Counts per comparator P period step
+        #define STM_SOLVED_MAX     8
+    #else
+        #define STM_SOLVED_STEP    1
+        #define STM_SOLVED_MAX     1024
+    #endif
+
+    #define STM_SOLVED_CLOCK   TS_CLOCK_SYS
+    #define STM_SOLVED_F       F_CPU
+    #define STM_SOLVED_DIV     1
+    #define STM_SOLVED_ERROR   TS_CANDIDATE_ERROR(STM_TARGET_PERIOD_US, F_CPU, STM_SOLVED_STEP, STM_SOLVED_MAX)
+
+    #if TS_CANDIDATE_ERROR(STM_TARGET_PERIOD_US, F_CPU, 4 * STM_SOLVED_STEP, STM_SOLVED_MAX) < STM_SOLVED_ERROR
+        #undef  STM_SOLVED_CLOCK
+        #undef  STM_SOLVED_DIV
+        #undef  STM_SOLVED_ERROR
+        #define STM_SOLVED_CLOCK   TS_CLOCK_SYS_DIVIDE_4
+        #define STM_SOLVED_DIV     4
+        #define STM_SOLVED_ERROR   TS_CANDIDATE_ERROR(STM_TARGET_PERIOD_US, F_CPU, 4 * STM_SOLVED_STEP, STM_SOLVED_MAX)
+    #endif
+
+    #if TS_CANDIDATE_ERROR(STM_TARGET_PERIOD_US, F_CPU, 16 * STM_SOLVED_STEP, STM_SOLVED_MAX) < STM_SOLVED_ERROR
+        #undef  STM_SOLVED_CLOCK
+        #undef  STM_SOLVED_DIV
+        #undef  STM_SOLVED_ERROR
+        #define STM_SOLVED_CLOCK   TS_CLOCK_H_DIVIDE_16
+        #define STM_SOLVED_DIV     16
+        #define STM_SOLVED_ERROR   TS_CANDIDATE_ERROR(STM_TARGET_PERIOD_US, F_CPU, 16 * STM_SOLVED_STEP, STM_SOLVED_MAX)
+    #endif
+
+    #if TS_CANDIDATE_ERROR(STM_TARGET_PERIOD_US, F_CPU, 64 * STM_SOLVED_STEP, STM_SOLVED_MAX) < STM_SOLVED_ERROR
+        #undef  STM_SOLVED_CLOCK
+        #undef  STM_SOLVED_DIV
+        #undef  STM_SOLVED_ERROR
+        #define STM_SOLVED_CLOCK   TS_CLOCK_H_DIVIDE_64
+        #define STM_SOLVED_DIV     64
+        #define STM_SOLVED_ERROR   TS_CANDIDATE_ERROR(STM_TARGET_PERIOD_US, F_CPU, 64 * STM_SOLVED_STEP, STM_SOLVED_MAX)
+    #endif
+
+    #if TS_CANDIDATE_ERROR(STM_TARGET_PERIOD_US, F_SUB, STM_SOLVED_STEP, STM_SOLVED_MAX) < STM_SOLVED_ERROR
+        #undef  STM_SOLVED_CLOCK
+        #undef  STM_SOLVED_F
+        #undef  STM_SOLVED_DIV
+        #undef  STM_SOLVED_ERROR
+        #define STM_SOLVED_CLOCK   TS_CLOCK_SUB
+        #define STM_SOLVED_F       F_SUB
+        #define STM_SOLVED_DIV     1
+        #define STM_SOLVED_ERROR   TS_CANDIDATE_ERROR(STM_TARGET_PERIOD_US, F_SUB, STM_SOLVED_STEP, STM_SOLVED_MAX)
+    #endif
+
+    #if TS_OUT_OF_TOLERANCE(STM_SOLVED_ERROR, STM_TARGET_PERIOD_US)
+        #error "STM_TARGET_PERIOD_US cannot be reached with any STM clock"
+    #endif
+
+    /** @brief Solved CCRA value (1024 is written as 0) or comparator P period code. */
+    #define STM_SOLVED_COUNTS \
+        (TS_COUNTS(STM_TARGET_PERIOD_US, STM_SOLVED_F, STM_SOLVED_DIV * STM_SOLVED_STEP) & (STM_SOLVED_MAX - 1))
+#endif
@@ -14,8 +14,13 @@
  */
 
 #include "UART.h"
+#include "Format.h"
 #include <BA45F5240.h>
 
+#if RCC_RETIME
+static unsigned char UartDivisors[RCC_MODES];   // UBRG of each clock mode
+#endif
+
 /** @brief Initializes the UART with a specified baud rate.
  * @param baudrate The baud rate for UART communication.
  *
@@ -23,18 +28,24 @@
  * baud rate register values based on the provided baud rate.
  */
 void UART_Init(unsigned int baudrate) {
+#if RCC_RETIME
+    unsigned char mode;
+#endif
+
+#if UART_RX_PIN == UART_RX_PA6
     // Set PA6 as UART RX (input)
     _pac6 = 1;
     _pas13 = 0;
     _pas14 = 1;
     _pas15 = 1;
     _papu6 = 1;
-
+#else
     // Set PB3 as UART RX (input)
     _pbc3 = 1;
     // Pin share RX
     _pbs06 = 0;
     _pbs07 = 1;
+#endif
 
     // Set PA3 as UART TX (output)
     _pas06 = 0;
@@ -52,7 +63,8 @@ void UART_Init(unsigned int baudrate) {
     // 1: UART mode
     _umd = 1;
     _ubrgh = SPEED_BAUDRATE;
-    unsigned int ubrr = (F_CPU / (CONSTANT_NUMBER * baudrate)) - 1.0;
+    // Integer division truncates like the float conversion did, without the float library
+    unsigned int ubrr = (F_CPU / (CONSTANT_NUMBER * baudrate)) - 1;
     _ubrg = ubrr & 0xFF;
     
     // Enable UART by setting UREN bit in UUCR1 register
@@ -63,7 +75,67 @@ void UART_Init(unsigned int baudrate) {
     _ustops = STOP_BIT;
     _utxen = TRANSMITTER;
     _urxen = RECEIVER;
+
+#if RCC_RETIME
+    // Divisors of the other clock modes, worked out now at full speed
+    for (mode = 0; mode < RCC_MODES; mode++) {
+        UartDivisors[mode] = (unsigned char)((RccHighHz(mode) / (CONSTANT_NUMBER * baudrate)) - 1);
+    }
+    UART_Retime();
+    RccRegister(UART_Retime);
+#endif
+}
+
+#if RCC_RETIME
+/** @brief Reprograms the baud rate generator for RccMode().
+ *
+ * Only the divisor is written, so the line settings of UART_Init() stay.
+ */
+void UART_Retime(void) {
+    unsigned char mode = RccMode();
+
+    if (!RccHighHz(mode)) {
+        _uren = 0; // No fH, no baud rate clock
+        return;
+    }
+    _ubrg = UartDivisors[mode];
+    _uren = 1;
 }
+#endif
+
+#if USIM_ISR
+static UartReceiveHandler UartReceiver;
+
+/** @brief Hands every received byte to a handler from the USIM vector.
+ * @param handler The function called with each byte, or 0 to stop receiving.
+ */
+void UART_SetReceiveHandler(UartReceiveHandler handler) {
+    _urie = 0;
+    UartReceiver = handler;
+    if (!handler) {
+        return;
+    }
+#if ISR_DISPATCH_TABLE
+    InterruptRegister(USIM_ISR_ADDRESS, UART_ReceiveISR);
+#endif
+    EnableInterrupt(USIM_ISR_ADDRESS);
+    _urie = 1; // Interrupt on each received byte
+}
+
+/** @brief Passes the received bytes to the handler.
+ *
+ * Reading the data register clears URXIF; a byte that arrives meanwhile is
+ * taken in the same call.
+ */
+void UART_ReceiveISR(void) {
+    while (_urxif) {
+        char c = _utxr_rxr;
+        if (UartReceiver) {
+            UartReceiver(c);
+        }
+    }
+}
+#endif
 
 /** @brief Transmits a single character via UART.
  * @param data The character to be transmitted.
@@ -109,6 +181,39 @@ int UART_Receive(void) {
     return _utxr_rxr;
 }
 
+/** @brief Transmits a null-terminated string via UART.
+ * @param str The string to be transmitted.
+ */
+void UART_TransmitString(const char *str) {
+    while (*str) {
+        UART_Transmit(*str++);
+    }
+}
+
+/** @brief Transmits an unsigned number via UART as decimal digits.
+ * @param value The number to be transmitted.
+ *
+ * The digits come from Format(), which subtracts powers of ten instead of
+ * dividing, and go out without leading zeros.
+ */
+void UART_TransmitNumber(unsigned long value) {
+    Format(UART_Transmit, "%lu", value);
+}
+
+/** @brief Transmits formatted text via UART.
+ * @param format The format string, followed by its arguments.
+ *
+ * Each character is handed to UART_Transmit() as soon as it is formatted,
+ * so no line buffer is needed.
+ */
+void UART_Printf(const char *format, ...) {
+    va_list args;
+
+    va_start(args, format);
+    FormatV(UART_Transmit, format, args);
+    va_end(args);
+}
+
 /** @brief Enables UART interrupts for receiving and transmitting.
  *
  * This function enables the receiver interrupt and the transmitter interrupts.
@@ -16,6 +16,9 @@
 #ifndef UART_H
 #define UART_H
 
+#include "RCC.h"
+#include "Interrupt.h"
+
 /** @brief Enable or disable macros. */
 #define ENABLE            1
 #define DISABLE           0
@@ -27,7 +30,9 @@
 //============================================
 // Assuming a clock frequency
 //============================================
+#ifndef F_CPU
 #define F_CPU            4000000 /**< Clock frequency in Hz. */
+#endif
 
 //============================================
 // Calculate and set the baud rate
@@ -38,9 +43,9 @@
 #define SPEED_BAUDRATE   LOW_SPEED /**< Current baud rate setting. */
 
 #if SPEED_BAUDRATE
-    #define CONSTANT_NUMBER 16.00 /**< Constant for low speed calculation. */
+    #define CONSTANT_NUMBER 16UL /**< Constant for low speed calculation. */
 #else
-    #define CONSTANT_NUMBER 64.00 /**< Constant for high speed calculation. */
+    #define CONSTANT_NUMBER 64UL /**< Constant for high speed calculation. */
 #endif
 
 //============================================
@@ -72,7 +77,35 @@
 /*
 0: No break character is transmitted
 1: Break characters transmit
+*/
+//============================================
+
 //============================================
+// RX pin: UART_Init() shares only the selected pin; TX is always PA3
+//============================================
+#define UART_RX_PA6      0 /**< RX on PA6, with pull-up. */
+#define UART_RX_PB3      1 /**< RX on PB3. */
+#define UART_RX_PIN      UART_RX_PA6 /**< Selected RX pin. */
+
+/** @brief Pins taken by UART_Init(), as port masks.
+ * Drivers with configurable pins check theirs against these, and these
+ * against theirs, wherever the headers meet.
+ */
+#define UART_PINS_PA     (0x08 | (UART_RX_PIN == UART_RX_PA6 ? 0x40 : 0))
+#define UART_PINS_PB     (UART_RX_PIN == UART_RX_PB3 ? 0x08 : 0)
+
+#if (UART_PINS_PA & LCD_PINS_PA) || (UART_PINS_PB & LCD_PINS_PB)
+    #error "The LCD pins overlap the UART pins"
+#endif
+#if (UART_PINS_PA & KEYPAD_PINS_PA) || (UART_PINS_PB & KEYPAD_PINS_PB)
+    #error "The keypad pins overlap the UART pins"
+#endif
+#if (UART_PINS_PA & DHT11_PINS_PA) || (UART_PINS_PB & DHT11_PINS_PB)
+    #error "The DHT11 pin overlaps the UART pins"
+#endif
+#if (UART_PINS_PA & SEG_PINS_PA) || (UART_PINS_PB & SEG_PINS_PB)
+    #error "The 7-segment pins overlap the UART pins"
+#endif
 
 // Error codes
 #define UART_ERROR          -1 /**< UART generic error code. */
@@ -85,6 +118,31 @@
  */
 void UART_Init(unsigned int baudrate);
 
+#if RCC_RETIME
+/** @brief Reprograms the baud rate generator for RccMode().
+ * Registered by UART_Init(), which works out the divisor of every clock mode.
+ * The generator runs from fH, so only the HIRC setting matters; in a mode
+ * that stops the HIRC the UART is disabled.
+ */
+void UART_Retime(void);
+#endif
+
+#if USIM_ISR
+/** @brief Function receiving each byte from the UART interrupt. */
+typedef void (*UartReceiveHandler)(char c);
+
+/** @brief Hands every received byte to a handler from the USIM vector.
+ * Registers UART_ReceiveISR() on USIM_ISR_ADDRESS and enables the receive
+ * interrupt; without ISR_DISPATCH_TABLE, name UART_ReceiveISR as the
+ * USIM_ISR_HANDLER instead. Call after UART_Init().
+ * @param handler The function called with each byte, or 0 to stop receiving.
+ */
+void UART_SetReceiveHandler(UartReceiveHandler handler);
+
+/** @brief Passes the received bytes to the handler. Called from the USIM vector. */
+void UART_ReceiveISR(void);
+#endif
+
 /** @brief Transmits a single character via UART.
  * @param data The character to be transmitted.
  */
@@ -95,4 +153,20 @@ void UART_Transmit(char data);
  */
 int UART_Receive(void);
 
+/** @brief Transmits a null-terminated string via UART.
+ * @param str The string to be transmitted.
+ */
+void UART_TransmitString(const char *str);
+
+/** @brief Transmits an unsigned number via UART as decimal digits.
+ * @param value The number to be transmitted.
+ */
+void UART_TransmitNumber(unsigned long value);
+
+/** @brief Transmits formatted text, e.g. UART_Printf("%u,%d,%.2q\r\n", id, offset, level).
+ * Characters are sent as Format() produces them; see Format.h for the conversions.
+ * @param format The format string, followed by its arguments.
+ */
+void UART_Printf(const char *format, ...);
+
 #endif // UART_H
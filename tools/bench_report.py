@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+#
+# Licensed under the Apache License, Version 2.0.
+# You may not use this file except in compliance with the License.
+# Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+# Distributed on an "AS IS" basis, without warranties or conditions.
+#
+"""Runs the cases of src/Host/Bench.c and estimates their cost on the device.
+
+    bench_report.py BENCH OBJDIR [--compare OLD.json] > bench.json
+
+BENCH is the benchmark program and OBJDIR holds the library objects, built
+with -O0 -g --coverage by "make bench". Each case runs in its own process.
+The program reports its calls and register accesses. gcov reports how often
+each library line ran, and objdump shows the operations compiled for each
+line:
+
+    float   add, mul, div, cmp and cvt instructions on float or double,
+            plus calls into libm
+    integer mul and div instructions, which are library calls on the device
+            (division by a constant shows up as a mul)
+    loops   taken backward branches, one per repeat of a loop
+
+Nothing on x86-64 counts float operations directly, so they are counted
+per line: an operation on a line that ran n times counts n times, including
+the arm of a conditional that did not run.
+
+The estimate uses the instruction cycles in COST. A line costs a few
+instructions besides its register accesses. The float and long costs are
+typical of the 8-bit software routines the compiler calls, so treat the
+result as a way to compare methods and commits, not as a cycle count. The
+JSON goes to stdout with a table on stderr. With --compare, the table shows
+the change in estimated cycles against an earlier file.
+
+Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+Date: 2024
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+
+# Estimated instruction cycles per operation
+COST = {
+    "line": 2,          # Statement overhead besides register accesses
+    "sfr": 1,           # One register access
+    "loop": 2,          # Counter update and jump back
+    "float_add": 120,
+    "float_mul": 250,
+    "float_div": 550,
+    "float_cmp": 40,
+    "float_cvt": 80,
+    "float_libm": 3000,
+    "int_mul": 60,
+    "int_div": 300,
+}
+
+FLOAT_OPS = {
+    "add": ("addss", "addsd", "subss", "subsd"),
+    "mul": ("mulss", "mulsd"),
+    "div": ("divss", "divsd", "sqrtss", "sqrtsd"),
+    "cmp": ("comiss", "comisd", "ucomiss", "ucomisd"),
+}
+INT_MUL = ("imul", "mul")
+INT_DIV = ("div", "idiv")
+LIBM = {"log", "logf", "exp", "expf", "pow", "powf", "sqrt", "sqrtf",
+        "sin", "sinf", "cos", "cosf", "tan", "tanf", "atan", "atanf",
+        "log10", "log10f", "fmod", "fmodf", "floor", "floorf", "ceil", "ceilf"}
+
+LINE = re.compile(r"^(/.*|\S+\.[ch]):(\d+)")
+INSN = re.compile(r"^\s*([0-9a-f]+):\s+(\S+)\s*(.*)$")
+RELOC = re.compile(r"R_X86_64_(?:PLT32|PC32)\s+(\w+)")
+JUMP = re.compile(r"^([0-9a-f]+)\s")
+
+
+def new_ops():
+    ops = {"float_" + k: 0 for k in list(FLOAT_OPS) + ["cvt", "libm"]}
+    ops.update(int_mul=0, int_div=0)
+    return ops
+
+
+def classify(mnemonic):
+    for kind, names in FLOAT_OPS.items():
+        if mnemonic in names:
+            return "float_" + kind
+    if mnemonic.startswith("cvt") and ("ss" in mnemonic or "sd" in mnemonic):
+        return "float_cvt"
+    if mnemonic.rstrip("bwlq") in INT_MUL or mnemonic in INT_MUL:
+        return "int_mul"
+    if mnemonic.rstrip("bwlq") in INT_DIV or mnemonic in INT_DIV:
+        return "int_div"
+    return None
+
+
+def disassemble(obj):
+    """Operations and backward conditional jumps of each source line."""
+    text = subprocess.run(["objdump", "-dlr", "--no-show-raw-insn", obj],
+                          capture_output=True, text=True, check=True).stdout
+    ops = {}
+    jumps = {}
+    key = None
+    for row in text.splitlines():
+        match = LINE.match(row)
+        if match:
+            key = (os.path.basename(match.group(1)), int(match.group(2)))
+            ops.setdefault(key, new_ops())
+            jumps.setdefault(key, [])
+            continue
+        if key is None:
+            continue
+        match = RELOC.search(row)
+        if match:
+            if match.group(1) in LIBM:
+                ops[key]["float_libm"] += 1
+            continue
+        match = INSN.match(row)
+        if not match:
+            continue
+        address, mnemonic, operands = int(match.group(1), 16), match.group(2), match.group(3)
+        kind = classify(mnemonic)
+        if kind:
+            ops[key][kind] += 1
+        elif mnemonic.startswith("j") and mnemonic != "jmp":
+            target = JUMP.match(operands)
+            jumps[key].append(target is not None and int(target.group(1), 16) < address)
+    return ops, jumps
+
+
+def line_counts(objdir):
+    """Count and branch counts of each library line from gcov."""
+    counts = {}
+    gcdas = sorted(glob.glob(os.path.join(os.path.abspath(objdir), "*.gcda")))
+    if not gcdas:
+        return counts
+    text = subprocess.run(["gcov", "-b", "--json-format", "--stdout"] + gcdas,
+                          capture_output=True, text=True, check=True,
+                          cwd=objdir).stdout
+    for document in text.splitlines():
+        if not document.strip():
+            continue
+        for source in json.loads(document)["files"]:
+            name = os.path.basename(source["file"])
+            for line in source["lines"]:
+                key = (name, line["line_number"])
+                count, branches = counts.get(key, (0, []))
+                counts[key] = (count + line["count"],
+                               branches + [b["count"] for b in line.get("branches", [])
+                                           if not b["fallthrough"]])
+    return counts
+
+
+def run_case(bench, objdir, name, ops, jumps):
+    for gcda in glob.glob(os.path.join(objdir, "*.gcda")):
+        os.remove(gcda)
+    out = subprocess.run([os.path.abspath(bench), name], capture_output=True,
+                         text=True, check=True).stdout.split()
+    calls, reads, writes, clocks = (int(v) for v in out[-4:])
+    result = {"calls": calls, "sfr_reads": reads, "sfr_writes": writes,
+              "clocks": clocks, "lines": 0, "loops": 0}
+    result.update(new_ops())
+    for key, (count, taken) in line_counts(objdir).items():
+        result["lines"] += count
+        for kind, n in ops.get(key, {}).items():
+            result[kind] += n * count
+        # Branches of a line come in the order of its conditional jumps
+        backward = jumps.get(key, [])
+        result["loops"] += sum(t for t, back in zip(taken, backward) if back)
+    cycles = (result["lines"] * COST["line"] + (reads + writes) * COST["sfr"]
+              + result["loops"] * COST["loop"]
+              + sum(result[kind] * COST[kind] for kind in new_ops()))
+    result["cycles"] = cycles
+    result["cycles_per_call"] = cycles // calls if calls else cycles
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("bench")
+    parser.add_argument("objdir")
+    parser.add_argument("--compare", help="earlier bench.json")
+    args = parser.parse_args()
+
+    ops, jumps = {}, {}
+    for obj in sorted(glob.glob(os.path.join(args.objdir, "*.o"))):
+        o, j = disassemble(obj)
+        ops.update(o)
+        jumps.update(j)
+
+    names = subprocess.run([os.path.abspath(args.bench)], capture_output=True,
+                           text=True, check=True).stdout.split()
+    report = {"cost": COST, "cases": {}}
+    for name in names:
+        report["cases"][name] = run_case(args.bench, args.objdir, name, ops, jumps)
+
+    old = {}
+    if args.compare:
+        with open(args.compare) as f:
+            old = json.load(f).get("cases", {})
+
+    print("%-22s %6s %8s %8s %8s %10s %10s%s" % (
+        "case", "calls", "sfr", "float", "loops", "cycles", "per call",
+        "  change" if args.compare else ""), file=sys.stderr)
+    for name, r in report["cases"].items():
+        floats = sum(v for k, v in r.items() if k.startswith("float_"))
+        change = ""
+        if name in old and old[name]["cycles"]:
+            change = "  %+.1f%%" % (100.0 * (r["cycles"] - old[name]["cycles"]) / old[name]["cycles"])
+        print("%-22s %6d %8d %8d %8d %10d %10d%s" % (
+            name, r["calls"], r["sfr_reads"] + r["sfr_writes"], floats,
+            r["loops"], r["cycles"], r["cycles_per_call"], change), file=sys.stderr)
+
+    json.dump(report, sys.stdout, indent=2)
+    print()
+
+
+if __name__ == "__main__":
+    main()
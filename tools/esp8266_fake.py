@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+#
+# Licensed under the Apache License, Version 2.0.
+# You may not use this file except in compliance with the License.
+# Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+# Distributed on an "AS IS" basis, without warranties or conditions.
+#
+"""Fake ESP8266 on a pseudo-terminal.
+
+Opens a pty, prints the path of its slave side and answers AT commands
+written to it with canned responses, so the ESP8266 engine can be run on
+Linux (see esp8266_host.c):
+
+    python3 tools/esp8266_fake.py --drop-after 3 --fail-join 1
+
+Data sent with AT+CIPSEND is logged, and --ipd injects received data that
+looks like response lines, which the engine must skip.
+
+Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+Date: 2024
+"""
+
+import argparse
+import os
+import pty
+import re
+import select
+import sys
+import time
+import tty
+
+# Command pattern -> (delay in s, response); None means handled in code
+RESPONSES = [
+    (r"AT", (0.01, "\r\nOK\r\n")),
+    (r"ATE0", (0.01, "ATE0\r\n\r\nOK\r\n")),
+    (r"AT\+CWMODE=1", (0.01, "\r\nOK\r\n")),
+    (r"AT\+CWJAP=.*", None),
+    (r"AT\+CIPMUX=0", (0.01, "\r\nOK\r\n")),
+    (r"AT\+CIPSTART=.*", (0.3, "CONNECT\r\n\r\nOK\r\n")),
+    (r"AT\+CIPSEND=(\d+)", None),
+]
+
+
+class FakeEsp8266:
+    def __init__(self, fd, args):
+        self.fd = fd
+        self.args = args
+        self.joins = 0
+        self.sends = 0
+        self.line = b""
+        self.payload = None   # Bytes still expected after the send prompt
+
+    def write(self, text, delay=0.0):
+        if delay:
+            time.sleep(delay)
+        os.write(self.fd, text.encode())
+
+    def log(self, text):
+        print(text, flush=True)
+
+    def command(self, line):
+        self.log("<- " + line)
+        for pattern, response in RESPONSES:
+            match = re.fullmatch(pattern, line)
+            if not match:
+                continue
+            if response:
+                self.write(response[1], response[0])
+            elif line.startswith("AT+CWJAP"):
+                self.joins += 1
+                if self.joins <= self.args.fail_join:
+                    self.write("WIFI DISCONNECT\r\n+CWJAP:3\r\n\r\nFAIL\r\n", 0.5)
+                else:
+                    self.write("WIFI DISCONNECT\r\nWIFI CONNECTED\r\nWIFI GOT IP\r\n\r\nOK\r\n", 0.5)
+            else:
+                self.payload = [int(match.group(1)), b""]
+                self.write("\r\nOK\r\n> ", 0.01)
+            return
+        self.write("\r\nERROR\r\n", 0.01)
+
+    def data(self, byte):
+        self.payload[1] += byte
+        self.payload[0] -= 1
+        if self.payload[0]:
+            return
+        data = self.payload[1]
+        self.payload = None
+        self.sends += 1
+        self.log("<- data %r" % data)
+        self.write("\r\nRecv %d bytes\r\n\r\nSEND OK\r\n" % len(data), 0.05)
+        if self.args.ipd:
+            self.write("\r\n+IPD,9:\r\nERROR\r\n\r\n")
+        if self.args.drop_after and self.sends % self.args.drop_after == 0:
+            self.log("-> dropping the link")
+            self.write("CLOSED\r\n", 0.1)
+
+    def feed(self, chunk):
+        for i in range(len(chunk)):
+            byte = chunk[i:i + 1]
+            if self.payload:
+                self.data(byte)
+            elif byte == b"\n":
+                line = self.line.rstrip(b"\r").decode(errors="replace")
+                self.line = b""
+                if line:
+                    self.command(line)
+            else:
+                self.line += byte
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--fail-join", type=int, default=0, help="fail the first N joins")
+    parser.add_argument("--drop-after", type=int, default=0, help="close the link every N sends")
+    parser.add_argument("--ipd", action="store_true", help="receive data after every send")
+    args = parser.parse_args()
+
+    master, slave = pty.openpty()
+    tty.setraw(slave)
+    print(os.ttyname(slave), flush=True)
+
+    fake = FakeEsp8266(master, args)
+    try:
+        while True:
+            ready, _, _ = select.select([master], [], [], 1.0)
+            if ready:
+                fake.feed(os.read(master, 256))
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file esp8266_host.c
+ * @brief Runs the ESP8266 engine on Linux against a serial device or the pty
+ * of esp8266_fake.py, standing in for the UART driver and the tick timer.
+ *   cc -Isrc/ESP8266 -Isrc/UART -Isrc/RCC -Isrc/Interrupt -Isrc/Host tools/esp8266_host.c \
+ *      src/ESP8266/ESP8266.c -o esp8266_host
+ *   ./esp8266_host /dev/pts/N [seconds]
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ESP8266.h"
+#include "UART.h"
+
+static int Port = -1;
+
+#if USIM_ISR
+// Bytes go straight to Esp8266RxByte() below
+void UART_SetReceiveHandler(UartReceiveHandler handler)
+{
+    (void)handler;
+}
+#endif
+
+void UART_Transmit(char data)
+{
+    if (write(Port, &data, 1) != 1)
+        perror("write");
+}
+
+void UART_TransmitString(const char *str)
+{
+    while (*str)
+        UART_Transmit(*str++);
+}
+
+static long NowMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000L + now.tv_nsec / 1000000L;
+}
+
+int main(int argc, char **argv)
+{
+    struct termios raw;
+    struct pollfd input;
+    char buffer[64];
+    char report[32];
+    long start, nextTick, nextReport;
+    long seconds = argc > 2 ? atol(argv[2]) : 30;
+    unsigned int reports = 0;
+    char online = 0;
+    ssize_t count;
+    ssize_t i;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <tty> [seconds]\n", argv[0]);
+        return 2;
+    }
+
+    Port = open(argv[1], O_RDWR | O_NOCTTY);
+    if (Port < 0 || tcgetattr(Port, &raw) < 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    cfmakeraw(&raw);
+    tcsetattr(Port, TCSANOW, &raw);
+
+    Esp8266Init();
+    start = NowMs();
+    nextTick = start + ESP8266_TICK_MS;
+    nextReport = start;
+    input.fd = Port;
+    input.events = POLLIN;
+
+    while (NowMs() - start < seconds * 1000L)
+    {
+        // The receive interrupt
+        if (poll(&input, 1, 5) > 0)
+        {
+            count = read(Port, buffer, sizeof(buffer));
+            for (i = 0; i < count; i++)
+                Esp8266RxByte(buffer[i]);
+        }
+
+        // The tick timer
+        while (NowMs() >= nextTick)
+        {
+            Esp8266Tick();
+            nextTick += ESP8266_TICK_MS;
+        }
+
+        // The main loop
+        Esp8266Poll();
+        if (Esp8266Online() != online)
+        {
+            online = Esp8266Online();
+            printf("%6ld ms  %s\n", NowMs() - start, online ? "online" : "offline");
+            fflush(stdout);
+        }
+        if (online && !Esp8266Pending() && NowMs() >= nextReport)
+        {
+            snprintf(report, sizeof(report), "report %u\r\n", reports++);
+            Esp8266Send(report, (unsigned char)strlen(report));
+            nextReport = NowMs() + 1000;
+        }
+    }
+
+    printf("%u reports queued\n", reports);
+    close(Port);
+    return 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/** @file fixedpoint_host.c
+ * @brief Checks src/FixedPoint and temperatureFixed() against double precision on Linux.
+ * Each function runs over edge cases and pseudo-random inputs spread across
+ * the range; the largest error against the saturated double result is printed
+ * next to the limit the header promises, and for temperatureFixed() a limit of
+ * 0.01 C from -40 to 125 C. The exit status is 1 if any is over.
+ *   cc -std=c99 -Isrc/Host -Isrc/FixedPoint -Isrc/NTC tools/fixedpoint_host.c \
+ *      src/FixedPoint/FixedPoint.c src/NTC/NTC.c -lm -o fixedpoint_host
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FixedPoint.h"
+#include "NTC.h"
+
+#define LSB       (1.0 / 65536.0)
+#define RANDOM    200000
+
+static unsigned long Seed = 12345;
+static int Failures;
+
+/** @brief Q16.16 raw value, spread over magnitudes from 2^-16 to 2^15. */
+static Q16_16 Random(void)
+{
+    long value;
+
+    Seed = Seed * 1103515245UL + 12345UL;
+    value = (long)((Seed >> 8) & 0x7FFFFFFFUL) >> ((Seed >> 3) % 31);
+    return (Seed & 0x10000) ? -value : value;
+}
+
+static double Real(Q16_16 value)
+{
+    return value * LSB;
+}
+
+static double Saturate(double value)
+{
+    if (value > FIXED_MAX * LSB)
+        return FIXED_MAX * LSB;
+    if (value < FIXED_MIN * LSB)
+        return FIXED_MIN * LSB;
+    return value;
+}
+
+/** @brief Largest error of one function, reported by Report(). */
+typedef struct
+{
+    double worst;
+    Q16_16 a, b;
+    long cases;
+} Check;
+
+static void Note(Check *check, double error, Q16_16 a, Q16_16 b)
+{
+    error = fabs(error);
+    if (error > check->worst)
+    {
+        check->worst = error;
+        check->a = a;
+        check->b = b;
+    }
+    check->cases++;
+}
+
+static void Report(const char *name, const Check *check, double limit)
+{
+    int ok = check->worst <= limit;
+
+    printf("%-18s %7ld cases  max error %.7f  limit %.7f  %s", name, check->cases,
+           check->worst, limit, ok ? "ok" : "FAIL");
+    if (!ok)
+        printf("  at %ld, %ld", check->a, check->b);
+    printf("\n");
+    Failures += !ok;
+}
+
+static void CheckArithmetic(void)
+{
+    Check add = { 0 }, sub = { 0 }, mul = { 0 }, div = { 0 };
+    static const Q16_16 edges[] = { 0, 1, -1, FIXED_ONE, -FIXED_ONE, FIXED_MAX, FIXED_MIN,
+                                    0x8000, 0x7FFF0000L, -0x7FFF0000L, 0x10001L };
+    long i, j;
+    Q16_16 a, b;
+
+    for (i = 0; i < RANDOM; i++)
+    {
+        a = Random();
+        b = Random();
+        if (i < (long)(sizeof(edges) / sizeof(edges[0])) * 11)
+        {
+            a = edges[i % 11];
+            b = edges[i / 11];
+        }
+        Note(&add, Real(FixedAdd(a, b)) - Saturate(Real(a) + Real(b)), a, b);
+        Note(&sub, Real(FixedSub(a, b)) - Saturate(Real(a) - Real(b)), a, b);
+        Note(&mul, Real(FixedMul(a, b)) - Saturate(Real(a) * Real(b)), a, b);
+        if (b)
+            Note(&div, Real(FixedDiv(a, b)) - Saturate(Real(a) / Real(b)), a, b);
+    }
+    for (j = 0; j < 3; j++)
+        Note(&div, Real(FixedDiv((j - 1) * FIXED_ONE, 0)) - (j ? FIXED_MAX : FIXED_MIN) * LSB, j, 0);
+
+    Report("FixedAdd", &add, 0);
+    Report("FixedSub", &sub, 0);
+    Report("FixedMul", &mul, 0.5 * LSB);
+    Report("FixedDiv", &div, 0.5 * LSB);
+}
+
+static void CheckFunctions(void)
+{
+    Check reciprocal = { 0 }, root = { 0 }, base2 = { 0 }, ln = { 0 };
+    long i;
+    Q16_16 a;
+    double exact;
+
+    for (i = 0; i < RANDOM; i++)
+    {
+        a = i < 65536 ? i + 1 : Random();
+        if (a)
+        {
+            // Relative to the result, with a floor of one step for tiny results
+            exact = Saturate(1.0 / Real(a));
+            Note(&reciprocal, (Real(FixedReciprocal(a)) - exact) / fmax(fabs(exact), 1.0), a, 0);
+        }
+        if (a > 0)
+        {
+            Note(&root, Real(FixedSqrt(a)) - sqrt(Real(a)), a, 0);
+            Note(&base2, Real(FixedLog2(a)) - log2(Real(a)), a, 0);
+            Note(&ln, Real(FixedLn(a)) - log(Real(a)), a, 0);
+        }
+    }
+    Note(&root, Real(FixedSqrt(FIXED_MAX)) - sqrt(Real(FIXED_MAX)), FIXED_MAX, 0);
+
+    Report("FixedReciprocal", &reciprocal, 1.0 / 16384);
+    Report("FixedSqrt", &root, 0.5 * LSB);
+    Report("FixedLog2", &base2, 0.00012);
+    Report("FixedLn", &ln, 0.00012 * 0.6931472 + LSB);
+}
+
+static void CheckQ8(void)
+{
+    Check add = { 0 }, mul = { 0 }, to8 = { 0 };
+    long a, b;
+    double exact;
+
+    for (a = FIXED8_MIN; a <= FIXED8_MAX; a += 97)
+        for (b = FIXED8_MIN; b <= FIXED8_MAX; b += 89)
+        {
+            exact = fmax(fmin((a + b) / 256.0, FIXED8_MAX / 256.0), FIXED8_MIN / 256.0);
+            Note(&add, FixedAdd8((Q8_8)a, (Q8_8)b) / 256.0 - exact, a, b);
+            exact = fmax(fmin(a * (b / 256.0) / 256.0, FIXED8_MAX / 256.0), FIXED8_MIN / 256.0);
+            Note(&mul, FixedMul8((Q8_8)a, (Q8_8)b) / 256.0 - exact, a, b);
+        }
+    for (a = 0; a < RANDOM; a++)
+    {
+        b = Random();
+        exact = fmax(fmin(Real(b), FIXED8_MAX / 256.0), FIXED8_MIN / 256.0);
+        Note(&to8, FixedTo8(b) / 256.0 - exact, b, 0);
+    }
+    Report("FixedAdd8", &add, 0);
+    Report("FixedMul8", &mul, 0.5 / 256);
+    Report("FixedTo8", &to8, 0.5 / 256);
+}
+
+static void CheckStrings(void)
+{
+    Check to = { 0 }, from = { 0 }, length = { 0 };
+    char text[32];
+    long i;
+    Q16_16 a, b;
+    unsigned char decimals, n;
+
+    for (i = 0; i < RANDOM; i++)
+    {
+        a = Random();
+        decimals = (unsigned char)(i % (FIXED_DECIMALS + 1));
+        n = FixedToString(a, decimals, text);
+        Note(&length, n != strlen(text) || n > 7 + decimals, a, decimals);
+        Note(&to, (strtod(text, 0) - Real(a)) / (0.5 * pow(10, -decimals)), a, decimals);
+
+        sprintf(text, "%.*f", (int)(i % 9), Real(Random()) * (i & 1 ? 1 : 0.001));
+        n = FixedFromString(text, &b);
+        Note(&length, n != strlen(text), i, n);
+        Note(&from, Real(b) - Saturate(strtod(text, 0)), i, b);
+    }
+    // Inputs that are not plain numbers
+    Note(&length, FixedFromString("x", &b) != 0 || FixedFromString("-.", &b) != 0, 0, 0);
+    Note(&length, FixedFromString("+4.x", &b) != 3 || b != 4 * FIXED_ONE, 1, b);
+    Note(&from, Real(b) - 4, 0, 0);
+    Note(&length, FixedFromString("99999999", &b) != 8 || b != FIXED_MAX, 2, b);
+
+    Report("FixedToString", &to, 1.0 + 1e-6);   // Ties round away from zero
+    Report("FixedFromString", &from, 0.5 * LSB + 1e-7);
+    Report("string lengths", &length, 0);
+}
+
+static void CheckTemperature(void)
+{
+    Check check = { 0 };
+    int adc;
+    double ratio, resistance, logR, exact;
+
+    for (adc = 1; adc < ADCNumerOfbits; adc++)
+    {
+#ifdef NTC_IS_PULLUP
+        ratio = (double)adc / (ADCNumerOfbits - adc);
+#else
+        ratio = (double)(ADCNumerOfbits - adc) / adc;
+#endif
+        resistance = ratio * RES_CONNECTED_TO_NTC;
+        logR = log(resistance);
+        exact = 1.0 / (A + B * logR + C * logR * logR * logR) - 273.15;
+        if (exact >= -40 && exact <= 125)
+            Note(&check, Real(temperatureFixed(adc)) - exact, adc, 0);
+    }
+    Report("temperatureFixed", &check, 0.01);
+}
+
+int main(void)
+{
+    CheckArithmetic();
+    CheckFunctions();
+    CheckQ8();
+    CheckStrings();
+    CheckTemperature();
+    return Failures ? 1 : 0;
+}
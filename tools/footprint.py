@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+#
+# Licensed under the Apache License, Version 2.0.
+# You may not use this file except in compliance with the License.
+# Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+# Distributed on an "AS IS" basis, without warranties or conditions.
+#
+"""ROM, RAM and stack footprint of each module under each configuration.
+
+    footprint.py CONFIG [--cc gcc] [--json footprint.json]
+
+Every variant in CONFIG is built from a copy of src/ in which the listed
+header settings are rewritten, with src/Host standing in for the device
+header. Each library object is then measured:
+
+    rom     code, constants and initial values
+    ram     initialized and zeroed data
+    stack   deepest call chain from any function of the module, from the
+            frame sizes and call graph gcc reports; calls through pointers
+            (registered ISR handlers) are not followed
+    float   float and double operations compiled into the module: SSE
+            arithmetic, compares and conversions plus libm calls, classified
+            as in bench_report.py. On the device each is a call into the
+            soft-float runtime, which x86 code never names, so this column
+            rather than runtime shows which modules pull it in
+    runtime functions the module calls from outside the library, e.g. log
+
+The table goes to stdout and, with --json, every function with its size,
+frame and depth to a file. Any module over a budget of CONFIG is listed
+and the exit status is 1, so "make footprint" fails.
+
+The compiler is gcc for the host at -Os without inlining, with registers
+accessed directly (HOST_ACCESS_MODEL 0), not the Holtek compiler, so the
+bytes are for comparing modules, configurations and commits rather than for
+the device's map file. Warnings are on and passed through to stderr.
+
+CONFIG lines, # starts a comment:
+
+    variant MODULE NAME SETTING...   SETTING is NAME=value; NAME= defines
+                                     a flag such as _USE_MATH_H, -NAME
+                                     comments one out
+    budget  MODULE VARIANT ROM RAM STACK   bytes, - for no limit
+
+Every module is also built as "default" with the headers unchanged.
+
+Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+Date: 2024
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from bench_report import LIBM, classify  # noqa: E402
+
+SRC = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src")
+CFLAGS = ["-std=c99", "-DHOST_ACCESS_MODEL=0", "-Os", "-fno-inline", "-ffunction-sections",
+          "-fdata-sections", "-fcallgraph-info=su", "-Wall", "-Wno-unused-function"]
+
+NODE = re.compile(r'node: \{ title: "([^"]+)" label: "[^"\\]*\\n[^"\\]*\\n(\d+) bytes')
+EDGE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+FUNCTION = re.compile(r"^[0-9a-f]+ <([^>]+)>:$")
+INSN = re.compile(r"^\s*[0-9a-f]+:\s+(\S+)")
+RELOC = re.compile(r"R_X86_64_(?:PLT32|PC32)\s+(\w+)")
+
+
+def read_config(path):
+    variants = []
+    budgets = {}
+    with open(path) as f:
+        for number, row in enumerate(f, 1):
+            words = row.split("#")[0].split()
+            if not words:
+                continue
+            if words[0] == "variant" and len(words) >= 4:
+                settings = dict((s[1:], None) if s.startswith("-") else s.split("=", 1)
+                                for s in words[3:])
+                variants.append((words[1], words[2], settings))
+            elif words[0] == "budget" and len(words) == 6:
+                budgets[(words[1], words[2])] = [None if w == "-" else int(w) for w in words[3:]]
+            else:
+                sys.exit("%s:%d: cannot read '%s'" % (path, number, row.strip()))
+    return variants, budgets
+
+
+def configure(tree, settings):
+    """Rewrites the settings in the headers of a copy of src/."""
+    left = dict(settings)
+    for header in glob.glob(os.path.join(tree, "*", "*.h")):
+        if os.path.basename(os.path.dirname(header)) == "Host":
+            continue
+        with open(header) as f:
+            text = f.read()
+        changed = text
+        for name, value in settings.items():
+            pattern = re.compile(r"^[ \t]*(//[ \t]*)?#define[ \t]+%s\b.*$" % re.escape(name), re.M)
+            if value is None:
+                line = "// #define %s" % name
+            else:
+                line = ("#define %s %s" % (name, value)).rstrip()
+            changed, n = pattern.subn(line, changed)
+            if n:
+                left.pop(name, None)
+        if changed != text:
+            with open(header, "w") as f:
+                f.write(changed)
+    if left:
+        sys.exit("no #define for %s in the headers" % ", ".join(left))
+
+
+def build(cc, tree, out):
+    """Compiles every module of a tree. Returns {module: [objects]}."""
+    modules = sorted(d for d in os.listdir(tree)
+                     if d != "Host" and os.path.isdir(os.path.join(tree, d)))
+    includes = ["-I" + os.path.join(tree, "Host")] + ["-I" + os.path.join(tree, m) for m in modules]
+    objects = {"Host": []}
+    for module in modules + ["Host"]:
+        for source in sorted(glob.glob(os.path.join(tree, module, "*.c"))):
+            obj = os.path.join(out, os.path.basename(source)[:-2] + ".o")
+            result = subprocess.run([cc] + CFLAGS + includes + ["-c", source, "-o", obj],
+                                    cwd=out, capture_output=True, text=True)
+            if result.returncode:
+                sys.exit("%s does not build:\n%s" % (source, result.stderr))
+            if result.stderr:
+                print(result.stderr, end="", file=sys.stderr)
+            objects.setdefault(module, []).append(obj)
+    return objects
+
+
+def symbols(obj):
+    """Defined symbols with type and size, and undefined names."""
+    defined = []
+    undefined = []
+    text = subprocess.run(["nm", "-S", obj], capture_output=True, text=True, check=True).stdout
+    for row in text.splitlines():
+        words = row.split()
+        if len(words) == 2 and words[0] == "U":
+            undefined.append(words[1])
+        elif len(words) == 4:
+            defined.append((words[3], words[2], int(words[1], 16)))
+    return defined, undefined
+
+
+def float_ops(obj):
+    """Float operations of each function of an object."""
+    text = subprocess.run(["objdump", "-dr", "--no-show-raw-insn", obj],
+                          capture_output=True, text=True, check=True).stdout
+    ops = {}
+    name = None
+    for row in text.splitlines():
+        match = FUNCTION.match(row)
+        if match:
+            name = match.group(1)
+            continue
+        if name is None:
+            continue
+        match = RELOC.search(row)
+        if match:
+            if match.group(1) in LIBM:
+                ops[name] = ops.get(name, 0) + 1
+            continue
+        match = INSN.match(row)
+        if match and (classify(match.group(1)) or "").startswith("float_"):
+            ops[name] = ops.get(name, 0) + 1
+    return ops
+
+
+def call_graph(objects):
+    """Frames and callees of every function, names local to a file first."""
+    frames = {}
+    calls = {}
+    for obj in objects:
+        path = obj[:-2] + ".ci"
+        if not os.path.exists(path):
+            continue
+        unit = os.path.basename(obj)
+        with open(path) as f:
+            text = f.read()
+        for name, size in NODE.findall(text):
+            frames[(unit, name)] = int(size)
+        for source, target in EDGE.findall(text):
+            calls.setdefault((unit, source), []).append(target)
+    by_name = {}
+    for unit, name in frames:
+        by_name.setdefault(name, (unit, name))
+    return frames, calls, by_name
+
+
+def depth(key, frames, calls, by_name, memo, path=()):
+    if key in memo:
+        return memo[key]
+    if key in path:                                 # Recursion has no bound
+        return 0
+    deepest = 0
+    for target in calls.get(key, []):
+        callee = (key[0], target) if (key[0], target) in frames else by_name.get(target)
+        if callee:
+            deepest = max(deepest, depth(callee, frames, calls, by_name, memo, path + (key,)))
+    memo[key] = frames.get(key, 0) + deepest
+    return memo[key]
+
+
+def measure(cc, settings):
+    tree = tempfile.mkdtemp(prefix="footprint")
+    try:
+        shutil.copytree(SRC, os.path.join(tree, "src"),
+                        ignore=shutil.ignore_patterns("build", "*.o"))
+        configure(os.path.join(tree, "src"), settings)
+        out = os.path.join(tree, "obj")
+        os.mkdir(out)
+        objects = build(cc, os.path.join(tree, "src"), out)
+        device = objects.pop("Host")
+        every = [o for objs in objects.values() for o in objs]
+        frames, calls, by_name = call_graph(every)
+        library = set()
+        table = {}
+        for obj in every + device:
+            library.update(name for name, kind, size in symbols(obj)[0] if kind.isupper())
+        memo = {}
+        for module, objs in objects.items():
+            row = {"rom": 0, "ram": 0, "stack": 0, "float": 0, "runtime": set(), "functions": {}}
+            for obj in objs:
+                unit = os.path.basename(obj)
+                defined, undefined = symbols(obj)
+                floats = float_ops(obj)
+                for name, kind, size in defined:
+                    kind = kind.lower()
+                    if kind == "t":
+                        deep = depth((unit, name), frames, calls, by_name, memo)
+                        row["functions"][name] = {"rom": size, "frame": frames.get((unit, name), 0),
+                                                  "stack": deep, "float": floats.get(name, 0)}
+                        row["float"] += floats.get(name, 0)
+                        row["rom"] += size
+                        row["stack"] = max(row["stack"], deep)
+                    elif kind == "r":
+                        row["rom"] += size
+                    elif kind == "d":
+                        row["rom"] += size
+                        row["ram"] += size
+                    elif kind in "bc":
+                        row["ram"] += size
+                row["runtime"].update(n for n in undefined if n not in library)
+            row["runtime"] = sorted(row["runtime"])
+            table[module] = row
+        return table
+    finally:
+        shutil.rmtree(tree)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("config")
+    parser.add_argument("--cc", default=os.environ.get("CC", "gcc"))
+    parser.add_argument("--json", help="file for the per-function report")
+    args = parser.parse_args()
+
+    variants, budgets = read_config(args.config)
+    report = {}
+    default = measure(args.cc, {})
+    for module, row in default.items():
+        report.setdefault(module, {})["default"] = row
+    for module, name, settings in variants:
+        row = measure(args.cc, settings).get(module)
+        if row is None:
+            sys.exit("%s: no module %s" % (args.config, module))
+        row["settings"] = settings
+        report[module][name] = row
+
+    over = []
+    print("%-12s %-10s %7s %6s %6s %6s  %s" % ("module", "variant", "rom", "ram", "stack", "float",
+                                                "runtime"))
+    for module in sorted(report):
+        for name, row in report[module].items():
+            limit = budgets.get((module, name))
+            flags = ""
+            if limit:
+                for what, value, most in zip(("rom", "ram", "stack"),
+                                             (row["rom"], row["ram"], row["stack"]), limit):
+                    if most is not None and value > most:
+                        over.append("%s %s: %s %d over budget %d" % (module, name, what, value, most))
+                        flags = "  OVER BUDGET"
+            print("%-12s %-10s %7d %6d %6d %6d  %s%s" % (module, name, row["rom"], row["ram"],
+                                                          row["stack"], row["float"],
+                                                          " ".join(row["runtime"]), flags))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2)
+            f.write("\n")
+
+    for row in over:
+        print(row, file=sys.stderr)
+    for key in budgets:
+        if key[0] not in report or key[1] not in report[key[0]]:
+            print("budget for %s %s matches no build" % key, file=sys.stderr)
+    return 1 if over else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
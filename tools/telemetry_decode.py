@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+#
+# Licensed under the Apache License, Version 2.0.
+# You may not use this file except in compliance with the License.
+# Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+# Distributed on an "AS IS" basis, without warranties or conditions.
+#
+"""Decoder for the frames of src/Telemetry.
+
+Reads the frames as the device sends them, raw bytes back to back (e.g.
+a capture of the TCP stream written by Esp8266Send()), from a file or
+stdin, and prints a line per window:
+
+    window  channel=average[min..max] ...
+
+    telemetry_decode.py [--channels 5] [--hex] [capture]
+
+Each frame carries its length, so the stream is split without delimiters;
+bytes that do not start a frame are skipped and reported. With --hex the
+input is one frame per line in hex instead.
+
+Window numbers count from the last keyframe. Deltas cannot be applied
+across a lost frame, so after a sequence gap the decoder waits for the
+next keyframe. A saturated gap means at least that many windows were
+left out, so the window numbers after it are printed as lower bounds
+(">=") until the next keyframe.
+
+Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+Date: 2024
+"""
+
+import argparse
+import sys
+
+FRAME_TYPES = b"KDH"
+HEADER = 3
+GAP_SATURATED = 0x3FFF     # TELEMETRY_GAP_SATURATED
+
+
+def varint(data, pos):
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+class Decoder:
+    def __init__(self, channels):
+        self.channels = channels
+        self.last = None        # Averages of the last record, None until a keyframe
+        self.sequence = None
+        self.window = 0
+        self.bounded = False    # A saturated gap makes the window numbers lower bounds
+
+    def frame(self, data):
+        kind, sequence = chr(data[0]), data[1]
+        if self.sequence is not None and sequence != (self.sequence + 1) & 0xFF:
+            print("# frame lost before %d" % sequence)
+            self.last = None
+        self.sequence = sequence
+
+        if kind == "H":
+            print("# heartbeat %d" % sequence)
+            return
+        if kind == "K":
+            self.last = [0] * self.channels
+            self.window = -1
+            self.bounded = False
+        elif self.last is None:
+            print("# skipping %d until a keyframe" % sequence)
+            return
+
+        pos = HEADER
+        while pos < len(data):
+            gap, pos = varint(data, pos)
+            mask = data[pos]
+            pos += 1
+            if gap >= GAP_SATURATED:
+                print("# %d or more windows left out" % gap)
+                self.bounded = True
+            self.window += gap + 1
+            fields = []
+            for channel in range(self.channels):
+                if not mask & (1 << channel):
+                    continue
+                zigzag, pos = varint(data, pos)
+                low, pos = varint(data, pos)
+                high, pos = varint(data, pos)
+                self.last[channel] += (zigzag >> 1) ^ -(zigzag & 1)
+                average = self.last[channel]
+                fields.append("%d=%d[%d..%d]" % (channel, average, average - low, average + high))
+            number = ">=%d" % self.window if self.bounded else "%d" % self.window
+            print("%8s  %s" % (number, " ".join(fields)))
+
+
+def split(stream):
+    """Yields the frames of a raw byte stream, skipping bytes that do not start one."""
+    pos = 0
+    while pos + HEADER <= len(stream):
+        length = stream[pos + 2]
+        if stream[pos] not in FRAME_TYPES or length < HEADER or pos + length > len(stream):
+            start = pos
+            pos += 1
+            while pos + HEADER <= len(stream) and stream[pos] not in FRAME_TYPES:
+                pos += 1
+            print("# skipped %d bytes" % (pos - start))
+            continue
+        yield stream[pos:pos + length]
+        pos += length
+    if pos < len(stream):
+        print("# %d bytes of a truncated frame" % (len(stream) - pos))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes src/Telemetry frames.")
+    parser.add_argument("capture", nargs="?", help="raw capture, stdin if left out")
+    parser.add_argument("--channels", type=int, default=5, help="TELEMETRY_CHANNELS")
+    parser.add_argument("--hex", action="store_true", help="one frame per line in hex")
+    args = parser.parse_args()
+
+    source = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+    decoder = Decoder(args.channels)
+    if args.hex:
+        frames = (bytes.fromhex(line.decode()) for line in source if line.strip())
+    else:
+        frames = split(source.read())
+    for frame in frames:
+        decoder.frame(frame)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())